@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Compare the JSON results of the bench target against a stored baseline.
+
+    bench --json=baseline.json        # on the reference commit
+    bench --json=current.json         # on the change
+    python bench/compare.py baseline.json current.json [--threshold 0.05] [--metric p50_ns]
+
+A benchmark regresses when its metric is slower than the baseline by more than the threshold.
+The exit code is 1 when at least one benchmark regressed, so the script can gate a CI job.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {benchmark["name"]: benchmark for benchmark in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare bench results against a baseline.")
+    parser.add_argument("baseline", help="JSON written by bench --json on the reference build")
+    parser.add_argument("current", help="JSON written by bench --json on the build to check")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown reported as a regression (default 0.05)")
+    parser.add_argument("--metric", default="p50_ns", help="field compared between the runs (default p50_ns)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print(f"{'benchmark':<32} {'baseline':>12} {'current':>12} {'change':>9}")
+    for name, result in current.items():
+        if name not in baseline:
+            print(f"{name:<32} {'-':>12} {result[args.metric]:>12.1f} {'new':>9}")
+            continue
+
+        before = baseline[name][args.metric]
+        after = result[args.metric]
+        change = (after - before) / before if before > 0 else 0.0
+
+        status = ""
+        if change > args.threshold:
+            status = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            status = "  improvement"
+
+        print(f"{name:<32} {before:>12.1f} {after:>12.1f} {change:>+8.1%}{status}")
+
+    for name in baseline.keys() - current.keys():
+        print(f"{name:<32} {baseline[name][args.metric]:>12.1f} {'-':>12} {'removed':>9}")
+
+    if regressions:
+        print(f"{regressions} benchmark(s) regressed by more than {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,281 @@
+#include "bench.h"
+
+#include <exo/collections/vector.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace bench
+{
+static u64 now_ns()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void State::start_timer() { start_ns = now_ns(); }
+void State::stop_timer() { end_ns = now_ns(); }
+
+struct Benchmark
+{
+    const char *name;
+    Function function;
+};
+
+static Vec<Benchmark> &get_benchmarks()
+{
+    static Vec<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+Registration::Registration(const char *name, Function function) { get_benchmarks().push_back({name, function}); }
+
+struct Options
+{
+    std::string_view filter = {};
+    u32 repetitions         = 20;
+    double min_time_ms      = 10.0;
+    const char *json_path   = nullptr;
+    const char *csv_path    = nullptr;
+    bool list               = false;
+};
+
+struct Result
+{
+    const char *name;
+    u64 iterations;
+    u32 repetitions;
+    // nanoseconds per iteration
+    double min;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+    double stddev;
+    double items_per_second;
+};
+
+static void print_usage()
+{
+    std::puts("usage: bench [options]\n"
+              "  --filter=<text>      only run the benchmarks whose name contains <text>\n"
+              "  --repetitions=<n>    number of samples per benchmark (default 20)\n"
+              "  --min-time=<ms>      minimum duration of one sample (default 10)\n"
+              "  --json=<path>        write the results to a JSON file\n"
+              "  --csv=<path>         write the results to a CSV file\n"
+              "  --list               list the benchmarks and exit");
+}
+
+static bool parse_options(int argc, char **argv, Options &options)
+{
+    for (int i_arg = 1; i_arg < argc; i_arg += 1)
+    {
+        std::string_view arg = argv[i_arg];
+        // the end of an argument is null-terminated
+        auto value = [&](std::string_view prefix) { return arg.substr(prefix.size()).data(); };
+
+        if (arg.starts_with("--filter="))
+        {
+            options.filter = value("--filter=");
+        }
+        else if (arg.starts_with("--repetitions="))
+        {
+            options.repetitions = static_cast<u32>(std::max(1L, std::strtol(value("--repetitions="), nullptr, 10)));
+        }
+        else if (arg.starts_with("--min-time="))
+        {
+            options.min_time_ms = std::max(0.001, std::strtod(value("--min-time="), nullptr));
+        }
+        else if (arg.starts_with("--json="))
+        {
+            options.json_path = value("--json=");
+        }
+        else if (arg.starts_with("--csv="))
+        {
+            options.csv_path = value("--csv=");
+        }
+        else if (arg == "--list")
+        {
+            options.list = true;
+        }
+        else
+        {
+            print_usage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// nearest-rank percentile of sorted samples
+static double percentile(const Vec<double> &sorted, double p)
+{
+    usize rank = static_cast<usize>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<usize>(rank, 1, sorted.size()) - 1];
+}
+
+static Result run_benchmark(const Benchmark &benchmark, const Options &options)
+{
+    State state;
+    const u64 min_time_ns = static_cast<u64>(options.min_time_ms * 1'000'000.0);
+
+    // Warmup: double the iteration count until a run is long enough to be timed reliably
+    state.iterations = 1;
+    while (true)
+    {
+        benchmark.function(state);
+        u64 elapsed = state.end_ns - state.start_ns;
+        if (elapsed >= min_time_ns || state.iterations >= (u64(1) << 40))
+        {
+            // scale the count to get close to min_time for each sample
+            double scale     = elapsed > 0 ? double(min_time_ns) / double(elapsed) : 1.0;
+            state.iterations = std::max<u64>(1, static_cast<u64>(double(state.iterations) * std::max(scale, 1.0)));
+            break;
+        }
+        state.iterations *= 2;
+    }
+
+    Vec<double> samples;
+    samples.reserve(options.repetitions);
+    for (u32 i_repetition = 0; i_repetition < options.repetitions; i_repetition += 1)
+    {
+        benchmark.function(state);
+        samples.push_back(double(state.end_ns - state.start_ns) / double(state.iterations));
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (double sample : samples)
+    {
+        sum += sample;
+    }
+    double mean     = sum / double(samples.size());
+    double variance = 0.0;
+    for (double sample : samples)
+    {
+        variance += (sample - mean) * (sample - mean);
+    }
+    variance /= double(samples.size());
+
+    Result result           = {};
+    result.name             = benchmark.name;
+    result.iterations       = state.iterations;
+    result.repetitions      = options.repetitions;
+    result.min              = samples.front();
+    result.mean             = mean;
+    result.p50              = percentile(samples, 0.50);
+    result.p90              = percentile(samples, 0.90);
+    result.p99              = percentile(samples, 0.99);
+    result.max              = samples.back();
+    result.stddev           = std::sqrt(variance);
+    result.items_per_second = result.p50 > 0.0 ? double(state.items_per_iteration) * 1e9 / result.p50 : 0.0;
+    return result;
+}
+
+static bool write_json(const char *path, const Vec<Result> &results)
+{
+    FILE *file = std::fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string json = "{\n  \"benchmarks\": [\n";
+    for (usize i_result = 0; i_result < results.size(); i_result += 1)
+    {
+        const auto &r = results[i_result];
+        json += fmt::format("    {{\"name\": \"{}\", \"iterations\": {}, \"repetitions\": {}, \"min_ns\": {:.3f}, \"mean_ns\": {:.3f}, "
+                            "\"p50_ns\": {:.3f}, \"p90_ns\": {:.3f}, \"p99_ns\": {:.3f}, \"max_ns\": {:.3f}, \"stddev_ns\": {:.3f}, "
+                            "\"items_per_second\": {:.1f}}}{}\n",
+                            r.name, r.iterations, r.repetitions, r.min, r.mean, r.p50, r.p90, r.p99, r.max, r.stddev,
+                            r.items_per_second, i_result + 1 < results.size() ? "," : "");
+    }
+    json += "  ]\n}\n";
+
+    std::fwrite(json.data(), 1, json.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+static bool write_csv(const char *path, const Vec<Result> &results)
+{
+    FILE *file = std::fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string csv = "name,iterations,repetitions,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,max_ns,stddev_ns,items_per_second\n";
+    for (const auto &r : results)
+    {
+        csv += fmt::format("{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.1f}\n",
+                           r.name, r.iterations, r.repetitions, r.min, r.mean, r.p50, r.p90, r.p99, r.max, r.stddev,
+                           r.items_per_second);
+    }
+
+    std::fwrite(csv.data(), 1, csv.size(), file);
+    std::fclose(file);
+    return true;
+}
+
+int run(int argc, char **argv)
+{
+    Options options = {};
+    if (!parse_options(argc, argv, options))
+    {
+        return 1;
+    }
+
+    auto benchmarks = get_benchmarks();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark &a, const Benchmark &b) {
+        return std::string_view{a.name} < std::string_view{b.name};
+    });
+
+    if (options.list)
+    {
+        for (const auto &benchmark : benchmarks)
+        {
+            fmt::print("{}\n", benchmark.name);
+        }
+        return 0;
+    }
+
+    fmt::print("{:<32} {:>12} {:>12} {:>12} {:>12} {:>14}\n", "benchmark", "p50 (ns)", "p90 (ns)", "p99 (ns)", "stddev", "items/s");
+
+    Vec<Result> results;
+    for (const auto &benchmark : benchmarks)
+    {
+        if (std::string_view{benchmark.name}.find(options.filter) == std::string_view::npos)
+        {
+            continue;
+        }
+
+        auto result = run_benchmark(benchmark, options);
+        fmt::print("{:<32} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f} {:>14.4g}\n", result.name, result.p50, result.p90, result.p99, result.stddev, result.items_per_second);
+        std::fflush(stdout);
+        results.push_back(result);
+    }
+
+    if (options.json_path && !write_json(options.json_path, results))
+    {
+        fmt::print(stderr, "Failed to write {}\n", options.json_path);
+        return 1;
+    }
+
+    if (options.csv_path && !write_csv(options.csv_path, results))
+    {
+        fmt::print(stderr, "Failed to write {}\n", options.csv_path);
+        return 1;
+    }
+
+    return 0;
+}
+} // namespace bench
@@ -0,0 +1,103 @@
+#pragma once
+#include <exo/numerics.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+   A small benchmark harness that doesn't need a GPU or a window.
+   A benchmark is a function whose body runs in a `for (auto _ : state)` loop, only that loop is timed:
+       static void pool_add(bench::State &state)
+       {
+           Pool<u32> pool;
+           for (auto _ : state) { bench::do_not_optimize(pool.add(42)); }
+       }
+       BENCHMARK(pool_add);
+   The warmup doubles the iteration count until one run takes `min_time_ms`, each repetition then gives one
+   sample of the time per iteration. Results are printed as percentiles and can be written to JSON or CSV,
+   bench/compare.py compares a JSON result against a stored baseline.
+ **/
+namespace bench
+{
+struct State
+{
+    // non-trivial so that compilers don't warn about the unused loop variable
+    struct Empty
+    {
+        Empty() {}
+        ~Empty() {}
+    };
+
+    struct Iterator
+    {
+        State *state;
+        u64 remaining;
+
+        bool operator!=(const Iterator &) const
+        {
+            if (remaining != 0)
+            {
+                return true;
+            }
+            state->stop_timer();
+            return false;
+        }
+
+        void operator++() { remaining -= 1; }
+        Empty operator*() const { return {}; }
+    };
+
+    Iterator begin()
+    {
+        start_timer();
+        return {this, iterations};
+    }
+    Iterator end() { return {this, 0}; }
+
+    // number of items processed by one iteration, used to report a throughput
+    void set_items_per_iteration(u64 count) { items_per_iteration = count; }
+
+    void start_timer();
+    void stop_timer();
+
+    u64 iterations          = 1;
+    u64 items_per_iteration = 1;
+    u64 start_ns            = 0;
+    u64 end_ns              = 0;
+};
+
+using Function = void (*)(State &);
+
+struct Registration
+{
+    Registration(const char *name, Function function);
+};
+
+// Forces the compiler to compute `value`, and to assume that memory was read and written
+template <typename T> inline void do_not_optimize(const T &value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    const volatile char *address = reinterpret_cast<const volatile char *>(&value);
+    static_cast<void>(*address);
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+// Forces the compiler to write the pending stores to memory
+inline void clobber_memory()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : : "memory");
+#endif
+}
+
+// Runs the registered benchmarks, see --help for the options
+int run(int argc, char **argv);
+} // namespace bench
+
+#define BENCHMARK(function) static const bench::Registration bench_registration_##function{#function, function}
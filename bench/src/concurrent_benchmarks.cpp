@@ -0,0 +1,134 @@
+#include "bench.h"
+
+#include <exo/collections/concurrent_pool.h>
+#include <exo/collections/packed_pool.h>
+#include <exo/collections/vector.h>
+#include <exo/concurrent_free_list.h>
+#include <exo/free_list.h>
+
+#include <thread>
+
+/// --- Lock-free containers: one iteration does CONCURRENT_OPERATIONS allocate/free split between the threads
+
+inline constexpr u32 CONCURRENT_OPERATIONS = 1 << 18;
+inline constexpr u32 FREE_LIST_CAPACITY    = 1024;
+inline constexpr u32 POOL_BATCH            = 64;
+
+// runs `function(operation_count)` on `thread_count` threads, the benchmark thread being one of them
+template <typename Function> static void run_on_threads(u32 thread_count, Function &&function)
+{
+    const u32 operation_count = CONCURRENT_OPERATIONS / thread_count;
+
+    Vec<std::thread> threads;
+    for (u32 i_thread = 1; i_thread < thread_count; i_thread += 1)
+    {
+        threads.emplace_back([&]() { function(operation_count); });
+    }
+    function(operation_count);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+static void free_list_allocate_free_single(bench::State &state)
+{
+    auto list = FreeList::create(FREE_LIST_CAPACITY);
+
+    state.set_items_per_iteration(CONCURRENT_OPERATIONS);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < CONCURRENT_OPERATIONS; i += 1)
+        {
+            list.free(list.allocate());
+        }
+        bench::clobber_memory();
+    }
+
+    list.destroy();
+}
+BENCHMARK(free_list_allocate_free_single);
+
+template <u32 thread_count> static void concurrent_free_list_allocate_free(bench::State &state)
+{
+    auto list = ConcurrentFreeList::create(FREE_LIST_CAPACITY);
+
+    state.set_items_per_iteration(CONCURRENT_OPERATIONS);
+    for (auto _ : state)
+    {
+        run_on_threads(thread_count, [&](u32 operation_count) {
+            for (u32 i = 0; i < operation_count; i += 1)
+            {
+                list.free(list.allocate());
+            }
+        });
+    }
+
+    list.destroy();
+}
+
+static void concurrent_free_list_allocate_free_1(bench::State &state) { concurrent_free_list_allocate_free<1>(state); }
+static void concurrent_free_list_allocate_free_2(bench::State &state) { concurrent_free_list_allocate_free<2>(state); }
+static void concurrent_free_list_allocate_free_4(bench::State &state) { concurrent_free_list_allocate_free<4>(state); }
+static void concurrent_free_list_allocate_free_8(bench::State &state) { concurrent_free_list_allocate_free<8>(state); }
+BENCHMARK(concurrent_free_list_allocate_free_1);
+BENCHMARK(concurrent_free_list_allocate_free_2);
+BENCHMARK(concurrent_free_list_allocate_free_4);
+BENCHMARK(concurrent_free_list_allocate_free_8);
+
+static void packed_pool_add_remove_batch(bench::State &state)
+{
+    PackedPool<u64> pool;
+    Handle<u64> handles[POOL_BATCH];
+
+    state.set_items_per_iteration(CONCURRENT_OPERATIONS);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < CONCURRENT_OPERATIONS / POOL_BATCH; i += 1)
+        {
+            for (auto &handle : handles)
+            {
+                handle = pool.add(u64(i));
+            }
+            for (auto handle : handles)
+            {
+                pool.remove(handle);
+            }
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(packed_pool_add_remove_batch);
+
+template <u32 thread_count> static void concurrent_pool_add_remove_batch(bench::State &state)
+{
+    ConcurrentPool<u64> pool;
+
+    state.set_items_per_iteration(CONCURRENT_OPERATIONS);
+    for (auto _ : state)
+    {
+        run_on_threads(thread_count, [&](u32 operation_count) {
+            Handle<u64> handles[POOL_BATCH];
+            for (u32 i = 0; i < operation_count / POOL_BATCH; i += 1)
+            {
+                for (auto &handle : handles)
+                {
+                    handle = pool.add(u64(i));
+                }
+                for (auto handle : handles)
+                {
+                    pool.remove(handle);
+                }
+            }
+        });
+    }
+}
+
+static void concurrent_pool_add_remove_batch_1(bench::State &state) { concurrent_pool_add_remove_batch<1>(state); }
+static void concurrent_pool_add_remove_batch_2(bench::State &state) { concurrent_pool_add_remove_batch<2>(state); }
+static void concurrent_pool_add_remove_batch_4(bench::State &state) { concurrent_pool_add_remove_batch<4>(state); }
+static void concurrent_pool_add_remove_batch_8(bench::State &state) { concurrent_pool_add_remove_batch<8>(state); }
+BENCHMARK(concurrent_pool_add_remove_batch_1);
+BENCHMARK(concurrent_pool_add_remove_batch_2);
+BENCHMARK(concurrent_pool_add_remove_batch_4);
+BENCHMARK(concurrent_pool_add_remove_batch_8);
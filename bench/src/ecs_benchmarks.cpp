@@ -0,0 +1,243 @@
+#include "bench.h"
+
+#include "ecs.h"
+#include "components/mesh_component.h"
+#include "components/transform_component.h"
+
+#include <exo/collections/vector.h>
+#include <exo/jobs.h>
+
+namespace
+{
+struct Position
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    static const char *type_name() { return "Position"; }
+    void display_ui() {}
+};
+
+struct Velocity
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    static const char *type_name() { return "Velocity"; }
+    void display_ui() {}
+};
+
+struct Selected
+{
+    u32 frame = 0;
+    static const char *type_name() { return "Selected"; }
+    void display_ui() {}
+};
+
+inline constexpr u32 ENTITY_COUNT = 10'000;
+
+void create_entities(ECS::World &world, Vec<ECS::EntityId> *entities = nullptr)
+{
+    for (u32 i = 0; i < ENTITY_COUNT; i += 1)
+    {
+        auto entity = i % 2 ? world.create_entity(Position{float(i), 0.0f, 0.0f}, Velocity{1.0f, 0.0f, 0.0f})
+                            : world.create_entity(Position{float(i), 0.0f, 0.0f});
+        if (entities)
+        {
+            entities->push_back(entity);
+        }
+    }
+}
+} // namespace
+
+static void ecs_create_entities(bench::State &state)
+{
+    state.set_items_per_iteration(ENTITY_COUNT);
+    for (auto _ : state)
+    {
+        ECS::World world;
+        create_entities(world);
+        bench::do_not_optimize(world.entity_index.size());
+    }
+}
+BENCHMARK(ecs_create_entities);
+
+static void ecs_iterate(bench::State &state)
+{
+    ECS::World world;
+    create_entities(world);
+
+    state.set_items_per_iteration(ENTITY_COUNT / 2);
+    for (auto _ : state)
+    {
+        world.for_each<Position, Velocity>([](Position &position, const Velocity &velocity) {
+            position.x += velocity.x;
+            position.y += velocity.y;
+            position.z += velocity.z;
+        });
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_iterate);
+
+static void ecs_iterate_chunks(bench::State &state)
+{
+    ECS::World world;
+    create_entities(world);
+
+    state.set_items_per_iteration(ENTITY_COUNT / 2);
+    for (auto _ : state)
+    {
+        world.for_each_chunk<Position, Velocity>([](usize count, Position *positions, const Velocity *velocities) {
+            for (usize i = 0; i < count; i += 1)
+            {
+                positions[i].x += velocities[i].x;
+                positions[i].y += velocities[i].y;
+                positions[i].z += velocities[i].z;
+            }
+        });
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_iterate_chunks);
+
+static void ecs_iterate_query(bench::State &state)
+{
+    ECS::World world;
+    create_entities(world);
+    ECS::Query<Position, Velocity> query;
+
+    state.set_items_per_iteration(ENTITY_COUNT / 2);
+    for (auto _ : state)
+    {
+        query.for_each(world, [](Position &position, const Velocity &velocity) {
+            position.x += velocity.x;
+            position.y += velocity.y;
+            position.z += velocity.z;
+        });
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_iterate_query);
+
+static void ecs_add_remove_component(bench::State &state)
+{
+    ECS::World world;
+    Vec<ECS::EntityId> entities;
+    entities.reserve(ENTITY_COUNT);
+    create_entities(world, &entities);
+
+    // each entity moves to another archetype and back
+    state.set_items_per_iteration(2 * ENTITY_COUNT);
+    for (auto _ : state)
+    {
+        for (auto entity : entities)
+        {
+            world.add_component(entity, Selected{1});
+        }
+        for (auto entity : entities)
+        {
+            world.remove_component<Selected>(entity);
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_add_remove_component);
+
+static void ecs_command_buffer_add_remove_component(bench::State &state)
+{
+    ECS::World world;
+    Vec<ECS::EntityId> entities;
+    entities.reserve(ENTITY_COUNT);
+    create_entities(world, &entities);
+    ECS::EntityCommandBuffer commands;
+
+    // same moves as ecs_add_remove_component, played back in batches
+    state.set_items_per_iteration(2 * ENTITY_COUNT);
+    for (auto _ : state)
+    {
+        for (auto entity : entities)
+        {
+            commands.add_component(entity, Selected{1});
+        }
+        commands.playback(world);
+        for (auto entity : entities)
+        {
+            commands.remove_component<Selected>(entity);
+        }
+        commands.playback(world);
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_command_buffer_add_remove_component);
+
+/// --- Geometry gathering of the renderer: 1M entities with a LocalToWorldComponent and a RenderMeshComponent
+
+namespace
+{
+inline constexpr u32 RENDER_ENTITY_COUNT = 1'000'000;
+
+struct GatheredInstance
+{
+    float4x4 transform;
+    u32 i_mesh;
+    u32 i_material;
+};
+
+// shared by the benchmarks, creating the entities takes longer than iterating them
+ECS::World &render_world()
+{
+    static ECS::World world;
+    if (world.count<const LocalToWorldComponent>() == 0)
+    {
+        for (u32 i = 0; i < RENDER_ENTITY_COUNT; i += 1)
+        {
+            world.create_entity(LocalToWorldComponent{.transform = float4x4::identity()},
+                                RenderMeshComponent{.i_mesh = i % 64, .i_material = i % 16});
+        }
+    }
+    return world;
+}
+} // namespace
+
+static void ecs_gather_render_instances(bench::State &state)
+{
+    auto &world = render_world();
+    Vec<GatheredInstance> instances(RENDER_ENTITY_COUNT);
+
+    state.set_items_per_iteration(RENDER_ENTITY_COUNT);
+    for (auto _ : state)
+    {
+        usize i_instance = 0;
+        world.for_each<const LocalToWorldComponent, const RenderMeshComponent>(
+            [&](const LocalToWorldComponent &local_to_world, const RenderMeshComponent &render_mesh) {
+                instances[i_instance++] = {local_to_world.transform, render_mesh.i_mesh, render_mesh.i_material};
+            });
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(ecs_gather_render_instances);
+
+static void ecs_par_gather_render_instances(bench::State &state)
+{
+    auto &world = render_world();
+    Vec<GatheredInstance> instances(RENDER_ENTITY_COUNT);
+    jobs::init();
+
+    state.set_items_per_iteration(RENDER_ENTITY_COUNT);
+    for (auto _ : state)
+    {
+        world.par_for_each_chunk<const LocalToWorldComponent, const RenderMeshComponent>(
+            4,
+            [&](usize first_index, usize row_count, const LocalToWorldComponent *local_to_worlds, const RenderMeshComponent *render_meshes) {
+                for (usize i_row = 0; i_row < row_count; i_row += 1)
+                {
+                    instances[first_index + i_row] = {local_to_worlds[i_row].transform, render_meshes[i_row].i_mesh, render_meshes[i_row].i_material};
+                }
+            });
+        bench::clobber_memory();
+    }
+
+    jobs::shutdown();
+}
+BENCHMARK(ecs_par_gather_render_instances);
@@ -0,0 +1,468 @@
+#include "bench.h"
+
+#include <exo/batch_transforms.h>
+#include <exo/bitset_allocator.h>
+#include <exo/collections/pool.h>
+#include <exo/collections/vector.h>
+#include <exo/free_list.h>
+#include <exo/offset_allocator.h>
+#include <exo/vectors.h>
+
+#include <random>
+
+/// --- Pool
+
+inline constexpr u32 POOL_SIZE = 4096;
+
+static void pool_add_remove(bench::State &state)
+{
+    Pool<u64> pool{POOL_SIZE};
+    Vec<Handle<u64>> handles(POOL_SIZE);
+
+    state.set_items_per_iteration(POOL_SIZE);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < POOL_SIZE; i += 1)
+        {
+            handles[i] = pool.add(u64(i));
+        }
+        for (u32 i = 0; i < POOL_SIZE; i += 1)
+        {
+            pool.remove(handles[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(pool_add_remove);
+
+static void pool_iterate(bench::State &state)
+{
+    // remove every other element to iterate over holes
+    Pool<u64> pool{POOL_SIZE};
+    for (u32 i = 0; i < POOL_SIZE; i += 1)
+    {
+        auto handle = pool.add(u64(i));
+        if (i % 2)
+        {
+            pool.remove(handle);
+        }
+    }
+
+    state.set_items_per_iteration(pool.size());
+    for (auto _ : state)
+    {
+        u64 sum = 0;
+        for (auto [handle, value] : pool)
+        {
+            sum += *value;
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+BENCHMARK(pool_iterate);
+
+/// --- FreeList
+
+static void free_list_allocate_free(bench::State &state)
+{
+    auto free_list = FreeList::create(POOL_SIZE);
+    Vec<u32> indices(POOL_SIZE);
+
+    state.set_items_per_iteration(POOL_SIZE);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < POOL_SIZE; i += 1)
+        {
+            indices[i] = free_list.allocate();
+        }
+        // free in a different order than the allocations
+        for (u32 i = 0; i < POOL_SIZE; i += 2)
+        {
+            free_list.free(indices[i]);
+        }
+        for (u32 i = 1; i < POOL_SIZE; i += 2)
+        {
+            free_list.free(indices[i]);
+        }
+        bench::clobber_memory();
+    }
+
+    free_list.destroy();
+}
+BENCHMARK(free_list_allocate_free);
+
+/// --- BitsetAllocator
+
+inline constexpr u32 BITSET_CAPACITY = 16 * 1024;
+inline constexpr u32 BITSET_BATCH    = 64;
+
+// same pattern as free_list_allocate_free
+static void bitset_allocator_allocate_free(bench::State &state)
+{
+    auto allocator = BitsetAllocator::create(POOL_SIZE);
+    Vec<u32> indices(POOL_SIZE);
+
+    state.set_items_per_iteration(POOL_SIZE);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < POOL_SIZE; i += 1)
+        {
+            indices[i] = allocator.allocate();
+        }
+        for (u32 i = 0; i < POOL_SIZE; i += 2)
+        {
+            allocator.free(indices[i]);
+        }
+        for (u32 i = 1; i < POOL_SIZE; i += 2)
+        {
+            allocator.free(indices[i]);
+        }
+        bench::clobber_memory();
+    }
+
+    allocator.destroy();
+}
+BENCHMARK(bitset_allocator_allocate_free);
+
+// the low half of the indices stays allocated so that every allocation has to search past it
+static void bitset_allocator_allocate_free_half_full(bench::State &state)
+{
+    auto allocator = BitsetAllocator::create(BITSET_CAPACITY);
+    for (u32 i = 0; i < BITSET_CAPACITY / 2; i += 1)
+    {
+        allocator.allocate();
+    }
+    u32 indices[BITSET_BATCH];
+
+    state.set_items_per_iteration(BITSET_CAPACITY);
+    for (auto _ : state)
+    {
+        for (u32 i_batch = 0; i_batch < BITSET_CAPACITY / BITSET_BATCH; i_batch += 1)
+        {
+            for (auto &index : indices)
+            {
+                index = allocator.allocate();
+            }
+            for (auto index : indices)
+            {
+                allocator.free(index);
+            }
+        }
+        bench::clobber_memory();
+    }
+
+    allocator.destroy();
+}
+BENCHMARK(bitset_allocator_allocate_free_half_full);
+
+static void free_list_allocate_free_batch(bench::State &state)
+{
+    auto free_list = FreeList::create(BITSET_CAPACITY);
+    u32 indices[BITSET_BATCH];
+
+    state.set_items_per_iteration(BITSET_CAPACITY);
+    for (auto _ : state)
+    {
+        for (u32 i_batch = 0; i_batch < BITSET_CAPACITY / BITSET_BATCH; i_batch += 1)
+        {
+            for (auto &index : indices)
+            {
+                index = free_list.allocate();
+            }
+            for (auto index : indices)
+            {
+                free_list.free(index);
+            }
+        }
+        bench::clobber_memory();
+    }
+
+    free_list.destroy();
+}
+BENCHMARK(free_list_allocate_free_batch);
+
+/// --- OffsetAllocator
+
+inline constexpr u32 OFFSET_ALLOCATOR_SIZE       = 256u << 20;
+inline constexpr u32 OFFSET_ALLOCATOR_OPERATIONS = 64 * 1024;
+inline constexpr u32 OFFSET_ALLOCATOR_MAX_LIVE   = 2048;
+
+// Random sizes between 16 B and 256 KiB, each operation frees a random allocation or allocates a new one.
+// The allocations stay live between iterations, the allocator is measured once it is fragmented.
+static void offset_allocator_random(bench::State &state)
+{
+    std::mt19937 rng{5};
+    Vec<u32> sizes(OFFSET_ALLOCATOR_OPERATIONS);
+    for (auto &size : sizes)
+    {
+        size = 16 + rng() % (256 * 1024);
+    }
+
+    auto allocator = OffsetAllocator::create(OFFSET_ALLOCATOR_SIZE);
+    Vec<OffsetAllocation> live;
+    live.reserve(OFFSET_ALLOCATOR_MAX_LIVE);
+
+    state.set_items_per_iteration(OFFSET_ALLOCATOR_OPERATIONS);
+    for (auto _ : state)
+    {
+        for (u32 size : sizes)
+        {
+            if (live.size() >= OFFSET_ALLOCATOR_MAX_LIVE || (!live.empty() && (size & 1)))
+            {
+                usize i_live = size % live.size();
+                allocator.free(live[i_live]);
+                live[i_live] = live.back();
+                live.pop_back();
+            }
+            else
+            {
+                auto allocation = allocator.allocate(size, 256);
+                if (allocation.is_valid())
+                {
+                    live.push_back(allocation);
+                }
+            }
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(offset_allocator_random);
+
+/// --- float4x4
+
+inline constexpr u32 MATRIX_COUNT = 1024;
+
+// rigid transforms, chaining them doesn't overflow or produce denormals
+static Vec<float4x4> create_matrices()
+{
+    Vec<float3> translations(MATRIX_COUNT);
+    Vec<float4> rotations(MATRIX_COUNT);
+    Vec<float3> scales(MATRIX_COUNT, float3(1.0f));
+    for (u32 i = 0; i < MATRIX_COUNT; i += 1)
+    {
+        translations[i] = 0.01f * float3(float(i % 3), float(i % 5), float(i % 7));
+        rotations[i]    = normalize(float4(float(i % 11) + 1.0f, float(i % 13), float(i % 17), 8.0f));
+    }
+
+    Vec<float4x4> matrices(MATRIX_COUNT);
+    compose_trs(translations, rotations, scales, matrices);
+    return matrices;
+}
+
+static void float4x4_multiply(bench::State &state)
+{
+    auto matrices = create_matrices();
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        float4x4 result = float4x4::identity();
+        for (const auto &matrix : matrices)
+        {
+            result = result * matrix;
+        }
+        bench::do_not_optimize(result);
+    }
+}
+BENCHMARK(float4x4_multiply);
+
+static void float4x4_transform_vector(bench::State &state)
+{
+    auto matrices = create_matrices();
+    Vec<float4> vectors(MATRIX_COUNT, float4(1.0f, 2.0f, 3.0f, 1.0f));
+    Vec<float4> results(MATRIX_COUNT);
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < MATRIX_COUNT; i += 1)
+        {
+            results[i] = matrices[i] * vectors[i];
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(float4x4_transform_vector);
+
+// reference implementations without SIMD
+static float4x4 scalar_multiply(const float4x4 &a, const float4x4 &b)
+{
+    float4x4 result;
+    for (usize col = 0; col < 4; col++)
+    {
+        for (usize row = 0; row < 4; row++)
+        {
+            for (usize i = 0; i < 4; i++)
+            {
+                result.at(row, col) += a.at(row, i) * b.at(i, col);
+            }
+        }
+    }
+    return result;
+}
+
+static float4 scalar_multiply(const float4x4 &m, const float4 &v)
+{
+    float4 result;
+    for (usize row = 0; row < 4; row++)
+    {
+        for (usize col = 0; col < 4; col++)
+        {
+            result.raw[row] += m.at(row, col) * v.raw[col];
+        }
+    }
+    return result;
+}
+
+// independent products, unlike float4x4_multiply that chains them
+static void float4x4_multiply_parent(bench::State &state)
+{
+    auto matrices   = create_matrices();
+    float4x4 parent = matrices[1];
+    Vec<float4x4> results(MATRIX_COUNT);
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < MATRIX_COUNT; i += 1)
+        {
+            results[i] = parent * matrices[i];
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(float4x4_multiply_parent);
+
+static void float4x4_multiply_parent_scalar(bench::State &state)
+{
+    auto matrices   = create_matrices();
+    float4x4 parent = matrices[1];
+    Vec<float4x4> results(MATRIX_COUNT);
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < MATRIX_COUNT; i += 1)
+        {
+            results[i] = scalar_multiply(parent, matrices[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(float4x4_multiply_parent_scalar);
+
+static void float4x4_transform_vector_scalar(bench::State &state)
+{
+    auto matrices = create_matrices();
+    Vec<float4> vectors(MATRIX_COUNT, float4(1.0f, 2.0f, 3.0f, 1.0f));
+    Vec<float4> results(MATRIX_COUNT);
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < MATRIX_COUNT; i += 1)
+        {
+            results[i] = scalar_multiply(matrices[i], vectors[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(float4x4_transform_vector_scalar);
+
+static void float4x4_multiply_many(bench::State &state)
+{
+    auto matrices = create_matrices();
+    float4x4 parent = matrices[1];
+
+    state.set_items_per_iteration(MATRIX_COUNT);
+    for (auto _ : state)
+    {
+        multiply_many(parent, matrices);
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(float4x4_multiply_many);
+
+/// --- Batch transforms: parent * T * R * S for every node, one iteration goes over TRS_COUNT nodes
+
+inline constexpr u32 TRS_COUNT = 256 * 1024;
+
+struct TRSInputs
+{
+    Vec<float3> translations;
+    Vec<float4> rotations;
+    Vec<float3> scales;
+};
+
+static TRSInputs create_trs_inputs()
+{
+    TRSInputs inputs = {Vec<float3>(TRS_COUNT), Vec<float4>(TRS_COUNT), Vec<float3>(TRS_COUNT)};
+
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+    for (u32 i = 0; i < TRS_COUNT; i += 1)
+    {
+        inputs.translations[i] = 100.0f * float3(distribution(rng), distribution(rng), distribution(rng));
+        inputs.rotations[i]    = normalize(float4(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+        inputs.scales[i]       = float3(1.5f) + float3(distribution(rng), distribution(rng), distribution(rng));
+    }
+    return inputs;
+}
+
+// The per-element path: one matrix per transform and two full matrix products
+static float4x4 trs_matrix(float3 t, float4 q, float3 s)
+{
+    float4x4 translation = float4x4::identity();
+    translation.at(0, 3) = t.x;
+    translation.at(1, 3) = t.y;
+    translation.at(2, 3) = t.z;
+
+    float4x4 rotation({
+        1.0f - 2.0f*q.y*q.y - 2.0f*q.z*q.z, 2.0f*q.x*q.y - 2.0f*q.z*q.w, 2.0f*q.x*q.z + 2.0f*q.y*q.w, 0.0f,
+        2.0f*q.x*q.y + 2.0f*q.z*q.w, 1.0f - 2.0f*q.x*q.x - 2.0f*q.z*q.z, 2.0f*q.y*q.z - 2.0f*q.x*q.w, 0.0f,
+        2.0f*q.x*q.z - 2.0f*q.y*q.w, 2.0f*q.y*q.z + 2.0f*q.x*q.w, 1.0f - 2.0f*q.x*q.x - 2.0f*q.y*q.y, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f,
+    });
+
+    float4x4 scale = {};
+    scale.at(0, 0) = s.x;
+    scale.at(1, 1) = s.y;
+    scale.at(2, 2) = s.z;
+    scale.at(3, 3) = 1.0f;
+
+    return translation * rotation * scale;
+}
+
+static void trs_per_element(bench::State &state)
+{
+    auto inputs     = create_trs_inputs();
+    float4x4 parent = trs_matrix(inputs.translations[0], inputs.rotations[0], inputs.scales[0]);
+    Vec<float4x4> matrices(TRS_COUNT);
+
+    state.set_items_per_iteration(TRS_COUNT);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < TRS_COUNT; i += 1)
+        {
+            matrices[i] = parent * trs_matrix(inputs.translations[i], inputs.rotations[i], inputs.scales[i]);
+        }
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(trs_per_element);
+
+static void trs_compose_multiply_many(bench::State &state)
+{
+    auto inputs     = create_trs_inputs();
+    float4x4 parent = trs_matrix(inputs.translations[0], inputs.rotations[0], inputs.scales[0]);
+    Vec<float4x4> matrices(TRS_COUNT);
+
+    state.set_items_per_iteration(TRS_COUNT);
+    for (auto _ : state)
+    {
+        compose_trs(inputs.translations, inputs.rotations, inputs.scales, matrices);
+        multiply_many(parent, matrices);
+        bench::clobber_memory();
+    }
+}
+BENCHMARK(trs_compose_multiply_many);
@@ -0,0 +1,119 @@
+#include "bench.h"
+
+#include "glb.h"
+
+#include <exo/collections/vector.h>
+
+#include <fmt/format.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+/// --- Synthetic GLB file: a root node with one child per mesh, each mesh is a grid of triangles
+
+inline constexpr u32 GLB_MESH_COUNT = 16;
+inline constexpr u32 GLB_GRID_SIZE  = 64; // vertices per side
+
+static void append_bytes(std::string &buffer, const void *data, usize size)
+{
+    buffer.append(reinterpret_cast<const char *>(data), size);
+}
+
+static void pad_to_4(std::string &buffer, char padding)
+{
+    while (buffer.size() % 4)
+    {
+        buffer.push_back(padding);
+    }
+}
+
+static std::string create_synthetic_glb()
+{
+    constexpr u32 vertex_count = GLB_GRID_SIZE * GLB_GRID_SIZE;
+    constexpr u32 index_count  = (GLB_GRID_SIZE - 1) * (GLB_GRID_SIZE - 1) * 6;
+
+    // The binary chunk contains the same grid for every mesh, but each mesh has its own buffer views
+    std::string binary;
+    for (u32 y = 0; y < GLB_GRID_SIZE; y += 1)
+    {
+        for (u32 x = 0; x < GLB_GRID_SIZE; x += 1)
+        {
+            float position[3] = {float(x), 0.0f, float(y)};
+            append_bytes(binary, position, sizeof(position));
+        }
+    }
+    const usize positions_size = binary.size();
+
+    for (u32 y = 0; y + 1 < GLB_GRID_SIZE; y += 1)
+    {
+        for (u32 x = 0; x + 1 < GLB_GRID_SIZE; x += 1)
+        {
+            u32 i0      = y * GLB_GRID_SIZE + x;
+            u32 quad[6] = {i0, i0 + GLB_GRID_SIZE, i0 + 1, i0 + 1, i0 + GLB_GRID_SIZE, i0 + GLB_GRID_SIZE + 1};
+            append_bytes(binary, quad, sizeof(quad));
+        }
+    }
+    const usize indices_size = binary.size() - positions_size;
+
+    std::string buffer_views, accessors, meshes, nodes, children;
+    for (u32 i_mesh = 0; i_mesh < GLB_MESH_COUNT; i_mesh += 1)
+    {
+        const char *separator = i_mesh ? "," : "";
+        buffer_views += fmt::format("{}{{\"buffer\":0,\"byteOffset\":0,\"byteLength\":{}}},{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{}}}",
+                                    separator, positions_size, positions_size, indices_size);
+        accessors += fmt::format("{}{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC3\"}},"
+                                 "{{\"bufferView\":{},\"componentType\":5125,\"count\":{},\"type\":\"SCALAR\"}}",
+                                 separator, 2 * i_mesh, vertex_count, 2 * i_mesh + 1, index_count);
+        meshes += fmt::format("{}{{\"primitives\":[{{\"attributes\":{{\"POSITION\":{}}},\"indices\":{}}}]}}",
+                              separator, 2 * i_mesh, 2 * i_mesh + 1);
+        nodes += fmt::format(",{{\"mesh\":{},\"translation\":[{},0,0],\"rotation\":[0,0.7071068,0,0.7071068],\"scale\":[2,2,2]}}",
+                             i_mesh, i_mesh * GLB_GRID_SIZE);
+        children += fmt::format("{}{}", separator, i_mesh + 1);
+    }
+
+    std::string json = fmt::format("{{\"asset\":{{\"version\":\"2.0\"}},\"scene\":0,\"scenes\":[{{\"nodes\":[0]}}],"
+                                   "\"nodes\":[{{\"children\":[{}]}}{}],\"meshes\":[{}],\"accessors\":[{}],"
+                                   "\"bufferViews\":[{}],\"buffers\":[{{\"byteLength\":{}}}]}}",
+                                   children, nodes, meshes, accessors, buffer_views, binary.size());
+    pad_to_4(json, ' ');
+    pad_to_4(binary, '\0');
+
+    const u32 json_chunk[2]   = {static_cast<u32>(json.size()), 0x4E4F534A};
+    const u32 binary_chunk[2] = {static_cast<u32>(binary.size()), 0x004E4942};
+    const u32 header[3]       = {0x46546C67, 2, static_cast<u32>(12 + 8 + json.size() + 8 + binary.size())};
+
+    std::string glb;
+    append_bytes(glb, header, sizeof(header));
+    append_bytes(glb, json_chunk, sizeof(json_chunk));
+    glb += json;
+    append_bytes(glb, binary_chunk, sizeof(binary_chunk));
+    glb += binary;
+    return glb;
+}
+
+static void glb_load_synthetic(bench::State &state)
+{
+    auto path = (std::filesystem::temp_directory_path() / "bench_synthetic.glb").string();
+    {
+        auto glb   = create_synthetic_glb();
+        FILE *file = std::fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            fmt::print(stderr, "Failed to write {}\n", path);
+            return;
+        }
+        std::fwrite(glb.data(), 1, glb.size(), file);
+        std::fclose(file);
+    }
+
+    state.set_items_per_iteration(GLB_MESH_COUNT);
+    for (auto _ : state)
+    {
+        auto scene = glb::load_file(path);
+        bench::do_not_optimize(scene.instances.size());
+    }
+
+    std::remove(path.c_str());
+}
+BENCHMARK(glb_load_synthetic);
@@ -0,0 +1,79 @@
+#include "bench.h"
+
+#include <exo/collections/vector.h>
+#include <exo/hash.h>
+
+#include <functional>
+#include <string_view>
+
+/// --- Hashing: one iteration hashes HASH_BUFFER_SIZE bytes split in inputs of the same length, items are bytes
+
+inline constexpr usize HASH_BUFFER_SIZE = 4 * 1024 * 1024;
+
+static Vec<u8> create_hash_bytes()
+{
+    Vec<u8> bytes(HASH_BUFFER_SIZE);
+    for (usize i = 0; i < bytes.size(); i += 1)
+    {
+        bytes[i] = static_cast<u8>(i * 7);
+    }
+    return bytes;
+}
+
+template <usize length> static void hash_bytes(bench::State &state)
+{
+    auto bytes = create_hash_bytes();
+
+    state.set_items_per_iteration(HASH_BUFFER_SIZE);
+    for (auto _ : state)
+    {
+        u64 sum = 0;
+        for (usize offset = 0; offset < HASH_BUFFER_SIZE; offset += length)
+        {
+            sum += hash_bytes(bytes.data() + offset, length);
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+
+template <usize length> static void std_hash(bench::State &state)
+{
+    auto bytes = create_hash_bytes();
+
+    state.set_items_per_iteration(HASH_BUFFER_SIZE);
+    for (auto _ : state)
+    {
+        u64 sum = 0;
+        for (usize offset = 0; offset < HASH_BUFFER_SIZE; offset += length)
+        {
+            sum += std::hash<std::string_view>{}(std::string_view{reinterpret_cast<const char *>(bytes.data()) + offset, length});
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+
+static void hash_bytes_8(bench::State &state) { hash_bytes<8>(state); }
+static void hash_bytes_32(bench::State &state) { hash_bytes<32>(state); }
+static void hash_bytes_128(bench::State &state) { hash_bytes<128>(state); }
+static void hash_bytes_1k(bench::State &state) { hash_bytes<1024>(state); }
+static void hash_bytes_64k(bench::State &state) { hash_bytes<64 * 1024>(state); }
+static void hash_bytes_4m(bench::State &state) { hash_bytes<HASH_BUFFER_SIZE>(state); }
+BENCHMARK(hash_bytes_8);
+BENCHMARK(hash_bytes_32);
+BENCHMARK(hash_bytes_128);
+BENCHMARK(hash_bytes_1k);
+BENCHMARK(hash_bytes_64k);
+BENCHMARK(hash_bytes_4m);
+
+static void std_hash_8(bench::State &state) { std_hash<8>(state); }
+static void std_hash_32(bench::State &state) { std_hash<32>(state); }
+static void std_hash_128(bench::State &state) { std_hash<128>(state); }
+static void std_hash_1k(bench::State &state) { std_hash<1024>(state); }
+static void std_hash_64k(bench::State &state) { std_hash<64 * 1024>(state); }
+static void std_hash_4m(bench::State &state) { std_hash<HASH_BUFFER_SIZE>(state); }
+BENCHMARK(std_hash_8);
+BENCHMARK(std_hash_32);
+BENCHMARK(std_hash_128);
+BENCHMARK(std_hash_1k);
+BENCHMARK(std_hash_64k);
+BENCHMARK(std_hash_4m);
@@ -0,0 +1,142 @@
+#include "bench.h"
+
+#include <exo/collections/vector.h>
+#include <exo/map.h>
+
+#include <random>
+#include <unordered_map>
+
+/// --- Map against std::unordered_map with random u64 keys, one iteration goes over all the keys
+
+static Vec<u64> create_map_keys(usize count)
+{
+    Vec<u64> keys(count);
+    std::mt19937_64 rng{count};
+    for (auto &key : keys)
+    {
+        key = rng();
+    }
+    return keys;
+}
+
+template <typename MapType, usize count> static void map_insert(bench::State &state)
+{
+    auto keys = create_map_keys(count);
+
+    state.set_items_per_iteration(count);
+    for (auto _ : state)
+    {
+        MapType map;
+        for (u64 key : keys)
+        {
+            map[key] = key;
+        }
+        bench::do_not_optimize(map);
+    }
+}
+
+// half of the lookups find their key
+template <typename MapType, usize count> static void map_lookup(bench::State &state)
+{
+    auto keys = create_map_keys(count);
+    MapType map;
+    for (u64 key : keys)
+    {
+        map[key] = key;
+    }
+
+    state.set_items_per_iteration(2 * count);
+    for (auto _ : state)
+    {
+        u64 sum = 0;
+        for (u64 key : keys)
+        {
+            sum += map.find(key)->second;
+        }
+        for (u64 key : keys)
+        {
+            sum += map.contains(~key);
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+
+template <typename MapType, usize count> static void map_iterate(bench::State &state)
+{
+    auto keys = create_map_keys(count);
+    MapType map;
+    for (u64 key : keys)
+    {
+        map[key] = key;
+    }
+
+    state.set_items_per_iteration(count);
+    for (auto _ : state)
+    {
+        u64 sum = 0;
+        for (const auto &[key, value] : map)
+        {
+            sum += value;
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+
+template <typename MapType, usize count> static void map_insert_erase(bench::State &state)
+{
+    auto keys = create_map_keys(count);
+    MapType map;
+
+    state.set_items_per_iteration(2 * count);
+    for (auto _ : state)
+    {
+        for (u64 key : keys)
+        {
+            map[key] = key;
+        }
+        for (u64 key : keys)
+        {
+            map.erase(key);
+        }
+        bench::clobber_memory();
+    }
+}
+
+using ExoMap = Map<u64, u64>;
+using StdMap = std::unordered_map<u64, u64>;
+
+static void map_insert_1k(bench::State &state) { map_insert<ExoMap, 1'000>(state); }
+static void map_insert_100k(bench::State &state) { map_insert<ExoMap, 100'000>(state); }
+static void map_insert_1m(bench::State &state) { map_insert<ExoMap, 1'000'000>(state); }
+static void std_unordered_map_insert_1k(bench::State &state) { map_insert<StdMap, 1'000>(state); }
+static void std_unordered_map_insert_100k(bench::State &state) { map_insert<StdMap, 100'000>(state); }
+static void std_unordered_map_insert_1m(bench::State &state) { map_insert<StdMap, 1'000'000>(state); }
+BENCHMARK(map_insert_1k);
+BENCHMARK(map_insert_100k);
+BENCHMARK(map_insert_1m);
+BENCHMARK(std_unordered_map_insert_1k);
+BENCHMARK(std_unordered_map_insert_100k);
+BENCHMARK(std_unordered_map_insert_1m);
+
+static void map_lookup_1k(bench::State &state) { map_lookup<ExoMap, 1'000>(state); }
+static void map_lookup_100k(bench::State &state) { map_lookup<ExoMap, 100'000>(state); }
+static void map_lookup_1m(bench::State &state) { map_lookup<ExoMap, 1'000'000>(state); }
+static void std_unordered_map_lookup_1k(bench::State &state) { map_lookup<StdMap, 1'000>(state); }
+static void std_unordered_map_lookup_100k(bench::State &state) { map_lookup<StdMap, 100'000>(state); }
+static void std_unordered_map_lookup_1m(bench::State &state) { map_lookup<StdMap, 1'000'000>(state); }
+BENCHMARK(map_lookup_1k);
+BENCHMARK(map_lookup_100k);
+BENCHMARK(map_lookup_1m);
+BENCHMARK(std_unordered_map_lookup_1k);
+BENCHMARK(std_unordered_map_lookup_100k);
+BENCHMARK(std_unordered_map_lookup_1m);
+
+static void map_iterate_100k(bench::State &state) { map_iterate<ExoMap, 100'000>(state); }
+static void std_unordered_map_iterate_100k(bench::State &state) { map_iterate<StdMap, 100'000>(state); }
+BENCHMARK(map_iterate_100k);
+BENCHMARK(std_unordered_map_iterate_100k);
+
+static void map_insert_erase_100k(bench::State &state) { map_insert_erase<ExoMap, 100'000>(state); }
+static void std_unordered_map_insert_erase_100k(bench::State &state) { map_insert_erase<StdMap, 100'000>(state); }
+BENCHMARK(map_insert_erase_100k);
+BENCHMARK(std_unordered_map_insert_erase_100k);
@@ -0,0 +1,135 @@
+#include "bench.h"
+
+#include <exo/collections/concurrent_queue.h>
+#include <exo/collections/vector.h>
+
+#include <memory>
+#include <thread>
+
+/// --- Queues: producer threads push while the benchmark thread pops, one iteration moves QUEUE_ITEMS elements
+
+inline constexpr u32 QUEUE_ITEMS    = 1024;
+inline constexpr u32 QUEUE_CAPACITY = 1024;
+inline constexpr u32 QUEUE_BATCH    = 32;
+
+static void spsc_push_pop(bench::State &state)
+{
+    auto queue      = std::make_unique<SPSCQueue<u64, QUEUE_CAPACITY>>();
+    const u64 total = state.iterations * QUEUE_ITEMS;
+
+    std::thread producer([&]() {
+        for (u64 i = 0; i < total; i += 1)
+        {
+            queue->push(i);
+        }
+    });
+
+    state.set_items_per_iteration(QUEUE_ITEMS);
+    for (auto _ : state)
+    {
+        u64 value = 0;
+        for (u32 i = 0; i < QUEUE_ITEMS; i += 1)
+        {
+            queue->pop(value);
+        }
+        bench::do_not_optimize(value);
+    }
+    producer.join();
+}
+BENCHMARK(spsc_push_pop);
+
+static void spsc_push_pop_batch(bench::State &state)
+{
+    auto queue      = std::make_unique<SPSCQueue<u64, QUEUE_CAPACITY>>();
+    const u64 total = state.iterations * QUEUE_ITEMS;
+
+    std::thread producer([&]() {
+        u64 batch[QUEUE_BATCH];
+        for (u64 i = 0; i < total;)
+        {
+            u32 count = total - i < QUEUE_BATCH ? static_cast<u32>(total - i) : QUEUE_BATCH;
+            for (u32 j = 0; j < count; j += 1)
+            {
+                batch[j] = i + j;
+            }
+            u32 pushed = queue->try_push_batch(batch, count);
+            if (pushed == 0)
+            {
+                queue->push(batch[0]);
+                pushed = 1;
+            }
+            i += pushed;
+        }
+    });
+
+    state.set_items_per_iteration(QUEUE_ITEMS);
+    for (auto _ : state)
+    {
+        u64 batch[QUEUE_BATCH];
+        for (u32 received = 0; received < QUEUE_ITEMS;)
+        {
+            u32 max_count = QUEUE_ITEMS - received < QUEUE_BATCH ? QUEUE_ITEMS - received : QUEUE_BATCH;
+            u32 popped    = queue->try_pop_batch(batch, max_count);
+            if (popped == 0)
+            {
+                queue->pop(batch[0]);
+                popped = 1;
+            }
+            received += popped;
+        }
+        bench::do_not_optimize(batch);
+    }
+    producer.join();
+}
+BENCHMARK(spsc_push_pop_batch);
+
+template <u32 producer_count> static void mpsc_push_pop(bench::State &state)
+{
+    auto queue      = std::make_unique<MPSCQueue<u64, QUEUE_CAPACITY>>();
+    const u64 total = state.iterations * QUEUE_ITEMS;
+
+    Vec<std::thread> producers;
+    for (u32 i_producer = 0; i_producer < producer_count; i_producer += 1)
+    {
+        // the first producer also pushes the remainder
+        u64 count = total / producer_count + (i_producer == 0 ? total % producer_count : 0);
+        producers.emplace_back([&queue, count]() {
+            for (u64 i = 0; i < count; i += 1)
+            {
+                queue->push(i);
+            }
+        });
+    }
+
+    state.set_items_per_iteration(QUEUE_ITEMS);
+    for (auto _ : state)
+    {
+        u64 batch[QUEUE_BATCH];
+        for (u32 received = 0; received < QUEUE_ITEMS;)
+        {
+            u32 max_count = QUEUE_ITEMS - received < QUEUE_BATCH ? QUEUE_ITEMS - received : QUEUE_BATCH;
+            u32 popped    = queue->try_pop_batch(batch, max_count);
+            if (popped == 0)
+            {
+                queue->pop(batch[0]);
+                popped = 1;
+            }
+            received += popped;
+        }
+        bench::do_not_optimize(batch);
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+}
+
+static void mpsc_push_pop_1(bench::State &state) { mpsc_push_pop<1>(state); }
+static void mpsc_push_pop_2(bench::State &state) { mpsc_push_pop<2>(state); }
+static void mpsc_push_pop_4(bench::State &state) { mpsc_push_pop<4>(state); }
+static void mpsc_push_pop_8(bench::State &state) { mpsc_push_pop<8>(state); }
+BENCHMARK(mpsc_push_pop_1);
+BENCHMARK(mpsc_push_pop_2);
+BENCHMARK(mpsc_push_pop_4);
+BENCHMARK(mpsc_push_pop_8);
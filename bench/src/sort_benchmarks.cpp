@@ -0,0 +1,96 @@
+#include "bench.h"
+
+#include <exo/collections/vector.h>
+#include <exo/radix_sort.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+/// --- Sorting 64-bit keys with a u32 payload, every iteration sorts a copy of the same random keys
+
+static Vec<u64> create_sort_keys(usize count)
+{
+    Vec<u64> keys(count);
+    u64 state = 0x9E3779B97F4A7C15;
+    for (auto &key : keys)
+    {
+        // splitmix64
+        state += 0x9E3779B97F4A7C15;
+        u64 z = state;
+        z     = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z     = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        key   = z ^ (z >> 31);
+    }
+    return keys;
+}
+
+template <usize count> static void std_sort(bench::State &state)
+{
+    auto source = create_sort_keys(count);
+    Vec<std::pair<u64, u32>> pairs(count);
+
+    state.set_items_per_iteration(count);
+    for (auto _ : state)
+    {
+        for (u32 i = 0; i < count; i += 1)
+        {
+            pairs[i] = {source[i], i};
+        }
+        std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        bench::clobber_memory();
+    }
+}
+
+template <usize count> static void radix_sort(bench::State &state)
+{
+    auto source = create_sort_keys(count);
+    Vec<u64> keys(count);
+    Vec<u32> values(count);
+    Vec<u64> keys_scratch(count);
+    Vec<u32> values_scratch(count);
+
+    state.set_items_per_iteration(count);
+    for (auto _ : state)
+    {
+        std::memcpy(keys.data(), source.data(), count * sizeof(u64));
+        for (u32 i = 0; i < count; i += 1)
+        {
+            values[i] = i;
+        }
+        radix_sort(keys, values, keys_scratch, values_scratch);
+        bench::clobber_memory();
+    }
+}
+
+template <usize count> static void radix_sort_in_place(bench::State &state)
+{
+    auto source = create_sort_keys(count);
+    Vec<u64> keys(count);
+    Vec<u32> values(count);
+
+    state.set_items_per_iteration(count);
+    for (auto _ : state)
+    {
+        std::memcpy(keys.data(), source.data(), count * sizeof(u64));
+        for (u32 i = 0; i < count; i += 1)
+        {
+            values[i] = i;
+        }
+        radix_sort_in_place(keys, values);
+        bench::clobber_memory();
+    }
+}
+
+static void sort_std_100k(bench::State &state) { std_sort<100'000>(state); }
+static void sort_std_1m(bench::State &state) { std_sort<1'000'000>(state); }
+static void sort_radix_100k(bench::State &state) { radix_sort<100'000>(state); }
+static void sort_radix_1m(bench::State &state) { radix_sort<1'000'000>(state); }
+static void sort_radix_in_place_100k(bench::State &state) { radix_sort_in_place<100'000>(state); }
+static void sort_radix_in_place_1m(bench::State &state) { radix_sort_in_place<1'000'000>(state); }
+BENCHMARK(sort_std_100k);
+BENCHMARK(sort_std_1m);
+BENCHMARK(sort_radix_100k);
+BENCHMARK(sort_radix_1m);
+BENCHMARK(sort_radix_in_place_100k);
+BENCHMARK(sort_radix_in_place_1m);
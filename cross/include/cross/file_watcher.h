@@ -63,7 +63,10 @@ struct FileWatcher
     Watch add_watch(const char *path);
     void on_file_change(const FileEventF &f);
 
+    // update() = fetch_events() + dispatch_events(), fetching doesn't call the callbacks and can run on any thread
     void update();
+    void fetch_events();
+    void dispatch_events();
     void destroy();
 };
 }
@@ -198,8 +198,14 @@ Watch FileWatcher::add_watch(const char *path) { return add_watch_internal(*this
 
 void FileWatcher::update()
 {
-    fetch_events_internal(*this);
+    fetch_events();
+    dispatch_events();
+}
+
+void FileWatcher::fetch_events() { fetch_events_internal(*this); }
 
+void FileWatcher::dispatch_events()
+{
     for (const auto &event : current_events)
     {
         const auto &watch = watch_from_event_internal(*this, event);
@@ -1,6 +1,8 @@
 #include "app.h"
 
 #include <exo/logger.h>
+#include <exo/profiler.h>
+#include <exo/memory_tracker.h>
 #include "camera.h"
 #include <cross/file_watcher.h>
 
@@ -38,10 +40,23 @@ App::App()
     inputs.bind(Action::CameraOrbit, {.mouse_buttons = {MouseButton::Right}});
 
     scene.init(&asset_manager);
+
+    // The file watcher fetches events while the UI and the scene update, its callbacks reload shaders after the frame is rendered
+    auto ui_task     = frame_graph.add_task("display ui", [this]() { display_ui(); }, true);
+    auto fetch_task  = frame_graph.add_task("fetch file events", [this]() { watcher.fetch_events(); });
+    auto scene_task  = frame_graph.add_task("scene update", [this]() { scene.update(inputs); });
+    auto render_task = frame_graph.add_task("render", [this]() { renderer.update(scene); }, true);
+    auto files_task  = frame_graph.add_task("file callbacks", [this]() { watcher.dispatch_events(); }, true);
+    frame_graph.add_dependency(ui_task, scene_task);
+    frame_graph.add_dependency(scene_task, render_task);
+    frame_graph.add_dependency(render_task, files_task);
+    frame_graph.add_dependency(fetch_task, files_task);
 }
 
 App::~App()
 {
+    logger::info("{}", memory_tracker::dump());
+
     scene.destroy();
     ui.destroy();
     renderer.destroy();
@@ -58,6 +73,87 @@ void App::display_ui()
     inputs.display_ui(ui);
     scene.display_ui(ui);
     asset_manager.display_ui(ui);
+    display_frame_graph();
+    display_memory();
+}
+
+void App::display_memory()
+{
+    static const StringId memory_window = "Memory";
+    if (ui.begin_window(memory_window))
+    {
+        if (ImGui::BeginTable("Tags", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Tag");
+            ImGui::TableSetupColumn("Current (KiB)");
+            ImGui::TableSetupColumn("Peak (KiB)");
+            ImGui::TableSetupColumn("Allocations");
+            ImGui::TableHeadersRow();
+
+            for (const auto &tag : memory_tracker::stats())
+            {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(tag.name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.1f", double(tag.current) / 1024.0);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f", double(tag.peak) / 1024.0);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%llu", static_cast<unsigned long long>(tag.allocation_count));
+            }
+            ImGui::EndTable();
+        }
+
+        ui.end_window();
+    }
+}
+
+void App::display_frame_graph()
+{
+    static const StringId frame_graph_window = "Frame graph";
+    if (ui.begin_window(frame_graph_window))
+    {
+        if (ImGui::Button("Copy graph to clipboard"))
+        {
+            ImGui::SetClipboardText(frame_graph.to_dot().c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save chrome trace"))
+        {
+            if (!profiler::write_chrome_trace("trace.json"))
+            {
+                logger::error("Failed to write trace.json\n");
+            }
+        }
+
+        if (ImGui::BeginTable("Tasks", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Task");
+            ImGui::TableSetupColumn("Start (ms)");
+            ImGui::TableSetupColumn("Duration (ms)");
+            ImGui::TableSetupColumn("Thread");
+            ImGui::TableHeadersRow();
+
+            // Timings of the previous frame, the current one is still running
+            for (usize i_task = 0; i_task < frame_timings.size(); i_task += 1)
+            {
+                const auto &timing = frame_timings[i_task];
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(frame_graph.tasks[i_task].name.c_str());
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f", timing.start_ms);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.3f", timing.duration_ms);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%d", timing.thread_index == u32_invalid ? -1 : int(timing.thread_index));
+            }
+            ImGui::EndTable();
+        }
+
+        ui.end_window();
+    }
 }
 
 void App::run()
@@ -110,9 +206,12 @@ void App::run()
             continue;
         }
 
-        display_ui();
-        scene.update(inputs);
-        renderer.update(scene);
-        watcher.update();
+        frame_graph.execute();
+
+        frame_timings.clear();
+        for (const auto &task : frame_graph.tasks)
+        {
+            frame_timings.push_back(task.timing);
+        }
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "asset_manager.h"
 #include <exo/types.h>
+#include <exo/task_graph.h>
 #include <cross/file_watcher.h>
 #include "inputs.h"
 #include <cross/window.h>
@@ -19,6 +20,8 @@ class App
   private:
     void camera_update();
     void display_ui();
+    void display_frame_graph();
+    void display_memory();
 
     UI::Context ui;
     platform::Window window;
@@ -31,4 +34,8 @@ class App
     platform::Watch shaders_watch;
 
     bool is_minimized;
+
+    // stages of a frame, built once in the constructor
+    TaskGraph frame_graph;
+    Vec<TaskTiming> frame_timings;
 };
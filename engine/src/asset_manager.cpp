@@ -107,7 +107,8 @@ void AssetManager::choose_mesh(Handle<Mesh> &selected)
 
 void AssetManager::display_ui(UI::Context &ui)
 {
-    if (ui.begin_window("Assets"))
+    static const StringId assets_window = "Assets";
+    if (ui.begin_window(assets_window))
     {
         if (ImGui::Button("Load texture"))
         {
@@ -1,11 +1,14 @@
 #include "ecs.h"
 #include "ui.h"
 
+#include <exo/algorithms.h>
 #include <exo/logger.h>
 
 #include <array>
+#include <atomic>
 #include <algorithm>
 #include <cstring>
+#include <span>
 #if defined(ENABLE_DOCTEST)
 #include <doctest.h>
 #endif
@@ -18,8 +21,16 @@ namespace ECS
 
 u64 family::identifier() noexcept
 {
-    static u64 value = 0;
-    return value++;
+    // entities can be created from any thread with an EntityCommandBuffer
+    static std::atomic<u64> value = 0;
+    return value.fetch_add(1, std::memory_order_relaxed);
+}
+
+u32 query_family::identifier() noexcept
+{
+    // systems run their first query concurrently on the job threads
+    static std::atomic<u32> value = 0;
+    return value.fetch_add(1, std::memory_order_relaxed);
 }
 
 std::string to_string(EntityId entity_id)
@@ -29,6 +40,47 @@ std::string to_string(EntityId entity_id)
     return fmt::format("{{ id: {}, is_component: {}, raw: {} }}", id, is_component, entity_id.raw);
 }
 
+/// --- Chunks
+
+ChunkPool::~ChunkPool()
+{
+    for (auto *chunk : free_chunks)
+    {
+        memory_tracker::on_free(memory_tracker::tag_index<EcsMemory>(), sizeof(Chunk));
+        delete chunk;
+    }
+}
+
+Chunk *ChunkPool::allocate()
+{
+    if (!free_chunks.empty())
+    {
+        auto *chunk = free_chunks.back();
+        free_chunks.pop_back();
+        return chunk;
+    }
+
+    memory_tracker::on_allocate(memory_tracker::tag_index<EcsMemory>(), sizeof(Chunk));
+    return new Chunk;
+}
+
+void ChunkPool::free(Chunk *chunk)
+{
+    free_chunks.push_back(chunk);
+}
+
+Archetypes::~Archetypes()
+{
+    for (auto &[storage_h, storage] : archetype_storages)
+    {
+        for (auto *chunk : storage->chunks)
+        {
+            chunk_pool.free(chunk);
+        }
+        storage->chunks.clear();
+    }
+}
+
 namespace impl
 {
 
@@ -49,8 +101,105 @@ Option<usize> get_component_idx(const Archetype &type, ComponentId component_id)
     return std::nullopt;
 }
 
+void update_query_cache(QueryCache &cache, const Archetypes &graph)
+{
+    assert(cache.graph == nullptr || cache.graph == &graph);
+    cache.graph = &graph;
+
+    for (; cache.archetypes_seen < graph.creation_order.size(); cache.archetypes_seen++)
+    {
+        auto storage_h                 = graph.creation_order[cache.archetypes_seen];
+        const auto *storage            = graph.archetype_storages.get(storage_h);
+        auto [contains, query_indices] = archetype_contains(cache.query, storage->type);
+        if (contains)
+        {
+            cache.archetypes.push_back(storage_h);
+            cache.columns.insert(cache.columns.end(), query_indices.begin(), query_indices.end());
+        }
+    }
+}
+
+usize query_entity_count(const Archetypes &graph, const QueryCache &cache)
+{
+    usize count = 0;
+    for (auto storage_h : cache.archetypes)
+    {
+        count += graph.archetype_storages.get(storage_h)->size;
+    }
+    return count;
+}
+
+bool queries_conflict(const QueryCache &a, const QueryCache &b)
+{
+    return accesses_conflict(a.query, a.writes, b.query, b.writes);
+}
+
+bool accesses_conflict(const Archetype &a_components, const Archetype &a_writes, const Archetype &b_components, const Archetype &b_writes)
+{
+    const auto writes_any = [](const Archetype &writes, const Archetype &components) {
+        return std::any_of(writes.begin(), writes.end(), [&](ComponentId component_id) {
+            return std::find(components.begin(), components.end(), component_id) != components.end();
+        });
+    };
+    return writes_any(a_writes, b_components) || writes_any(b_writes, a_components);
+}
+
+void gather_query_chunks(const Archetypes &graph, const QueryCache &cache, Vec<QueryChunk> &chunks)
+{
+    const usize component_count = cache.query.size();
+    usize first_index           = 0;
+    for (usize i_archetype = 0; i_archetype < cache.archetypes.size(); i_archetype++)
+    {
+        const auto *storage = graph.archetype_storages.get(cache.archetypes[i_archetype]);
+        const u32 *columns  = cache.columns.data() + i_archetype * component_count;
+        for (usize i_chunk = 0; i_chunk < storage->chunks.size(); i_chunk++)
+        {
+            chunks.push_back({.storage = storage, .columns = columns, .i_chunk = i_chunk, .first_index = first_index});
+            first_index += storage->chunk_row_count(i_chunk);
+        }
+    }
+}
+
 /// --- ArchetypeStorage impl
 
+void init_chunk_layout(ArchetypeStorage &storage, const Vec<u32> &component_sizes)
+{
+    storage.component_sizes.resize(storage.type.size());
+    storage.column_offsets.resize(storage.type.size());
+
+    usize row_size = sizeof(EntityId);
+    for (usize i_component = 0; i_component < storage.type.size(); i_component++)
+    {
+        auto component_id = storage.type[i_component];
+        assert(component_id.id < component_sizes.size() && component_sizes[component_id.id] != 0);
+        storage.component_sizes[i_component] = component_sizes[component_id.id];
+        row_size += storage.component_sizes[i_component];
+    }
+
+    // every column is aligned, remove entities until the padding fits
+    usize capacity = CHUNK_SIZE / row_size;
+    while (capacity > 0)
+    {
+        usize offset = round_up_to_alignment(CHUNK_COLUMN_ALIGNMENT, capacity * sizeof(EntityId));
+        for (usize i_component = 0; i_component < storage.type.size(); i_component++)
+        {
+            storage.column_offsets[i_component] = static_cast<u32>(offset);
+            offset = round_up_to_alignment(CHUNK_COLUMN_ALIGNMENT, offset + capacity * storage.component_sizes[i_component]);
+        }
+
+        if (offset <= CHUNK_SIZE)
+        {
+            break;
+        }
+        capacity -= 1;
+    }
+
+    // a component larger than a chunk cannot be stored
+    assert(capacity > 0);
+    storage.chunk_capacity = static_cast<u32>(capacity);
+}
+
+
 ArchetypeH find_or_create_archetype_storage_removing_component(Archetypes &graph, ArchetypeH entity_archetype,
                                                                ComponentId component_type)
 {
@@ -74,13 +223,14 @@ ArchetypeH find_or_create_archetype_storage_removing_component(Archetypes &graph
     {
         next_h         = graph.archetype_storages.add({});
         entity_storage = graph.archetype_storages.get(entity_archetype); // pointer was invalidated because of add()
+        graph.creation_order.push_back(next_h);
 
         auto *new_storage = graph.archetype_storages.get(next_h);
 
         // The new archetype type is the same as entity type without the component that we are removing
         new_storage->type = entity_storage->type;
         auto new_end      = std::remove(std::begin(new_storage->type), std::end(new_storage->type), component_type);
-        (void)(new_end);
+        new_storage->type.resize(static_cast<usize>(new_end - std::begin(new_storage->type)));
 
         // Add links if there is not enough space for the component_type
         new_storage->edges.reserve(component_type.id - new_storage->edges.size() + 1);
@@ -90,11 +240,7 @@ ArchetypeH find_or_create_archetype_storage_removing_component(Archetypes &graph
         }
         new_storage->edges[component_type.id].add = entity_archetype;
 
-        new_storage->components.resize(new_storage->type.size());
-        for (auto &component : new_storage->components)
-        {
-            component.component_size = 0; // TODO find actual size
-        }
+        init_chunk_layout(*new_storage, graph.component_sizes);
     }
 
     return next_h;
@@ -123,6 +269,7 @@ ArchetypeH find_or_create_archetype_storage_adding_component(Archetypes &graph,
     {
         next_h         = graph.archetype_storages.add({});
         entity_storage = graph.archetype_storages.get(entity_archetype); // pointer was invalidated because of add()
+        graph.creation_order.push_back(next_h);
 
         auto *new_storage = graph.archetype_storages.get(next_h);
 
@@ -138,11 +285,7 @@ ArchetypeH find_or_create_archetype_storage_adding_component(Archetypes &graph,
         }
         new_storage->edges[component_type.id].remove = entity_archetype;
 
-        new_storage->components.resize(new_storage->type.size());
-        for (auto &component : new_storage->components)
-        {
-            component.component_size = 0; // TODO find actual size
-        }
+        init_chunk_layout(*new_storage, graph.component_sizes);
     }
 
     return next_h;
@@ -159,80 +302,88 @@ ArchetypeH find_or_create_archetype_storage_from_root(Archetypes &graph, const A
     return current_archetype;
 }
 
-usize add_entity_id_to_storage(ArchetypeStorage &storage, EntityId entity)
+void register_component_size(Archetypes &graph, ComponentId component_id, usize component_size)
 {
-    usize row = storage.entity_ids.size();
-    storage.entity_ids.push_back(entity);
-    return row;
+    if (component_id.id >= graph.component_sizes.size())
+    {
+        graph.component_sizes.resize(component_id.id + 1, 0);
+    }
+    assert(graph.component_sizes[component_id.id] == 0 || graph.component_sizes[component_id.id] == component_size);
+    graph.component_sizes[component_id.id] = static_cast<u32>(component_size);
 }
 
-void add_component_to_storage(ArchetypeStorage &storage, usize i_component, void *data, usize len)
+usize add_entity_to_storage(ChunkPool &pool, ArchetypeStorage &storage, EntityId entity)
 {
-
-    auto &component_storage = storage.components[i_component];
-
-    // TODO: Remove this hack to fill the component_size correctly
-    assert(component_storage.component_size == 0 || component_storage.component_size == len);
-    if (component_storage.component_size == 0)
+    usize row = storage.size;
+    if (row == storage.chunks.size() * storage.chunk_capacity)
     {
-        component_storage.component_size = len;
+        storage.chunks.push_back(pool.allocate());
     }
 
-    usize total_size = (storage.size + 1) * component_storage.component_size;
+    storage.size += 1;
+    storage.entity_id(row) = entity;
+    return row;
+}
 
-    // reserve enough space to add a component
-    if (total_size > component_storage.data.size())
+usize add_rows_to_storage(ChunkPool &pool, ArchetypeStorage &storage, usize count)
+{
+    usize first_row = storage.size;
+    storage.size += count;
+    while (storage.size > storage.chunks.size() * storage.chunk_capacity)
     {
-        component_storage.data.reserve(total_size - component_storage.data.size());
-        while (component_storage.data.size() < total_size)
-        {
-            component_storage.data.push_back(0);
-        }
+        storage.chunks.push_back(pool.allocate());
     }
+    return first_row;
+}
 
-    auto *dst = &component_storage.data[storage.size * component_storage.component_size];
-
-    std::memcpy(dst, data, len);
+void add_component_to_storage(ArchetypeStorage &storage, usize row, usize i_component, const void *data, usize len)
+{
+    assert(storage.component_sizes[i_component] == len);
+    std::memcpy(storage.component(row, i_component), data, len);
 }
 
-void remove_entity_from_storage(ArchetypeStorage &storage, usize entity_row)
+void remove_entity_from_storage(ChunkPool &pool, ArchetypeStorage &storage, usize entity_row)
 {
-    auto entity_count = storage.entity_ids.size();
+    usize last_row = storage.size - 1;
 
     // copy the last element to the old row
-    if (entity_row < entity_count - 1)
+    if (entity_row < last_row)
     {
-        storage.entity_ids[entity_row] = storage.entity_ids[entity_count - 1];
+        storage.entity_id(entity_row) = storage.entity_id(last_row);
         for (usize i_component = 0; i_component < storage.type.size(); i_component++)
         {
-            auto &component_storage = storage.components[i_component];
-            auto stride             = component_storage.component_size;
-
-            for (usize i_byte = 0; i_byte < stride; i_byte++)
-            {
-                component_storage.data[entity_row * stride + i_byte]
-                    = component_storage.data[(entity_count - 1) * stride + i_byte];
-            }
+            std::memcpy(storage.component(entity_row, i_component), storage.component(last_row, i_component), storage.component_sizes[i_component]);
         }
     }
 
-    storage.entity_ids.pop_back();
-    for (usize i_component = 0; i_component < storage.type.size(); i_component++)
+    storage.size -= 1;
+
+    // give the last chunk back when it is empty
+    if (storage.size == (storage.chunks.size() - 1) * storage.chunk_capacity)
     {
-        auto &component_storage = storage.components[i_component];
-        for (usize i_byte = 0; i_byte < component_storage.component_size; i_byte++)
-        {
-            component_storage.data.pop_back();
-        }
+        pool.free(storage.chunks.back());
+        storage.chunks.pop_back();
     }
+}
 
-    storage.size -= 1;
+void remove_last_rows_from_storage(ChunkPool &pool, ArchetypeStorage &storage, usize count)
+{
+    storage.size -= count;
+
+    // give the empty chunks back
+    while (!storage.chunks.empty() && storage.size <= (storage.chunks.size() - 1) * storage.chunk_capacity)
+    {
+        pool.free(storage.chunks.back());
+        storage.chunks.pop_back();
+    }
 }
 
 /// --- Components impl
 
 void add_component(World &world, EntityId entity, ComponentId component_id, void *component_data, usize component_size)
 {
+    register_component_size(world.archetypes, component_id, component_size);
+
     // get the entity information in its record
     auto &record = world.entity_index.at(entity);
 
@@ -246,31 +397,27 @@ void add_component(World &world, EntityId entity, ComponentId component_id, void
     auto old_row      = record.row;
 
     // copy components to its new bucket
-    auto new_row          = add_entity_id_to_storage(new_storage, entity);
+    auto new_row          = add_entity_to_storage(world.archetypes.chunk_pool, new_storage, entity);
     usize i_old_component = 0;
     for (auto old_component_id : old_storage.type)
     {
-        auto &component_storage = old_storage.components[i_old_component++];
-        void *src               = &component_storage.data[old_row * component_storage.component_size];
-
         auto i_new_component = get_component_idx(new_storage.type, old_component_id).value();
-        add_component_to_storage(new_storage, i_new_component, src, component_storage.component_size);
+        add_component_to_storage(new_storage, new_row, i_new_component, old_storage.component(old_row, i_old_component), old_storage.component_sizes[i_old_component]);
+        i_old_component++;
     }
 
     // add the new component
     auto i_new_component = get_component_idx(new_storage.type, component_id).value();
-    add_component_to_storage(new_storage, i_new_component, component_data, component_size);
-
-    new_storage.size += 1; // /!\ DO THIS AFTER add_component
+    add_component_to_storage(new_storage, new_row, i_new_component, component_data, component_size);
 
     /// --- Remove from previous storage
     Option<EntityId> swapped_entity;
-    if (old_row != old_storage.entity_ids.size() - 1)
+    if (old_row != old_storage.size - 1)
     {
-        swapped_entity = std::make_optional(old_storage.entity_ids.back());
+        swapped_entity = std::make_optional(old_storage.entity_id(old_storage.size - 1));
     }
 
-    remove_entity_from_storage(old_storage, old_row);
+    remove_entity_from_storage(world.archetypes.chunk_pool, old_storage, old_row);
 
     /// --- Update entities' row
     record.row       = new_row;
@@ -297,28 +444,22 @@ void remove_component(World &world, EntityId entity, ComponentId component_id)
     auto old_row      = record.row;
 
     // copy components to a its new bucket
-    auto new_row          = add_entity_id_to_storage(new_storage, entity);
+    auto new_row          = add_entity_to_storage(world.archetypes.chunk_pool, new_storage, entity);
     usize i_new_component = 0;
     for (auto new_component_id : new_storage.type)
     {
-        auto i_old_component    = *get_component_idx(old_storage.type, new_component_id);
-        auto &component_storage = old_storage.components[i_old_component];
-        void *src               = &component_storage.data[old_row * component_storage.component_size];
-        usize component_size    = component_storage.component_size;
-
-        add_component_to_storage(new_storage, i_new_component++, src, component_size);
+        auto i_old_component = *get_component_idx(old_storage.type, new_component_id);
+        add_component_to_storage(new_storage, new_row, i_new_component++, old_storage.component(old_row, i_old_component), old_storage.component_sizes[i_old_component]);
     }
 
-    new_storage.size += 1; // /!\ DO THIS AFTER add_component
-
     // remove from previous storage
     Option<EntityId> swapped_entity;
-    if (old_row != old_storage.entity_ids.size() - 1)
+    if (old_row != old_storage.size - 1)
     {
-        swapped_entity = std::make_optional(old_storage.entity_ids.back());
+        swapped_entity = std::make_optional(old_storage.entity_id(old_storage.size - 1));
     }
 
-    remove_entity_from_storage(old_storage, old_row);
+    remove_entity_from_storage(world.archetypes.chunk_pool, old_storage, old_row);
 
     /// --- Update entities' row
     record.row       = new_row;
@@ -342,10 +483,8 @@ void set_component(World &world, EntityId entity, ComponentId component_id, void
         return;
     }
 
-    auto &component_storage = archetype_storage.components[*component_idx];
-
-    auto *dst = &component_storage.data[record.row * component_storage.component_size];
-    std::memcpy(dst, component_data, component_size);
+    assert(archetype_storage.component_sizes[*component_idx] == component_size);
+    std::memcpy(archetype_storage.component(record.row, *component_idx), component_data, component_size);
 }
 
 bool has_component(World &world, EntityId entity, ComponentId component)
@@ -378,11 +517,28 @@ void *get_component(World &world, EntityId entity, ComponentId component_id)
         return nullptr;
     }
 
-    auto &component_storage = archetype_storage.components[*component_idx];
+    // get the component data from the right column
+    return archetype_storage.component(record.row, *component_idx);
+}
+
+void destroy_entity(World &world, EntityId entity)
+{
+    const auto record = world.entity_index.at(entity);
+    auto &storage     = *world.archetypes.archetype_storages.get(record.archetype);
+
+    Option<EntityId> swapped_entity;
+    if (record.row != storage.size - 1)
+    {
+        swapped_entity = std::make_optional(storage.entity_id(storage.size - 1));
+    }
+
+    remove_entity_from_storage(world.archetypes.chunk_pool, storage, record.row);
 
-    // get the component data from the right array
-    usize component_byte_idx = record.row * component_storage.component_size;
-    return &component_storage.data[component_byte_idx];
+    if (swapped_entity)
+    {
+        world.entity_index.at(*swapped_entity).row = record.row;
+    }
+    world.entity_index.erase(entity);
 }
 
 } // namespace impl
@@ -392,6 +548,8 @@ void *get_component(World &world, EntityId entity, ComponentId component_id)
 World::World()
 {
     archetypes.root = archetypes.archetype_storages.add({});
+    archetypes.creation_order.push_back(archetypes.root);
+    impl::init_chunk_layout(*archetypes.archetype_storages.get(archetypes.root), archetypes.component_sizes);
 
     // bootstrap the InternalComponent component
     auto internal_component = create_entity_internal(EntityId::component<InternalComponent>(), InternalComponent{sizeof(InternalComponent)});
@@ -403,9 +561,48 @@ World::World()
     singleton = create_entity("World");
 }
 
+void World::create_component_if_needed_internal(ComponentId component_id, usize component_size, const char *type_name)
+{
+    if (!entity_index.contains(component_id))
+    {
+        create_entity_internal(component_id, InternalComponent{component_size}, InternalId{type_name});
+    }
+}
+
+void World::destroy_entity(EntityId entity)
+{
+    impl::destroy_entity(*this, entity);
+}
+
+SystemId World::add_system(std::string name, Archetype components, Archetype writes, std::function<void(World &)> function)
+{
+    const auto system_id = static_cast<SystemId>(systems.size());
+    auto task_id         = systems_graph.add_task(name, [this, system_id]() { systems[system_id].function(*this); });
+    assert(task_id == system_id);
+
+    for (SystemId i_system = 0; i_system < system_id; i_system++)
+    {
+        const auto &other = systems[i_system];
+        if (impl::accesses_conflict(other.components, other.writes, components, writes))
+        {
+            systems_graph.add_dependency(i_system, task_id);
+        }
+    }
+
+    systems.push_back({.name = std::move(name), .components = std::move(components), .writes = std::move(writes), .function = std::move(function)});
+    return system_id;
+}
+
+void World::run_systems()
+{
+    PROFILE_SCOPE("World::run_systems");
+    systems_graph.execute();
+}
+
 void World::display_ui(UI::Context &ctx)
 {
-    if (ctx.begin_window("ECS"))
+    static const StringId ecs_window = "ECS";
+    if (ctx.begin_window(ecs_window))
     {
         if (ImGui::CollapsingHeader("Archetypes"))
         {
@@ -426,7 +623,7 @@ void World::display_ui(UI::Context &ctx)
                     if (internal_id)
                     {
                         ImGui::SameLine();
-                        ImGui::Text("%s", internal_id->tag);
+                        ImGui::Text("%s", internal_id->tag.c_str());
                     }
                     else
                     {
@@ -442,14 +639,15 @@ void World::display_ui(UI::Context &ctx)
                 }
                 ImGui::TextUnformatted("]");
                 ImGui::TextUnformatted("Entities:");
-                for (auto entity : storage->entity_ids)
+                for (usize i_row = 0; i_row < storage->size; i_row++)
                 {
+                    auto entity = storage->entity_id(i_row);
                     ImGui::Text("#%zu", entity.raw);
 
                     if (const auto *internal_id = get_component<InternalId>(entity))
                     {
                         ImGui::SameLine();
-                        ImGui::Text("%s", internal_id->tag);
+                        ImGui::Text("%s", internal_id->tag.c_str());
                     }
 
                     if (const auto *internal_component = get_component<InternalComponent>(entity))
@@ -458,22 +656,62 @@ void World::display_ui(UI::Context &ctx)
                     }
                 }
 
-                usize total_archetype_size = 0;
-                for (const auto &component_storage : storage->components)
-                {
-                    total_archetype_size += component_storage.component_size;
-                }
-                total_archetype_size *= storage->size;
+                usize total_archetype_size = storage->chunks.size() * CHUNK_SIZE;
+                ImGui::Text("Chunks: %zu (%u entities per chunk)", storage->chunks.size(), storage->chunk_capacity);
 
                 component_memory += total_archetype_size;
                 entity_count += storage->size;
             }
 
             ImGui::Separator();
-            ImGui::Text("Total component size: %zu", component_memory);
+            ImGui::Text("Total chunk size: %zu", component_memory);
             ImGui::Text("Entity count: %zu", entity_count);
         }
 
+        if (ImGui::CollapsingHeader("Systems"))
+        {
+            const auto component_names = [&](const Archetype &components) {
+                std::string names;
+                for (auto component_id : components)
+                {
+                    const auto *internal_id = get_component<InternalId>(component_id);
+                    names += names.empty() ? "" : ", ";
+                    names += internal_id ? internal_id->tag.c_str() : fmt::format("#{}", component_id.raw);
+                }
+                return names;
+            };
+
+            if (ImGui::BeginTable("Systems", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("System");
+                ImGui::TableSetupColumn("Writes");
+                ImGui::TableSetupColumn("Duration (ms)");
+                ImGui::TableSetupColumn("Thread");
+                ImGui::TableHeadersRow();
+
+                // Timings of the last run_systems()
+                for (SystemId i_system = 0; i_system < systems.size(); i_system++)
+                {
+                    const auto &system = systems[i_system];
+                    const auto &timing = systems_graph.tasks[i_system].timing;
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::TextUnformatted(system.name.c_str());
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("Reads and writes: %s", component_names(system.components).c_str());
+                    }
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::TextUnformatted(component_names(system.writes).c_str());
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.3f", timing.duration_ms);
+                    ImGui::TableSetColumnIndex(3);
+                    ImGui::Text("%d", timing.thread_index == u32_invalid ? -1 : int(timing.thread_index));
+                }
+                ImGui::EndTable();
+            }
+        }
+
         if (ImGui::CollapsingHeader("Entities"))
         {
             for (const auto &[entity_id, entity_record] : entity_index)
@@ -485,7 +723,7 @@ void World::display_ui(UI::Context &ctx)
                 if (const auto *internal_id = get_component<InternalId>(entity_id))
                 {
                     ImGui::SameLine();
-                    ImGui::Text("%s", internal_id->tag);
+                    ImGui::Text("%s", internal_id->tag.c_str());
                 }
             }
         }
@@ -494,6 +732,580 @@ void World::display_ui(UI::Context &ctx)
     }
 }
 
+/// --- EntityCommandBuffer
+
+EntityCommandBuffer::EntityCommandBuffer()
+{
+    per_thread.resize(jobs::thread_count() + 1);
+}
+
+void EntityCommandBuffer::record(Command command, const void *data)
+{
+    // the job system can be initialized after the buffer, its new threads use the shared buffer
+    const u32 i_thread       = jobs::thread_index();
+    const bool is_job_thread = i_thread < per_thread.size() - 1;
+
+    std::unique_lock lock{external_mutex, std::defer_lock};
+    if (!is_job_thread)
+    {
+        lock.lock();
+    }
+
+    auto &thread_commands = per_thread[is_job_thread ? i_thread : per_thread.size() - 1];
+    if (command.data_size != 0)
+    {
+        command.data_offset = static_cast<u32>(thread_commands.data.size());
+        const auto *bytes   = reinterpret_cast<const u8 *>(data);
+        thread_commands.data.insert(thread_commands.data.end(), bytes, bytes + command.data_size);
+    }
+    thread_commands.commands.push_back(command);
+}
+
+bool EntityCommandBuffer::is_empty() const
+{
+    return std::ranges::all_of(per_thread, [](const ThreadCommands &thread_commands) { return thread_commands.commands.empty(); });
+}
+
+namespace
+{
+using Command     = EntityCommandBuffer::Command;
+using CommandType = EntityCommandBuffer::CommandType;
+
+struct ComponentWrite
+{
+    ComponentId component = {};
+    const u8 *data        = nullptr;
+    u32 size              = 0;
+};
+
+// The components of an entity created by the buffer or that gets several commands
+struct ChangeDetails
+{
+    // components after the playback
+    Archetype type = {};
+    SmallVec<ComponentWrite, 4> writes = {};
+};
+
+// The result of all the commands of an entity
+struct EntityChange
+{
+    EntityId entity = {};
+    bool created    = false;
+    bool destroyed  = false;
+    // index of the details, invalid for an entity that existed before the playback and gets a single command
+    u32 i_details = u32_invalid;
+    // index of the entity in the entity index, entries only move when an entity is erased
+    u32 i_entry = u32_invalid;
+    // archetype before the playback, invalid for created entities
+    ArchetypeH source      = {};
+    ArchetypeH destination = {};
+    // the only command of the entity and its data, its type is not computed
+    const Command *single_command = nullptr;
+    const u8 *single_data         = nullptr;
+};
+
+void apply_to_type(Archetype &type, const Command &command)
+{
+    const bool has_component = std::ranges::find(type, command.component) != type.end();
+    if ((command.type == CommandType::Add || command.type == CommandType::Set) && !has_component)
+    {
+        type.push_back(command.component);
+    }
+    else if (command.type == CommandType::Remove && has_component)
+    {
+        auto new_end = std::remove(type.begin(), type.end(), command.component);
+        type.resize(static_cast<usize>(new_end - type.begin()));
+    }
+}
+
+void apply_to_writes(SmallVec<ComponentWrite, 4> &writes, const Command &command, const u8 *data)
+{
+    if (command.type == CommandType::Destroy)
+    {
+        writes.clear();
+        return;
+    }
+
+    auto new_end = std::remove_if(writes.begin(), writes.end(), [&](const ComponentWrite &write) { return write.component == command.component; });
+    writes.resize(static_cast<usize>(new_end - writes.begin()));
+    if (command.type == CommandType::Add || command.type == CommandType::Set)
+    {
+        writes.push_back({.component = command.component, .data = data, .size = command.data_size});
+    }
+}
+
+// Destination of an entity with a single command, the edges of the source archetype cache it
+ArchetypeH single_command_destination(Archetypes &archetypes, ArchetypeH source, const Command &command)
+{
+    const auto &source_type  = archetypes.archetype_storages.get(source)->type;
+    const bool has_component = std::ranges::find(source_type, command.component) != source_type.end();
+    if ((command.type == CommandType::Add || command.type == CommandType::Set) && !has_component)
+    {
+        return impl::find_or_create_archetype_storage_adding_component(archetypes, source, command.component);
+    }
+    if (command.type == CommandType::Remove && has_component)
+    {
+        return impl::find_or_create_archetype_storage_removing_component(archetypes, source, command.component);
+    }
+    return source;
+}
+
+// Entities with the same commands applied to the same source move to the same destination
+bool same_group(const EntityChange &a, const EntityChange &b, std::span<const ChangeDetails> details)
+{
+    if (a.created != b.created || a.source != b.source || a.destroyed != b.destroyed)
+    {
+        return false;
+    }
+    if (a.single_command || b.single_command)
+    {
+        return a.single_command && b.single_command && a.single_command->type == b.single_command->type
+               && a.single_command->component == b.single_command->component;
+    }
+    return std::ranges::equal(details[a.i_details].type, details[b.i_details].type);
+}
+
+// Record of an entity that existed before the playback, before any entity is erased
+EntityRecord &record_of(World &world, const EntityChange &change) { return (world.entity_index.begin() + change.i_entry)->second; }
+
+// Writes the components of the changes of a group. The changes of a group usually write the same components in the
+// same order: the columns of the writes of the first change are computed once and reused.
+struct GroupWriter
+{
+    GroupWriter(const ArchetypeStorage &storage, const EntityChange &first, std::span<const ChangeDetails> details)
+        : details{details}
+    {
+        if (first.single_command)
+        {
+            first_components.push_back(first.single_command->component);
+        }
+        else
+        {
+            for (const auto &write : details[first.i_details].writes)
+            {
+                first_components.push_back(write.component);
+            }
+        }
+
+        for (auto component_id : first_components)
+        {
+            // a single Remove command has no write, the column is not used
+            auto i_component = impl::get_component_idx(storage.type, component_id);
+            first_columns.push_back(i_component ? static_cast<u32>(*i_component) : u32_invalid);
+        }
+    }
+
+    void write(ArchetypeStorage &storage, usize i_chunk, usize chunk_row, usize i_write, const ComponentWrite &write) const
+    {
+        usize i_component = i_write < first_components.size() && first_components[i_write] == write.component
+                                ? first_columns[i_write]
+                                : impl::get_component_idx(storage.type, write.component).value();
+        assert(storage.component_sizes[i_component] == write.size);
+        std::memcpy(storage.chunk_column(i_chunk, i_component) + chunk_row * write.size, write.data, write.size);
+    }
+
+    // writes the components of the entity at `chunk_row` in the chunk `i_chunk` of the storage
+    void write(ArchetypeStorage &storage, usize i_chunk, usize chunk_row, const EntityChange &change) const
+    {
+        if (change.single_command)
+        {
+            const auto &command = *change.single_command;
+            if (command.type == CommandType::Add || command.type == CommandType::Set)
+            {
+                write(storage, i_chunk, chunk_row, 0, {.component = command.component, .data = change.single_data, .size = command.data_size});
+            }
+            return;
+        }
+
+        const auto &writes = details[change.i_details].writes;
+        for (usize i_write = 0; i_write < writes.size(); i_write++)
+        {
+            write(storage, i_chunk, chunk_row, i_write, writes[i_write]);
+        }
+    }
+
+    void write(ArchetypeStorage &storage, usize row, const EntityChange &change) const
+    {
+        write(storage, row / storage.chunk_capacity, row % storage.chunk_capacity, change);
+    }
+
+    std::span<const ChangeDetails> details;
+    SmallVec<ComponentId, 4> first_components;
+    SmallVec<u32, 4> first_columns;
+};
+
+// Move a group of entities between two archetypes, they are appended to the destination and the components are copied
+// per column for each run of rows that are contiguous in the source
+void move_group(World &world, ArchetypeStorage &source, ArchetypeStorage *destination, std::span<const EntityChange *> group, std::span<const ChangeDetails> details)
+{
+    struct Move
+    {
+        const EntityChange *change = nullptr;
+        // the entity index is not modified until the rows are removed
+        EntityRecord *record = nullptr;
+        usize source_row     = 0;
+    };
+
+    Vec<Move> moves;
+    moves.reserve(group.size());
+    for (const auto *change : group)
+    {
+        // the destroyed entities are moved last, after some of them may have been erased
+        auto &record = destination ? record_of(world, *change) : world.entity_index.at(change->entity);
+        moves.push_back({.change = change, .record = &record, .source_row = record.row});
+    }
+    // the commands are usually recorded in the order of the rows
+    const auto by_source_row = [](const Move &a, const Move &b) { return a.source_row < b.source_row; };
+    if (!std::is_sorted(moves.begin(), moves.end(), by_source_row))
+    {
+        std::sort(moves.begin(), moves.end(), by_source_row);
+    }
+
+    if (destination)
+    {
+        // the entities are appended to the destination in the order of their source rows
+        const usize first_destination_row = impl::add_rows_to_storage(world.archetypes.chunk_pool, *destination, moves.size());
+
+        SmallVec<u32, 8> source_columns;
+        for (auto component_id : destination->type)
+        {
+            auto i_source_component = impl::get_component_idx(source.type, component_id);
+            source_columns.push_back(i_source_component ? static_cast<u32>(*i_source_component) : u32_invalid);
+        }
+
+        const GroupWriter writer{*destination, *group[0], details};
+        for (usize i_move = 0; i_move < moves.size();)
+        {
+            const auto &first                 = moves[i_move];
+            const usize destination_row       = first_destination_row + i_move;
+            const usize i_source_chunk        = first.source_row / source.chunk_capacity;
+            const usize source_chunk_row      = first.source_row % source.chunk_capacity;
+            const usize i_destination_chunk   = destination_row / destination->chunk_capacity;
+            const usize destination_chunk_row = destination_row % destination->chunk_capacity;
+
+            // the destination rows are contiguous, a run ends when the source rows are not or at the end of a chunk
+            const usize max_run_length = std::min({moves.size() - i_move,
+                                                   source.chunk_capacity - source_chunk_row,
+                                                   destination->chunk_capacity - destination_chunk_row});
+            usize run_length           = 1;
+            while (run_length < max_run_length && moves[i_move + run_length].source_row == first.source_row + run_length)
+            {
+                run_length += 1;
+            }
+
+            std::memcpy(destination->chunk_entity_ids(i_destination_chunk) + destination_chunk_row,
+                        source.chunk_entity_ids(i_source_chunk) + source_chunk_row,
+                        run_length * sizeof(EntityId));
+            for (usize i_component = 0; i_component < destination->type.size(); i_component++)
+            {
+                const u32 i_source_component = source_columns[i_component];
+                const usize component_size   = destination->component_sizes[i_component];
+                if (i_source_component != u32_invalid)
+                {
+                    std::memcpy(destination->chunk_column(i_destination_chunk, i_component) + destination_chunk_row * component_size,
+                                source.chunk_column(i_source_chunk, i_source_component) + source_chunk_row * component_size,
+                                run_length * component_size);
+                }
+            }
+
+            for (usize i_run = 0; i_run < run_length; i_run++)
+            {
+                const auto &move = moves[i_move + i_run];
+                writer.write(*destination, i_destination_chunk, destination_chunk_row + i_run, *move.change);
+                move.record->archetype = move.change->destination;
+                move.record->row       = destination_row + i_run;
+            }
+            i_move += run_length;
+        }
+    }
+
+    // The rows at the end of the storage are dropped at once
+    usize i_move = moves.size();
+    while (i_move > 0 && moves[i_move - 1].source_row == source.size - (moves.size() - i_move) - 1)
+    {
+        i_move--;
+    }
+    impl::remove_last_rows_from_storage(world.archetypes.chunk_pool, source, moves.size() - i_move);
+
+    // The others are removed from the last one, the last row of the storage is never one that is still to remove
+    for (; i_move > 0; i_move--)
+    {
+        const auto &move = moves[i_move - 1];
+        Option<EntityId> swapped_entity;
+        if (move.source_row != source.size - 1)
+        {
+            swapped_entity = std::make_optional(source.entity_id(source.size - 1));
+        }
+
+        impl::remove_entity_from_storage(world.archetypes.chunk_pool, source, move.source_row);
+
+        if (swapped_entity)
+        {
+            world.entity_index.at(*swapped_entity).row = move.source_row;
+        }
+    }
+
+    if (!destination)
+    {
+        for (const auto &move : moves)
+        {
+            world.entity_index.erase(move.change->entity);
+        }
+    }
+}
+} // namespace
+
+void EntityCommandBuffer::playback(World &world)
+{
+    PROFILE_SCOPE("EntityCommandBuffer::playback");
+
+    // -- Reduce the commands of every entity to a single change
+    usize command_count = 0;
+    for (const auto &thread_commands : per_thread)
+    {
+        command_count += thread_commands.commands.size();
+    }
+
+    // The entity index gives the entry of each entity, the change of an entry is found in entry_changes without
+    // hashing the id again
+    Vec<EntityChange> changes;
+    Vec<ChangeDetails> details;
+    Map<EntityId, u32> created_changes;
+    changes.reserve(command_count);
+    // components already registered by this playback
+    SmallVec<ComponentId, 8> known_components;
+    for (const auto &thread_commands : per_thread)
+    {
+        for (const auto &command : thread_commands.commands)
+        {
+            const u8 *data = thread_commands.data.data() + command.data_offset;
+
+            if ((command.type == CommandType::Add || command.type == CommandType::Set)
+                && std::ranges::find(known_components, command.component) == known_components.end())
+            {
+                world.create_component_if_needed_internal(command.component, command.data_size, command.type_name);
+                impl::register_component_size(world.archetypes, command.component, command.data_size);
+                known_components.push_back(command.component);
+            }
+
+            if (command.type == CommandType::Create)
+            {
+                created_changes[command.entity] = static_cast<u32>(changes.size());
+                auto &change                    = changes.emplace_back();
+                change.entity                   = command.entity;
+                change.created                  = true;
+                change.i_details                = static_cast<u32>(details.size());
+                details.emplace_back();
+                continue;
+            }
+
+            u32 i_change = u32_invalid;
+            auto record  = world.entity_index.find(command.entity);
+            if (record == world.entity_index.end())
+            {
+                // created entities are not in the entity index yet
+                auto created = created_changes.find(command.entity);
+                if (created == created_changes.end())
+                {
+                    logger::error("ECS: The world does not contain the entity {}\n", to_string(command.entity));
+                    continue;
+                }
+                i_change = created->second;
+            }
+            else
+            {
+                const u32 i_entry = static_cast<u32>(record - world.entity_index.begin());
+                if (i_entry >= entry_changes.size())
+                {
+                    entry_changes.resize(world.entity_index.size(), u32_invalid);
+                }
+
+                i_change = entry_changes[i_entry];
+                if (i_change == u32_invalid)
+                {
+                    // the details are only computed if the entity gets a second command
+                    entry_changes[i_entry] = static_cast<u32>(changes.size());
+                    auto &change           = changes.emplace_back();
+                    change.entity          = command.entity;
+                    change.destroyed       = command.type == CommandType::Destroy;
+                    change.i_entry         = i_entry;
+                    change.source          = record->second.archetype;
+                    change.single_command  = &command;
+                    change.single_data     = data;
+                    continue;
+                }
+            }
+
+            auto &change = changes[i_change];
+            if (change.destroyed)
+            {
+                continue;
+            }
+
+            if (change.single_command)
+            {
+                change.i_details    = static_cast<u32>(details.size());
+                auto &first_details = details.emplace_back();
+                first_details.type  = world.archetypes.archetype_storages.get(change.source)->type;
+                apply_to_type(first_details.type, *change.single_command);
+                apply_to_writes(first_details.writes, *change.single_command, change.single_data);
+                change.single_command = nullptr;
+                change.single_data    = nullptr;
+            }
+
+            auto &change_details = details[change.i_details];
+            change.destroyed     = command.type == CommandType::Destroy;
+            apply_to_type(change_details.type, command);
+            apply_to_writes(change_details.writes, command, data);
+        }
+    }
+
+    // -- Find the destination of every entity, before moving anything because creating archetypes invalidates the storage
+    // pointers. Nearby entities usually get the same commands, the destinations of the last groups are reused for them.
+    // An entity with a single command follows an edge of its archetype instead of a traversal.
+    // The groups of entities moving from the same source to the same destination are numbered in order of appearance.
+    Vec<u32> change_groups(changes.size(), u32_invalid);
+    // the size of each group is counted at the next index, the prefix sum then gives the start of each group
+    Vec<u32> group_starts(1, 0);
+    struct RecentGroup
+    {
+        const EntityChange *first = nullptr;
+        u32 i_group               = u32_invalid;
+    };
+    std::array<RecentGroup, 8> recent_groups = {};
+    u32 i_next_recent                        = 0;
+    Map<u64, u32> group_indices;
+    for (u32 i_change = 0; i_change < changes.size(); i_change++)
+    {
+        auto &change = changes[i_change];
+        // entry_changes is clean for the next playback
+        if (change.i_entry != u32_invalid)
+        {
+            entry_changes[change.i_entry] = u32_invalid;
+        }
+
+        // an entity created and destroyed by the same buffer never exists
+        if (change.created && change.destroyed)
+        {
+            continue;
+        }
+
+        u32 i_group = u32_invalid;
+        auto recent = std::ranges::find_if(recent_groups, [&](const RecentGroup &group) { return group.first && same_group(change, *group.first, details); });
+        if (recent != recent_groups.end())
+        {
+            change.destination = recent->first->destination;
+            i_group            = recent->i_group;
+        }
+        else
+        {
+            if (change.single_command && !change.destroyed)
+            {
+                change.destination = single_command_destination(world.archetypes, change.source, *change.single_command);
+            }
+            else if (!change.destroyed)
+            {
+                const auto &type   = details[change.i_details].type;
+                ArchetypeH current = change.created ? world.archetypes.root : change.source;
+                Archetype from     = world.archetypes.archetype_storages.get(current)->type;
+                for (auto component_id : from)
+                {
+                    if (std::ranges::find(type, component_id) == type.end())
+                    {
+                        current = impl::find_or_create_archetype_storage_removing_component(world.archetypes, current, component_id);
+                    }
+                }
+                for (auto component_id : type)
+                {
+                    if (std::ranges::find(from, component_id) == from.end())
+                    {
+                        current = impl::find_or_create_archetype_storage_adding_component(world.archetypes, current, component_id);
+                    }
+                }
+                change.destination = current;
+            }
+
+            // created entities have no source and destroyed entities no destination
+            const u64 source      = change.created ? u32_invalid : change.source.value();
+            const u64 destination = change.destroyed ? u32_invalid : change.destination.value();
+            i_group = group_indices.try_emplace(source << 32 | destination, static_cast<u32>(group_indices.size())).first->second;
+            if (i_group + 1 == group_starts.size())
+            {
+                group_starts.push_back(0);
+            }
+
+            recent_groups[i_next_recent] = {.first = &change, .i_group = i_group};
+            i_next_recent                = (i_next_recent + 1) % recent_groups.size();
+        }
+
+        change_groups[i_change] = i_group;
+        group_starts[i_group + 1] += 1;
+    }
+
+    // -- Sort the changes by group with a counting sort, it is stable to keep the recording order in a group
+    const usize group_count = group_indices.size();
+    for (usize i_group = 0; i_group < group_count; i_group++)
+    {
+        group_starts[i_group + 1] += group_starts[i_group];
+    }
+    Vec<const EntityChange *> sorted_changes(group_starts.back());
+    {
+        Vec<u32> group_ends(group_starts.begin(), group_starts.end() - 1);
+        for (usize i_change = 0; i_change < changes.size(); i_change++)
+        {
+            if (change_groups[i_change] != u32_invalid)
+            {
+                sorted_changes[group_ends[change_groups[i_change]]++] = &changes[i_change];
+            }
+        }
+    }
+
+    // -- Apply the groups, the destroyed entities last: erasing them from the entity index moves its entries
+    for (bool destroyed_groups : {false, true})
+    {
+        for (usize i_group = 0; i_group < group_count; i_group++)
+        {
+            std::span<const EntityChange *> group{sorted_changes.data() + group_starts[i_group], sorted_changes.data() + group_starts[i_group + 1]};
+            const auto &first = *group[0];
+            if (first.destroyed != destroyed_groups)
+            {
+                continue;
+            }
+
+            auto *destination = first.destroyed ? nullptr : world.archetypes.archetype_storages.get(first.destination);
+            if (first.created)
+            {
+                const GroupWriter writer{*destination, first, details};
+                for (const auto *change : group)
+                {
+                    auto row = impl::add_entity_to_storage(world.archetypes.chunk_pool, *destination, change->entity);
+                    writer.write(*destination, row, *change);
+                    world.entity_index[change->entity] = EntityRecord{.archetype = first.destination, .row = row};
+                }
+            }
+            else if (first.source == first.destination)
+            {
+                const GroupWriter writer{*destination, first, details};
+                for (const auto *change : group)
+                {
+                    writer.write(*destination, record_of(world, *change).row, *change);
+                }
+            }
+            else
+            {
+                auto &source = *world.archetypes.archetype_storages.get(first.source);
+                move_group(world, source, destination, group, details);
+            }
+        }
+    }
+
+    for (auto &thread_commands : per_thread)
+    {
+        thread_commands.commands.clear();
+        thread_commands.data.clear();
+    }
+}
+
 #if defined (ENABLE_DOCTEST)
 namespace test
 {
@@ -638,6 +1450,306 @@ TEST_SUITE("ECS")
         }
 
     }
+
+    TEST_CASE("Cached queries")
+    {
+        World world{};
+        world.create_entity(Transform{1}, Position{1});
+        world.create_entity(Transform{2});
+
+        Query<Transform, Position> query;
+        uint count = 0;
+        query.for_each(world, [&](const auto &transform, const auto &position) {
+            CHECK(transform.a == position.a);
+            count += 1;
+        });
+        CHECK(count == 1);
+        CHECK(query.cache.archetypes.size() == 1);
+
+        // New archetypes are tested on the next iteration
+        world.create_entity(Transform{3}, Position{3}, Rotation{3});
+        world.create_entity(Rotation{4}, Position{4}, Transform{4});
+        world.create_entity(Rotation{5});
+
+        uint sum = 0;
+        query.for_each_chunk(world, [&](usize row_count, Transform *transforms, Position *positions) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
+            {
+                sum += transforms[i_row].a + positions[i_row].a;
+            }
+        });
+        CHECK(sum == 2 * (1 + 3 + 4));
+        CHECK(query.cache.archetypes.size() == 3);
+
+        // The world caches the queries of for_each
+        count = 0;
+        world.for_each<Position, Transform>([&](const auto &position, const auto &transform) {
+            CHECK(transform.a == position.a);
+            count += 1;
+        });
+        CHECK(count == 3);
+
+        world.create_entity(Position{6}, Transform{6});
+        count = 0;
+        world.for_each<Position, Transform>([&](const auto &, const auto &) { count += 1; });
+        CHECK(count == 4);
+    }
+
+    TEST_CASE("Query access")
+    {
+        Query<const Transform, const Position> read_tp;
+        Query<const Transform> read_t;
+        Query<Transform, const Rotation> write_t;
+        Query<const Position, Rotation> write_r;
+
+        CHECK(read_tp.is_read_only);
+        CHECK(!write_t.is_read_only);
+        CHECK(!read_tp.conflicts_with(read_t));
+        CHECK(read_tp.conflicts_with(write_t));
+        CHECK(!read_tp.conflicts_with(write_r));
+        CHECK(write_t.conflicts_with(write_r));
+    }
+
+    TEST_CASE("Parallel queries")
+    {
+        jobs::init(3);
+
+        World world{};
+        constexpr uint count = 20000;
+        for (uint i = 0; i < count; i++)
+        {
+            if (i % 4 == 0)
+            {
+                world.create_entity(Transform{i}, Position{i}, Rotation{i});
+            }
+            else
+            {
+                world.create_entity(Transform{i}, Position{i});
+            }
+        }
+        CHECK(world.count<const Transform, const Position>() == count);
+
+        // The serial order of the entities
+        Vec<uint> expected;
+        world.for_each<const Position>([&](const Position &position) { expected.push_back(position.a * 3 + 1); });
+
+        for (usize grain : {usize(0), usize(1), usize(5)})
+        {
+            world.par_for_each<Transform, const Position>(grain, [](Transform &transform, const Position &position) {
+                transform.a = position.a * 3 + 1;
+            });
+
+            // Every chunk writes its outputs at the same place as the serial iteration
+            Vec<uint> results(count, 0);
+            world.par_for_each_chunk<const Transform>(grain, [&](usize first_index, usize row_count, const Transform *transforms) {
+                for (usize i_row = 0; i_row < row_count; i_row++)
+                {
+                    results[first_index + i_row] = transforms[i_row].a;
+                }
+            });
+            CHECK(results == expected);
+        }
+
+        jobs::shutdown();
+    }
+
+    TEST_CASE("Systems")
+    {
+        World world{};
+        for (uint i = 0; i < 100; i++)
+        {
+            world.create_entity(Transform{i}, Position{0}, Rotation{0});
+        }
+
+        // position depends on transform, rotation only reads transform and can run in parallel
+        auto set_transform = world.add_system<Transform>("set transform", [](Transform &transform) { transform.a += 1; });
+        auto set_position  = world.add_system<const Transform, Position>("set position", [](const Transform &transform, Position &position) {
+            position.a = transform.a * 2;
+        });
+        auto set_rotation = world.add_system<const Transform, Rotation>("set rotation", [](const Transform &transform, Rotation &rotation) {
+            rotation.a = transform.a * 3;
+        });
+        auto read_all = world.add_system<const Position, const Rotation>("read", [](const Position &, const Rotation &) {});
+
+        CHECK(world.systems_graph.tasks[set_transform].successors.size() == 2);
+        CHECK(world.systems_graph.tasks[set_position].dependency_count == 1);
+        CHECK(world.systems_graph.tasks[set_rotation].dependency_count == 1);
+        CHECK(world.systems_graph.tasks[read_all].dependency_count == 2);
+
+        for (u32 worker_count : {0u, 3u})
+        {
+            if (worker_count)
+            {
+                jobs::init(worker_count);
+            }
+
+            world.for_each<Transform>([](Transform &transform) { transform.a = 0; });
+            for (uint i_frame = 0; i_frame < 10; i_frame++)
+            {
+                world.run_systems();
+            }
+
+            uint errors = 0;
+            world.for_each<const Transform, const Position, const Rotation>([&](const Transform &transform, const Position &position, const Rotation &rotation) {
+                errors += transform.a != 10 || position.a != 20 || rotation.a != 30;
+            });
+            CHECK(errors == 0);
+
+            jobs::shutdown();
+        }
+    }
+
+    TEST_CASE("Entity command buffer")
+    {
+        World world{};
+        EntityCommandBuffer commands;
+
+        constexpr uint count = 3000;
+        Vec<EntityId> entities;
+        for (uint i = 0; i < count; i++)
+        {
+            entities.push_back(world.create_entity(Transform{i}, Position{i}));
+        }
+
+        // Structural changes are recorded while iterating and applied later
+        world.for_each<const Transform>([&](const Transform &transform) {
+            if (transform.a % 2 == 0)
+            {
+                commands.add_component(entities[transform.a], Rotation{transform.a});
+            }
+            if (transform.a % 3 == 0)
+            {
+                commands.remove_component<Position>(entities[transform.a]);
+            }
+            if (transform.a % 5 == 0)
+            {
+                commands.set_component(entities[transform.a], Transform{transform.a + count});
+            }
+            if (transform.a % 7 == 0)
+            {
+                commands.destroy_entity(entities[transform.a]);
+            }
+        });
+        auto created   = commands.create_entity(Transform{42}, Rotation{43});
+        auto discarded = commands.create_entity(Transform{44});
+        commands.destroy_entity(discarded);
+
+        CHECK(!commands.is_empty());
+        CHECK(!world.entity_index.contains(created));
+        commands.playback(world);
+        CHECK(commands.is_empty());
+
+        uint errors = 0;
+        for (uint i = 0; i < count; i++)
+        {
+            if (i % 7 == 0)
+            {
+                errors += world.entity_index.contains(entities[i]);
+                continue;
+            }
+
+            const auto *transform = world.get_component<Transform>(entities[i]);
+            const auto *position  = world.get_component<Position>(entities[i]);
+            const auto *rotation  = world.get_component<Rotation>(entities[i]);
+            errors += transform == nullptr || transform->a != (i % 5 == 0 ? i + count : i);
+            errors += (i % 3 == 0) ? position != nullptr : (position == nullptr || position->a != i);
+            errors += (i % 2 == 0) ? (rotation == nullptr || rotation->a != i) : rotation != nullptr;
+        }
+        CHECK(errors == 0);
+
+        CHECK(world.get_component<Transform>(created) != nullptr);
+        CHECK(*world.get_component<Rotation>(created) == Rotation{43});
+        CHECK(!world.entity_index.contains(discarded));
+
+        // The moved rows are consistent with the entity index
+        for (const auto &[entity, record] : world.entity_index)
+        {
+            errors += !(world.archetypes.archetype_storages.get(record.archetype)->entity_id(record.row) == entity);
+        }
+        CHECK(errors == 0);
+
+        // Emptying archetypes drops their rows at once
+        world.for_each<const Rotation>([&](const Rotation &rotation) {
+            commands.remove_component<Rotation>(rotation.a == 43 ? created : entities[rotation.a]);
+        });
+        commands.playback(world);
+        CHECK(world.count<const Rotation>() == 0);
+        for (uint i = 0; i < count; i++)
+        {
+            // the destroyed entities were checked above
+            if (i % 7 == 0)
+            {
+                continue;
+            }
+            const auto *transform = world.get_component<Transform>(entities[i]);
+            errors += transform == nullptr || transform->a != (i % 5 == 0 ? i + count : i);
+        }
+        for (const auto &[entity, record] : world.entity_index)
+        {
+            errors += !(world.archetypes.archetype_storages.get(record.archetype)->entity_id(record.row) == entity);
+        }
+        CHECK(errors == 0);
+    }
+
+    TEST_CASE("Entity command buffer from parallel queries")
+    {
+        jobs::init(3);
+
+        World world{};
+        EntityCommandBuffer commands;
+        constexpr uint count = 10000;
+        for (uint i = 0; i < count; i++)
+        {
+            world.create_entity(Transform{i}, Position{i});
+        }
+
+        // Every job thread records in its own buffer
+        world.par_for_each<const Transform>(1, [&](const Transform &transform) { commands.create_entity(Rotation{transform.a}); });
+        commands.playback(world);
+
+        uint sum = 0;
+        world.for_each<const Rotation>([&](const Rotation &rotation) { sum += rotation.a; });
+        CHECK(world.count<const Rotation>() == count);
+        CHECK(sum == count * (count - 1) / 2);
+
+        jobs::shutdown();
+    }
+
+    TEST_CASE("Chunks")
+    {
+        World world{};
+
+        // Enough entities to fill several chunks
+        constexpr uint count = 5000;
+        Vec<EntityId> entities;
+        for (uint i = 0; i < count; i++)
+        {
+            entities.push_back(world.create_entity(Transform{i}, Position{i}));
+        }
+
+        // Removing a component moves the entity out of the archetype, the last row fills the hole
+        for (uint i = 0; i < count; i += 3)
+        {
+            world.remove_component<Position>(entities[i]);
+        }
+
+        uint position_count = 0;
+        uint errors         = 0;
+        world.for_each<Transform, Position>([&](const auto &transform, const auto &position) {
+            position_count += 1;
+            errors += transform.a != position.a || transform.a % 3 == 0;
+        });
+        CHECK(position_count == count - (count + 2) / 3);
+        CHECK(errors == 0);
+
+        for (uint i = 0; i < count; i++)
+        {
+            auto *transform = world.get_component<Transform>(entities[i]);
+            errors += transform == nullptr || transform->a != i;
+            errors += world.has_component<Position>(entities[i]) == (i % 3 == 0);
+        }
+        CHECK(errors == 0);
+    }
 }
 } // namespace test
 #endif
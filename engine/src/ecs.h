@@ -1,12 +1,27 @@
 #pragma once
-#include <exo/collections/pool.h>
+#include <exo/collections/packed_pool.h>
+#include <exo/collections/small_vector.h>
 #include <exo/types.h>
 #include <exo/collections/vector.h>
 #include <exo/option.h>
+#include <exo/map.h>
+#include <exo/hash.h>
+#include <exo/string_interner.h>
+#include <exo/profiler.h>
+#include <exo/memory_tracker.h>
+#include <exo/jobs.h>
+#include <exo/task_graph.h>
+#include "memory_tags.h"
 #include "ui.h"
 
-#include <unordered_map>
-#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
 #include <type_traits>
 /**
    This ECS implementation is inspired by flecs (https://github.com/SanderMertens/flecs).
@@ -42,6 +57,10 @@ concept TriviallyCopyable = std::is_trivially_copyable<T>::value;
 template<typename Component>
 concept Componentable = UIable<Component> && Nameable<Component> && TriviallyCopyable<Component>;
 
+// Queries declare how they access each component: `const Component` is read-only, `Component` can be written
+template<typename Component>
+concept QueryComponent = Componentable<std::remove_const_t<Component>>;
+
 // from EnTT, generates a unique unsigned integer per type
 struct family
 {
@@ -54,6 +73,18 @@ struct family
     }
 };
 
+// generates a unique index per list of component types, used to find the cached query of World::for_each
+struct query_family
+{
+    static u32 identifier() noexcept;
+
+    template <QueryComponent... T> static u32 type() noexcept
+    {
+        static const u32 value = identifier();
+        return value;
+    }
+};
+
 struct EntityId
 {
     static EntityId create()
@@ -100,7 +131,7 @@ namespace std
 {
 template <> struct hash<ECS::EntityId>
 {
-    std::size_t operator()(ECS::EntityId const &id) const noexcept { return std::hash<u64>{}(id.raw); }
+    std::size_t operator()(ECS::EntityId const &id) const noexcept { return hash_u64(id.raw); }
 };
 } // namespace std
 
@@ -109,34 +140,51 @@ namespace ECS
 
 using ComponentId = EntityId;
 // An archetype is a collection of components
-using Archetype = Vec<ComponentId>;
+using Archetype = SmallVec<ComponentId, 8>;
+// Index of each component of a query in an archetype
+using QueryIndices = SmallVec<u32, 8>;
 
-// A vector of one component
-struct ComponentStorage
+// Entities are stored in fixed-size chunks like Unity DOTS: a chunk holds the ids and the components of up to
+// `chunk_capacity` entities of one archetype, with one column per component (SoA).
+inline constexpr usize CHUNK_SIZE             = 16_KiB;
+inline constexpr usize CHUNK_COLUMN_ALIGNMENT = 16;
+
+struct Chunk
 {
-    // chunks like Unity DOTS?
-    Vec<u8> data;   // buffer
-    usize component_size{0}; // element size in bytes
+    alignas(64) u8 data[CHUNK_SIZE];
+};
+
+// Chunks of every archetype come from the same pool, an empty chunk is kept to be reused by any archetype
+struct ChunkPool
+{
+    ChunkPool() = default;
+    ChunkPool(const ChunkPool &) = delete;
+    ChunkPool &operator=(const ChunkPool &) = delete;
+    ~ChunkPool();
+
+    Chunk *allocate();
+    void free(Chunk *chunk);
 
-    bool operator==(const ComponentStorage&) const = default;
+    Vec<Chunk *> free_chunks;
 };
 
 struct ArchetypeStorage;
 using ArchetypeH = Handle<ArchetypeStorage>;
 
-// Each archetype is stored separately, and contains a SoA of components
+// Each archetype is stored separately, in chunks
 struct ArchetypeStorage
 {
     // A vector of component's type
     Archetype type;
 
-    // List of entities whose components are stored in this archetype
-    Vec<EntityId> entity_ids;
+    // Layout of a chunk: the entity ids, then one column per component in the order of `type`
+    SmallVec<u32, 8> component_sizes;
+    SmallVec<u32, 8> column_offsets;
+    u32 chunk_capacity = 0;
 
-    // List of components indexed by component type
-    // (e.g components[family::type<MyComponent>()] contains a list of MyComponent)
-    Vec<ComponentStorage> components;
-    usize size;
+    // Every chunk is full except the last one, the entity at `row` is in chunks[row / chunk_capacity]
+    Vec<Chunk *> chunks;
+    usize size = 0;
 
     // Edges to archetype if we add/remove the indexed component type
     // (e.g edges[family::type<MyComponent>()] contains a handle to "this archetype + MyComponent" and "this archetype -
@@ -150,13 +198,34 @@ struct ArchetypeStorage
     Vec<Edge> edges;
 
     bool operator==(const ArchetypeStorage&) const = default;
+
+    usize chunk_row_count(usize i_chunk) const { return std::min<usize>(chunk_capacity, size - i_chunk * chunk_capacity); }
+    EntityId *chunk_entity_ids(usize i_chunk) const { return reinterpret_cast<EntityId *>(chunks[i_chunk]->data); }
+    u8 *chunk_column(usize i_chunk, usize i_component) const { return chunks[i_chunk]->data + column_offsets[i_component]; }
+
+    EntityId &entity_id(usize row) const { return chunk_entity_ids(row / chunk_capacity)[row % chunk_capacity]; }
+    void *component(usize row, usize i_component) const
+    {
+        return chunk_column(row / chunk_capacity, i_component) + (row % chunk_capacity) * component_sizes[i_component];
+    }
 };
 
 // All ArchetypeStorage are stored in a graph
 struct Archetypes
 {
-    Pool<ArchetypeStorage> archetype_storages;
+    Archetypes() = default;
+    Archetypes(const Archetypes &) = delete;
+    Archetypes &operator=(const Archetypes &) = delete;
+    ~Archetypes();
+
+    PackedPool<ArchetypeStorage> archetype_storages;
     ArchetypeH root;
+    // archetypes are never destroyed, queries only have to test the ones created since their last update
+    Vec<ArchetypeH> creation_order;
+
+    // size in bytes of each component indexed by component id, registered before the component is stored
+    Vec<u32> component_sizes;
+    ChunkPool chunk_pool;
 };
 
 // Metadata of an entity
@@ -168,7 +237,7 @@ struct EntityRecord
     usize row;
 };
 
-using EntityIndex = std::unordered_map<EntityId, EntityRecord>;
+using EntityIndex = Map<EntityId, EntityRecord>;
 
 /// --- Builtin Components
 
@@ -183,7 +252,7 @@ struct InternalComponent
 
 struct InternalId
 {
-    const char *tag;
+    StringId tag;
 
     static const char *type_name() { return "InternalId"; }
     void display_ui() {}
@@ -194,19 +263,34 @@ struct World;
 namespace impl
 {
 // Archetype
-template <Componentable... ComponentTypes> Archetype create_archetype()
+template <QueryComponent... ComponentTypes> Archetype create_archetype()
 {
     constexpr usize component_count = sizeof...(ComponentTypes);
     Archetype result;
     result.resize(component_count);
     usize i = 0;
-    ((result[i++] = ComponentId::component<ComponentTypes>()), ...);
+    ((result[i++] = ComponentId::component<std::remove_const_t<ComponentTypes>>()), ...);
+    return result;
+}
+
+// components of a query that are not const
+template <QueryComponent... ComponentTypes> Archetype create_write_archetype()
+{
+    Archetype result;
+    (
+        [&] {
+            if constexpr (!std::is_const_v<ComponentTypes>)
+            {
+                result.push_back(ComponentId::component<ComponentTypes>());
+            }
+        }(),
+        ...);
     return result;
 }
 
-inline std::tuple<bool, Vec<u32>> archetype_contains(const Archetype &query, const Archetype &archetype)
+inline std::tuple<bool, QueryIndices> archetype_contains(const Archetype &query, const Archetype &archetype)
 {
-    Vec<u32> found(query.size(), u32_invalid);
+    QueryIndices found(query.size(), u32_invalid);
 
     if (query.size() > archetype.size())
     {
@@ -246,12 +330,20 @@ ArchetypeH find_or_create_archetype_storage_removing_component(Archetypes &graph
 ArchetypeH find_or_create_archetype_storage_adding_component(Archetypes &graph, ArchetypeH entity_archetype,
                                                              ComponentId component_type);
 ArchetypeH find_or_create_archetype_storage_from_root(Archetypes &graph, const Archetype &type);
-// add an entity id to a storage
-usize add_entity_id_to_storage(ArchetypeStorage &storage, EntityId entity);
-// add a single component to the i_component storage
-void add_component_to_storage(ArchetypeStorage &storage, usize i_component, void *data, usize len);
+// computes the column offsets and the number of entities per chunk from the sizes of the components
+void init_chunk_layout(ArchetypeStorage &storage, const Vec<u32> &component_sizes);
+// remember the size of a component, the chunk layout of the archetypes containing it depends on it
+void register_component_size(Archetypes &graph, ComponentId component_id, usize component_size);
+// add an entity id to a storage and returns its row, its components have to be written with add_component_to_storage
+usize add_entity_to_storage(ChunkPool &pool, ArchetypeStorage &storage, EntityId entity);
+// add `count` rows to a storage and returns the first one, their entity ids and components have to be written
+usize add_rows_to_storage(ChunkPool &pool, ArchetypeStorage &storage, usize count);
+// write a single component of the entity at row
+void add_component_to_storage(ArchetypeStorage &storage, usize row, usize i_component, const void *data, usize len);
 // remove an entity (id + components) from the storage, if entity's row is not last it will be swapped with last
-void remove_entity_from_storage(ArchetypeStorage &storage, usize entity_row);
+void remove_entity_from_storage(ChunkPool &pool, ArchetypeStorage &storage, usize entity_row);
+// remove the last `count` rows of the storage
+void remove_last_rows_from_storage(ChunkPool &pool, ArchetypeStorage &storage, usize count);
 
 // Components
 void add_component(World &world, EntityId entity, ComponentId component_id, void *component_data, usize component_size);
@@ -259,43 +351,96 @@ void remove_component(World &world, EntityId entity, ComponentId component_id);
 void set_component(World &world, EntityId entity, ComponentId component_id, void *component_data, usize component_size);
 bool has_component(World &world, EntityId entity, ComponentId component);
 void *get_component(World &world, EntityId entity, ComponentId component_id);
+void destroy_entity(World &world, EntityId entity);
 
 template <Componentable Component> Option<usize> get_component_idx(const Archetype &type)
 {
     return get_component_idx(type, family::type<Component>());
 }
 
-// returns a reference to a component from a query, used to simulate a constexpr loop in for_each
-template <Componentable Component> Component &component_ref(const Archetype &query, usize i_row, const Vec<u32> query_indices, ArchetypeStorage &storage)
+// Queries
+// list of the archetypes matching a query and the index of each queried component in their type
+struct QueryCache
 {
-    const auto component_id = EntityId::component<Component>();
-    usize i_query = 0;
-    for (; query[i_query] != component_id; i_query++) {}
-    assert(i_query < query.size());
+    Archetype query;
+    // components written by the query
+    Archetype writes;
+    Vec<ArchetypeH> archetypes;
+    // query.size() indices per matching archetype
+    Vec<u32> columns;
+    // number of archetypes of graph.creation_order already tested
+    usize archetypes_seen = 0;
+    const Archetypes *graph = nullptr;
+};
 
-    usize i_component = query_indices[i_query];
-    auto &component_storage = storage.components[i_component];
-    const usize component_byte_idx = i_row * component_storage.component_size;
+// test the archetypes created since the last update
+void update_query_cache(QueryCache &cache, const Archetypes &graph);
+// number of entities matching the query
+usize query_entity_count(const Archetypes &graph, const QueryCache &cache);
+// two queries conflict when one of them writes a component accessed by the other, otherwise they can run concurrently
+bool queries_conflict(const QueryCache &a, const QueryCache &b);
+bool accesses_conflict(const Archetype &a_components, const Archetype &a_writes, const Archetype &b_components, const Archetype &b_writes);
 
-    return *reinterpret_cast<Component*>(&component_storage.data[component_byte_idx]);
-}
+struct QueryChunk
+{
+    const ArchetypeStorage *storage;
+    const u32 *columns;
+    usize i_chunk;
+    // index of the first row of the chunk among all the entities matching the query
+    usize first_index;
+};
+// list every chunk of the matching archetypes in the order of for_each
+void gather_query_chunks(const Archetypes &graph, const QueryCache &cache, Vec<QueryChunk> &chunks);
 
-template <Componentable Component> const Component &component_const_ref(const Archetype &query, usize i_row, const Vec<u32> query_indices, const ArchetypeStorage &storage)
+template <typename... ComponentTypes, typename Lambda, usize... I>
+void call_with_columns(const ArchetypeStorage &storage, usize i_chunk, const u32 *columns, Lambda &lambda, std::index_sequence<I...>)
 {
-    const auto component_id = EntityId::component<Component>();
-    usize i_query = 0;
-    for (; query[i_query] != component_id; i_query++) {}
-    assert(i_query < query.size());
+    lambda(storage.chunk_row_count(i_chunk), reinterpret_cast<ComponentTypes *>(storage.chunk_column(i_chunk, columns[I]))...);
+}
 
-    usize i_component = query_indices[i_query];
-    const auto &component_storage = storage.components[i_component];
-    const usize component_byte_idx = i_row * component_storage.component_size;
+// calls lambda(row_count, columns...) for every chunk of the matching archetypes, the cache has to be up to date
+template <typename... ComponentTypes, typename Lambda>
+void for_each_chunk(const Archetypes &graph, const QueryCache &cache, Lambda &lambda)
+{
+    constexpr usize component_count = sizeof...(ComponentTypes);
+    for (usize i_archetype = 0; i_archetype < cache.archetypes.size(); i_archetype++)
+    {
+        const auto &storage = *graph.archetype_storages.get(cache.archetypes[i_archetype]);
+        const u32 *columns  = cache.columns.data() + i_archetype * component_count;
+        for (usize i_chunk = 0; i_chunk < storage.chunks.size(); i_chunk++)
+        {
+            call_with_columns<ComponentTypes...>(storage, i_chunk, columns, lambda, std::make_index_sequence<component_count>{});
+        }
+    }
+}
 
-    return *reinterpret_cast<const Component*>(&component_storage.data[component_byte_idx]);
+// calls lambda(first_index, row_count, columns...) for every chunk of the matching archetypes from the job threads
+template <typename... ComponentTypes, typename Lambda>
+void par_for_each_chunk(const Archetypes &graph, const QueryCache &cache, usize grain, Lambda &lambda)
+{
+    Vec<QueryChunk> chunks;
+    gather_query_chunks(graph, cache, chunks);
+
+    jobs::parallel_for(chunks.size(), grain, [&](usize i_chunk) {
+        const auto &chunk = chunks[i_chunk];
+        auto with_index   = [&](usize row_count, ComponentTypes *...columns) { lambda(chunk.first_index, row_count, columns...); };
+        call_with_columns<ComponentTypes...>(*chunk.storage, chunk.i_chunk, chunk.columns, with_index, std::make_index_sequence<sizeof...(ComponentTypes)>{});
+    });
 }
 
 } // namespace impl
 
+using SystemId = u32;
+
+// A system runs every frame on the world, it declares every component it accesses and the ones it writes
+struct System
+{
+    std::string name;
+    Archetype components;
+    Archetype writes;
+    std::function<void(World &)> function;
+};
+
 struct World
 {
     World();
@@ -308,18 +453,18 @@ struct World
     EntityId create_entity_internal(EntityId new_entity, ComponentTypes &&...components)
     {
         auto archetype = impl::create_archetype<ComponentTypes...>();
+        (impl::register_component_size(archetypes, ComponentId::component<ComponentTypes>(), sizeof(ComponentTypes)), ...);
 
         // find or create a new bucket for this archetype
         auto storage_h = impl::find_or_create_archetype_storage_from_root(archetypes, archetype);
         auto &storage  = *archetypes.archetype_storages.get(storage_h);
 
-        // add the entity to the entity array
-        auto row = impl::add_entity_id_to_storage(storage, new_entity);
+        // add the entity to the last chunk
+        auto row = impl::add_entity_to_storage(archetypes.chunk_pool, storage, new_entity);
 
-        // add the component to every component array, fold expression black magic...
+        // add the component to every component column, fold expression black magic...
         uint component_i = 0;
-        (impl::add_component_to_storage(storage, component_i++, &components, sizeof(ComponentTypes)), ...);
-        storage.size += 1;
+        (impl::add_component_to_storage(storage, row, component_i++, &components, sizeof(ComponentTypes)), ...);
 
         // put the entity record in the entity index
         entity_index[new_entity] = EntityRecord{.archetype = storage_h, .row = row};
@@ -329,14 +474,11 @@ struct World
 
     template <Componentable Component> void create_component_if_needed_internal()
     {
-        auto component_id = EntityId::component<Component>();
-        if (!entity_index.contains(component_id))
-        {
-            auto [it, inserted] = string_interner.insert(std::string{Component::type_name()});
-            create_entity_internal(component_id, InternalComponent{sizeof(Component)}, InternalId{it->c_str()});
-        }
+        create_component_if_needed_internal(EntityId::component<Component>(), sizeof(Component), Component::type_name());
     }
 
+    void create_component_if_needed_internal(ComponentId component_id, usize component_size, const char *type_name);
+
     // Create an entity with a list of components
     template <Componentable... ComponentTypes> EntityId create_entity(ComponentTypes &&...components)
     {
@@ -348,10 +490,12 @@ struct World
     // Create an entity with a name and a list of components
     template <Componentable... ComponentTypes> EntityId create_entity(std::string_view name, ComponentTypes &&...components)
     {
-        auto [it, inserted] = string_interner.insert(std::string{name});
-        return create_entity<InternalId, ComponentTypes...>(InternalId{it->c_str()}, std::forward<ComponentTypes>(components)...);
+        return create_entity<InternalId, ComponentTypes...>(InternalId{name}, std::forward<ComponentTypes>(components)...);
     }
 
+    // Remove an entity and its components from the world
+    void destroy_entity(EntityId entity);
+
 
     /// --- Components
 
@@ -387,48 +531,119 @@ struct World
         return reinterpret_cast<Component *>(impl::get_component(*this, entity, ComponentId::component<Component>()));
     }
 
-    template <Componentable... ComponentTypes, typename Lambda> void for_each(Lambda lambda)
+    /// --- Queries
+    // The components of a query can be const to only read them. Queries that only read the same components can run
+    // concurrently, see impl::queries_conflict.
+
+    // Calls lambda(components...) for every entity that has all the components
+    template <QueryComponent... ComponentTypes, typename Lambda> void for_each(Lambda lambda)
     {
-        auto query = impl::create_archetype<ComponentTypes...>();
+        PROFILE_SCOPE("World::for_each");
+        auto &cache = query_cache<ComponentTypes...>();
+        auto each_row = [&](usize row_count, ComponentTypes *...columns) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
+            {
+                lambda(columns[i_row]...);
+            }
+        };
+        impl::for_each_chunk<ComponentTypes...>(archetypes, cache, each_row);
+    }
 
-        for (auto &[h, storage] : archetypes.archetype_storages)
-        {
-            auto [contains, query_indices] = impl::archetype_contains(query, storage->type);
-            if (contains)
+    template <QueryComponent... ComponentTypes, typename Lambda> void for_each(Lambda lambda) const
+    {
+        PROFILE_SCOPE("World::for_each");
+        auto &cache = query_cache<const ComponentTypes...>();
+        auto each_row = [&](usize row_count, const ComponentTypes *...columns) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
             {
+                lambda(columns[i_row]...);
+            }
+        };
+        impl::for_each_chunk<const ComponentTypes...>(archetypes, cache, each_row);
+    }
 
-                for (usize i_row = 0; i_row < storage->size; i_row++)
-                {
-                    // TODO: there is a loop over query in component_ref that could be removed if it was possible
-                    // to loop over ComponentTypes for each query and then pass that as arguments to the lambda
-                    lambda(impl::component_ref<ComponentTypes>(query, i_row, query_indices, *storage)...);
-                }
+    // Calls lambda(row_count, columns...) for every chunk, each column is a contiguous array of row_count components
+    template <QueryComponent... ComponentTypes, typename Lambda> void for_each_chunk(Lambda lambda)
+    {
+        PROFILE_SCOPE("World::for_each_chunk");
+        auto &cache = query_cache<ComponentTypes...>();
+        impl::for_each_chunk<ComponentTypes...>(archetypes, cache, lambda);
+    }
 
+    // Same as for_each but the chunks are split between the job threads, `grain` is the number of chunks per job (0
+    // makes about 4 jobs per thread). The lambda is called concurrently, it should only write to the components of
+    // its entity.
+    template <QueryComponent... ComponentTypes, typename Lambda> void par_for_each(usize grain, Lambda lambda)
+    {
+        PROFILE_SCOPE("World::par_for_each");
+        auto &cache = query_cache<ComponentTypes...>();
+        auto each_row = [&](usize /*first_index*/, usize row_count, ComponentTypes *...columns) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
+            {
+                lambda(columns[i_row]...);
             }
-        }
+        };
+        impl::par_for_each_chunk<ComponentTypes...>(archetypes, cache, grain, each_row);
     }
 
-    template <Componentable... ComponentTypes, typename Lambda> void for_each(Lambda lambda) const
+    // Calls lambda(first_index, row_count, columns...) for every chunk from the job threads, first_index is the
+    // position of the chunk's first entity in the order of for_each to write outputs at the same place every time
+    template <QueryComponent... ComponentTypes, typename Lambda> void par_for_each_chunk(usize grain, Lambda lambda)
     {
-        auto query = impl::create_archetype<ComponentTypes...>();
+        PROFILE_SCOPE("World::par_for_each_chunk");
+        auto &cache = query_cache<ComponentTypes...>();
+        impl::par_for_each_chunk<ComponentTypes...>(archetypes, cache, grain, lambda);
+    }
 
-        for (const auto &[h, storage] : archetypes.archetype_storages)
-        {
-            auto [contains, query_indices] = impl::archetype_contains(query, storage->type);
-            if (contains)
-            {
+    // Number of entities that have all the components
+    template <QueryComponent... ComponentTypes> usize count() const
+    {
+        return impl::query_entity_count(archetypes, query_cache<ComponentTypes...>());
+    }
 
-                for (usize i_row = 0; i_row < storage->size; i_row++)
-                {
-                    // TODO: there is a loop over query in component_ref that could be removed if it was possible
-                    // to loop over ComponentTypes for each query and then pass that as arguments to the lambda
-                    lambda(impl::component_const_ref<ComponentTypes>(query, i_row, query_indices, *storage)...);
-                }
+    // Returns the archetypes matching a list of components, the result is cached and only the archetypes created
+    // since the last call are tested. Entities should not be created while queries run on other threads.
+    template <QueryComponent... ComponentTypes> const impl::QueryCache &query_cache() const
+    {
+        std::lock_guard lock{query_caches_mutex};
 
-            }
+        const u32 i_query = query_family::type<ComponentTypes...>();
+        if (i_query >= query_caches.size())
+        {
+            query_caches.resize(i_query + 1);
         }
+
+        // the caches are allocated separately, a for_each can be nested in another one
+        auto &cache = query_caches[i_query];
+        if (!cache)
+        {
+            cache         = std::make_unique<impl::QueryCache>();
+            cache->query  = impl::create_archetype<ComponentTypes...>();
+            cache->writes = impl::create_write_archetype<ComponentTypes...>();
+        }
+        impl::update_query_cache(*cache, archetypes);
+        return *cache;
     }
 
+    /// --- Systems
+    // A system starts when the systems added before it that conflict with it are done (see impl::accesses_conflict),
+    // the other ones run in parallel on the job system. Systems should not create entities or change their components.
+
+    // Add a system that calls lambda(components...) for every entity that has all the components, the const ones
+    // are only read
+    template <QueryComponent... ComponentTypes, typename Lambda> SystemId add_system(std::string name, Lambda lambda)
+    {
+        return add_system(std::move(name),
+                          impl::create_archetype<ComponentTypes...>(),
+                          impl::create_write_archetype<ComponentTypes...>(),
+                          [lambda](World &world) { world.for_each<ComponentTypes...>(lambda); });
+    }
+
+    SystemId add_system(std::string name, Archetype components, Archetype writes, std::function<void(World &)> function);
+
+    // Run all the systems and wait for them
+    void run_systems();
+
     /// --- Duplicate for "singleton" components
 
     // Add a component to an entity, the entity SHOULD NOT already have that component
@@ -465,7 +680,165 @@ struct World
     EntityIndex entity_index;
     Archetypes archetypes;
     EntityId singleton;
-    std::unordered_set<std::string> string_interner;
+    // indexed by query_family::type<ComponentTypes...>()
+    mutable Vec<std::unique_ptr<impl::QueryCache>> query_caches;
+    mutable std::mutex query_caches_mutex;
+
+    Vec<System> systems;
+    // one task per system, the dependencies are added with the systems
+    TaskGraph systems_graph;
+};
+
+// A query owning its cache, to keep in a system that runs every frame
+template <QueryComponent... ComponentTypes> struct Query
+{
+    Query()
+    {
+        cache.query  = impl::create_archetype<ComponentTypes...>();
+        cache.writes = impl::create_write_archetype<ComponentTypes...>();
+    }
+
+    static constexpr bool is_read_only = (std::is_const_v<ComponentTypes> && ...);
+
+    // Calls lambda(components...) for every entity of the world that has all the components
+    template <typename Lambda> void for_each(World &world, Lambda lambda)
+    {
+        PROFILE_SCOPE("Query::for_each");
+        auto each_row = [&](usize row_count, ComponentTypes *...columns) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
+            {
+                lambda(columns[i_row]...);
+            }
+        };
+        update(world);
+        impl::for_each_chunk<ComponentTypes...>(world.archetypes, cache, each_row);
+    }
+
+    // Calls lambda(row_count, columns...) for every chunk, each column is a contiguous array of row_count components
+    template <typename Lambda> void for_each_chunk(World &world, Lambda lambda)
+    {
+        PROFILE_SCOPE("Query::for_each_chunk");
+        update(world);
+        impl::for_each_chunk<ComponentTypes...>(world.archetypes, cache, lambda);
+    }
+
+    // Same as World::par_for_each
+    template <typename Lambda> void par_for_each(World &world, usize grain, Lambda lambda)
+    {
+        PROFILE_SCOPE("Query::par_for_each");
+        auto each_row = [&](usize /*first_index*/, usize row_count, ComponentTypes *...columns) {
+            for (usize i_row = 0; i_row < row_count; i_row++)
+            {
+                lambda(columns[i_row]...);
+            }
+        };
+        update(world);
+        impl::par_for_each_chunk<ComponentTypes...>(world.archetypes, cache, grain, each_row);
+    }
+
+    template <QueryComponent... OtherTypes> bool conflicts_with(const Query<OtherTypes...> &other) const
+    {
+        return impl::queries_conflict(cache, other.cache);
+    }
+
+    // A query can only be used with a single world
+    void update(const World &world) { impl::update_query_cache(cache, world.archetypes); }
+
+    impl::QueryCache cache;
+};
+
+/// --- Deferred structural changes
+
+// Records the structural changes (create, destroy, add, remove) and the component writes of entities to apply them
+// later, from a for_each or from systems running in parallel. Each thread of the job system records in its own
+// buffer, the threads outside of the job system share one behind a mutex.
+// playback() applies all of them in a batch: the entities are sorted by source and destination archetype so that
+// each group is moved with one memcpy per column and per run of contiguous rows.
+struct EntityCommandBuffer
+{
+    enum struct CommandType : u8
+    {
+        Create,
+        Destroy,
+        Add,
+        Remove,
+        Set,
+    };
+
+    struct Command
+    {
+        EntityId entity       = {};
+        ComponentId component = {};
+        // Add and Set only, a component fits in a chunk
+        const char *type_name = nullptr;
+        u32 data_offset       = 0;
+        u16 data_size         = 0;
+        CommandType type      = CommandType::Create;
+    };
+    static_assert(CHUNK_SIZE <= std::numeric_limits<u16>::max());
+
+    struct alignas(64) ThreadCommands
+    {
+        Vec<Command> commands;
+        Vec<u8> data;
+    };
+
+    EntityCommandBuffer();
+    EntityCommandBuffer(const EntityCommandBuffer &) = delete;
+    EntityCommandBuffer &operator=(const EntityCommandBuffer &) = delete;
+
+    // The id of the entity is reserved now, the entity exists after playback
+    template <Componentable... ComponentTypes> EntityId create_entity(ComponentTypes... components)
+    {
+        auto entity = EntityId::create();
+        record({.entity = entity, .type = CommandType::Create}, nullptr);
+        (add_component(entity, components), ...);
+        return entity;
+    }
+
+    void destroy_entity(EntityId entity) { record({.entity = entity, .type = CommandType::Destroy}, nullptr); }
+
+    // Add a component to an entity, the entity SHOULD NOT already have that component when the buffer is played back
+    template <Componentable Component> void add_component(EntityId entity, Component component)
+    {
+        record({.entity    = entity,
+                .component = ComponentId::component<Component>(),
+                .type_name = Component::type_name(),
+                .data_size = sizeof(Component),
+                .type      = CommandType::Add},
+               &component);
+    }
+
+    template <Componentable Component> void remove_component(EntityId entity)
+    {
+        record({.entity = entity, .component = ComponentId::component<Component>(), .type = CommandType::Remove}, nullptr);
+    }
+
+    // Set the value of a component or add it to an entity
+    template <Componentable Component> void set_component(EntityId entity, Component component)
+    {
+        record({.entity    = entity,
+                .component = ComponentId::component<Component>(),
+                .type_name = Component::type_name(),
+                .data_size = sizeof(Component),
+                .type      = CommandType::Set},
+               &component);
+    }
+
+    // Apply the commands in the order they were recorded by each thread and clear the buffer. Nothing else should
+    // access the world or record commands during the playback.
+    void playback(World &world);
+
+    bool is_empty() const;
+
+    // copies data_size bytes of data in the buffer of the calling thread
+    void record(Command command, const void *data);
+
+    // one buffer per job thread, and a last one for the other threads
+    Vec<ThreadCommands> per_thread;
+    std::mutex external_mutex;
+    // index of the change of each entry of the entity index during a playback, u32_invalid outside of it
+    Vec<u32> entry_changes;
 };
 
 }; // namespace ECS
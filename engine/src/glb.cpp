@@ -1,9 +1,11 @@
 #include "glb.h"
 
 #include <exo/algorithms.h>
+#include <exo/batch_transforms.h>
 #include <exo/numerics.h>
 #include <exo/types.h>
 #include <exo/logger.h>
+#include <exo/profiler.h>
 
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
@@ -310,67 +312,64 @@ static void process_json(Scene &new_scene, rapidjson::Document &document, const
     auto scene = scenes[i_scene].GetObject();
     auto roots = scene["nodes"].GetArray();
 
-    Vec<u32> i_node_stack;
-    Vec<float4x4> transforms_stack;
-    i_node_stack.reserve(nodes.Size());
-    transforms_stack.reserve(nodes.Size());
-
-    auto get_transform = [](auto node) {
-        float4x4 transform = float4x4::identity();
-
-
-        if (node.HasMember("matrix"))
-        {
-            usize i = 0;
-            auto matrix = node["matrix"].GetArray();
-            assert(matrix.Size() == 16);
-
-            for (u32 i_element = 0; i_element < matrix.Size(); i_element += 1) {
-                transform.at(i%4, i/4) = static_cast<float>(matrix[i_element].GetDouble());
-            }
-        }
-
+    // Compose the local transform of every node in one batch
+    usize node_count = nodes.Size();
+    Vec<float3> translations(node_count, float3(0.0f));
+    Vec<float4> rotations(node_count, float4(0.0f, 0.0f, 0.0f, 1.0f));
+    Vec<float3> scales(node_count, float3(1.0f));
+    for (u32 i_node = 0; i_node < node_count; i_node += 1)
+    {
+        auto node = nodes[i_node].GetObject();
         if (node.HasMember("translation"))
         {
-            auto translation_factors = node["translation"].GetArray();
-            float4x4 translation = float4x4::identity();
-            translation.at(0, 3) = static_cast<float>(translation_factors[0].GetDouble());
-            translation.at(1, 3) = static_cast<float>(translation_factors[1].GetDouble());
-            translation.at(2, 3) = static_cast<float>(translation_factors[2].GetDouble());
-            transform = translation;
+            auto translation = node["translation"].GetArray();
+            translations[i_node] = float3(static_cast<float>(translation[0].GetDouble()),
+                                          static_cast<float>(translation[1].GetDouble()),
+                                          static_cast<float>(translation[2].GetDouble()));
         }
 
         if (node.HasMember("rotation"))
         {
             auto rotation = node["rotation"].GetArray();
-            float4 quaternion;
-            quaternion.x = static_cast<float>(rotation[0].GetDouble());
-            quaternion.y = static_cast<float>(rotation[1].GetDouble());
-            quaternion.z = static_cast<float>(rotation[2].GetDouble());
-            quaternion.w = static_cast<float>(rotation[3].GetDouble());
-
-            transform = transform * float4x4({
-                1.0f - 2.0f*quaternion.y*quaternion.y - 2.0f*quaternion.z*quaternion.z, 2.0f*quaternion.x*quaternion.y - 2.0f*quaternion.z*quaternion.w, 2.0f*quaternion.x*quaternion.z + 2.0f*quaternion.y*quaternion.w, 0.0f,
-                2.0f*quaternion.x*quaternion.y + 2.0f*quaternion.z*quaternion.w, 1.0f - 2.0f*quaternion.x*quaternion.x - 2.0f*quaternion.z*quaternion.z, 2.0f*quaternion.y*quaternion.z - 2.0f*quaternion.x*quaternion.w, 0.0f,
-                2.0f*quaternion.x*quaternion.z - 2.0f*quaternion.y*quaternion.w, 2.0f*quaternion.y*quaternion.z + 2.0f*quaternion.x*quaternion.w, 1.0f - 2.0f*quaternion.x*quaternion.x - 2.0f*quaternion.y*quaternion.y, 0.0f,
-                0.0f, 0.0f, 0.0f, 1.0f,
-            });
+            rotations[i_node] = float4(static_cast<float>(rotation[0].GetDouble()),
+                                       static_cast<float>(rotation[1].GetDouble()),
+                                       static_cast<float>(rotation[2].GetDouble()),
+                                       static_cast<float>(rotation[3].GetDouble()));
         }
 
         if (node.HasMember("scale"))
         {
-            auto scale_factors = node["scale"].GetArray();
-            float4x4 scale = {};
-            scale.at(0, 0) = static_cast<float>(scale_factors[0].GetDouble());
-            scale.at(1, 1) = static_cast<float>(scale_factors[1].GetDouble());
-            scale.at(2, 2) = static_cast<float>(scale_factors[2].GetDouble());
-            scale.at(3, 3) = 1.0f;
-
-            transform = transform * scale;
+            auto scale = node["scale"].GetArray();
+            scales[i_node] = float3(static_cast<float>(scale[0].GetDouble()),
+                                    static_cast<float>(scale[1].GetDouble()),
+                                    static_cast<float>(scale[2].GetDouble()));
         }
+    }
 
-        return transform;
-    };
+    Vec<float4x4> local_transforms(node_count);
+    compose_trs(translations, rotations, scales, local_transforms);
+
+    // A node has either a matrix or TRS properties
+    for (u32 i_node = 0; i_node < node_count; i_node += 1)
+    {
+        auto node = nodes[i_node].GetObject();
+        if (node.HasMember("matrix"))
+        {
+            auto matrix = node["matrix"].GetArray();
+            assert(matrix.Size() == 16);
+
+            // glTF matrices are stored in column-major order like float4x4
+            for (u32 i_element = 0; i_element < matrix.Size(); i_element += 1) {
+                local_transforms[i_node].values[i_element] = static_cast<float>(matrix[i_element].GetDouble());
+            }
+        }
+    }
+
+    Vec<u32> i_node_stack;
+    Vec<float4x4> transforms_stack; // world transforms of the nodes in i_node_stack
+    Vec<float4x4> children_transforms;
+    i_node_stack.reserve(node_count);
+    transforms_stack.reserve(node_count);
 
     for (auto &root : roots)
     {
@@ -380,15 +379,14 @@ static void process_json(Scene &new_scene, rapidjson::Document &document, const
         transforms_stack.clear();
 
         i_node_stack.push_back(i_root);
-        transforms_stack.push_back(float4x4::identity());
+        transforms_stack.push_back(local_transforms[i_root]);
 
         while (!i_node_stack.empty())
         {
             u32 i_node = i_node_stack.back(); i_node_stack.pop_back();
-            float4x4 parent_transform = transforms_stack.back(); transforms_stack.pop_back();
+            float4x4 transform = transforms_stack.back(); transforms_stack.pop_back();
 
-            auto node      = nodes[i_node].GetObject();
-            auto transform = parent_transform * get_transform(node);
+            auto node = nodes[i_node].GetObject();
 
             if (node.HasMember("mesh"))
             {
@@ -399,10 +397,17 @@ static void process_json(Scene &new_scene, rapidjson::Document &document, const
             {
                 auto children = node["children"].GetArray();
 
+                children_transforms.clear();
+                for (u32 i_child = 0; i_child < children.Size(); i_child += 1)
+                {
+                    children_transforms.push_back(local_transforms[children[i_child].GetUint()]);
+                }
+                multiply_many(transform, children_transforms);
+
                 for (u32 i_child = 0; i_child < children.Size(); i_child += 1)
                 {
                     i_node_stack.push_back(children[i_child].GetUint());
-                    transforms_stack.push_back(transform);
+                    transforms_stack.push_back(children_transforms[i_child]);
                 }
             }
         }
@@ -412,6 +417,8 @@ static void process_json(Scene &new_scene, rapidjson::Document &document, const
 
 Scene load_file(const std::string_view &path)
 {
+    PROFILE_SCOPE("glb::load_file");
+
     auto file = platform::MappedFile::open(path);
     if (!file)
     {
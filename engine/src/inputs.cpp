@@ -115,7 +115,8 @@ static void display_optional(const char *label, Option<int2> vector)
 
 void Inputs::display_ui(UI::Context &ui)
 {
-    if (ui.begin_window("Inputs"))
+    static const StringId inputs_window = "Inputs";
+    if (ui.begin_window(inputs_window))
     {
         if (ImGui::CollapsingHeader("Keys"))
         {
@@ -3,12 +3,13 @@
 #include <exo/types.h>
 #include <exo/option.h>
 #include <exo/collections/vector.h>
+#include <exo/collections/small_vector.h>
+#include <exo/map.h>
 #include <exo/algorithms.h>
 #include <cross/window.h>
 
 #include <optional>
 #include <string>
-#include <unordered_map>
 
 // clang-format off
 namespace UI { struct Context; };
@@ -32,8 +33,8 @@ inline constexpr const char *to_string(Action action) { return action_to_string_
 struct KeyBinding
 {
     // all keys need to be pressed
-    Vec<VirtualKey> keys;
-    Vec<MouseButton> mouse_buttons;
+    SmallVec<VirtualKey, 4> keys;
+    SmallVec<MouseButton, 2> mouse_buttons;
 };
 
 class Inputs
@@ -52,7 +53,7 @@ class Inputs
     void display_ui(UI::Context &ui);
 
   private:
-    std::unordered_map<Action, KeyBinding> bindings;
+    Map<Action, KeyBinding> bindings;
 
     std::array<bool, to_underlying(VirtualKey::Count) + 1> keys_pressed           = {};
     std::array<bool, to_underlying(MouseButton::Count) + 1> mouse_buttons_pressed = {};
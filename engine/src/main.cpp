@@ -1,6 +1,7 @@
 #include "app.h"
 #include <exo/types.h>
 #include <exo/logger.h>
+#include <exo/jobs.h>
 
 #include "glb.h"
 #include "asset_manager.h"
@@ -36,7 +37,11 @@ int main(int argc, char **argv)
     UNUSED(scene);
     #endif
 
-    App app;
-    app.run();
+    jobs::init();
+    {
+        App app;
+        app.run();
+    }
+    jobs::shutdown();
     return 0;
 }
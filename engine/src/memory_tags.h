@@ -0,0 +1,23 @@
+#pragma once
+
+// Tags of the memory tracker, displayed in the "Memory" window
+struct EcsMemory
+{
+    static constexpr const char *name = "ECS";
+};
+
+struct AssetMemory
+{
+    static constexpr const char *name = "Assets";
+};
+
+// mapped staging memory used by the uploads in flight
+struct StreamerMemory
+{
+    static constexpr const char *name = "Streamer staging";
+};
+
+struct DescriptorMemory
+{
+    static constexpr const char *name = "Descriptor sets";
+};
@@ -1,6 +1,7 @@
 #include "render/base_renderer.h"
 
 #include <exo/logger.h>
+#include <exo/allocation_counter.h>
 
 BaseRenderer BaseRenderer::create(const platform::Window &window, gfx::DeviceDescription desc)
 {
@@ -55,6 +56,11 @@ BaseRenderer BaseRenderer::create(const platform::Window &window, gfx::DeviceDes
         timing.create(device);
     }
 
+    for (auto &frame_arena : renderer.frame_arenas)
+    {
+        frame_arena = Arena::create(1_MiB);
+    }
+
     // Prepare the frame synchronization
     renderer.fence = device.create_fence();
 
@@ -86,6 +92,9 @@ BaseRenderer BaseRenderer::create(const platform::Window &window, gfx::DeviceDes
         .attachments_format = {surface.format.format},
     });
 
+    // the first frame only reports its own allocations
+    renderer.heap_allocations = allocation_counter::heap_allocations();
+
     return renderer;
 }
 
@@ -104,6 +113,13 @@ void BaseRenderer::destroy()
     {
         timing.destroy(device);
     }
+
+    device.frame_arena = nullptr;
+    for (auto &frame_arena : frame_arenas)
+    {
+        frame_arena.destroy();
+    }
+
     surface.destroy(context, device);
     device.destroy(context);
     context.destroy();
@@ -137,9 +153,10 @@ void BaseRenderer::reload_shader(std::string_view shader_name)
     logger::info("{} changed!\n", shader_name);
 
     // Find the shader that needs to be updated
+    StringId shader_id = shader_name;
     gfx::Shader *found = nullptr;
     for (auto &[shader_h, shader] : device.shaders) {
-        if (shader_name == shader->filename) {
+        if (shader->filename == shader_id) {
             assert(found == nullptr);
             found = &(*shader);
         }
@@ -208,14 +225,28 @@ bool BaseRenderer::start_frame()
 
     device.reset_work_pool(work_pool);
 
+    // Log the timings of one frame per second
+    static logger::RateLimiter timings_limiter{1000.0};
+    bool log_timings = timings_limiter.allow();
+
     timing.get_results(device);
-    for (u32 i_label = 0; i_label < timing.labels.size(); i_label += 1)
+    for (u32 i_label = 0; log_timings && i_label < timing.labels.size(); i_label += 1)
     {
         logger::info("[{}]: CPU {:.4f} ms | GPU {:.4f} ms\n", timing.labels[i_label], timing.cpu[i_label], timing.gpu[i_label]);
     }
 
     timing.reset(device);
 
+    u64 heap_allocations_now = allocation_counter::heap_allocations();
+    if (log_timings)
+    {
+        logger::info("[Heap allocations]: {}\n", heap_allocations_now - heap_allocations);
+    }
+    heap_allocations = heap_allocations_now;
+
+    // The previous frame using this arena is done on the GPU
+    frame_arenas[current_frame].reset();
+    device.frame_arena = &frame_arenas[current_frame];
 
     dynamic_uniform_buffer.start_frame();
     dynamic_vertex_buffer.start_frame();
@@ -225,6 +256,11 @@ bool BaseRenderer::start_frame()
     return out_of_date_swapchain;
 }
 
+Arena &BaseRenderer::frame_arena()
+{
+    return frame_arenas[frame_count % FRAME_QUEUE_LENGTH];
+}
+
 bool BaseRenderer::end_frame(gfx::ComputeWork &cmd)
 {
     // vulkan hack: hint the device to submit a semaphore to wait on before presenting
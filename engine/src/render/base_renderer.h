@@ -28,6 +28,8 @@ struct BaseRenderer
     uint frame_count;
     std::array<gfx::WorkPool, FRAME_QUEUE_LENGTH> work_pools;
     std::array<RenderTimings, FRAME_QUEUE_LENGTH> timings;
+    std::array<Arena, FRAME_QUEUE_LENGTH> frame_arenas;
+    u64 heap_allocations = 0; // number of heap allocations at the start of the last frame (debug only)
     gfx::Fence fence;
 
     RingBuffer dynamic_uniform_buffer;
@@ -58,5 +60,6 @@ struct BaseRenderer
     void reload_shader(std::string_view shader_name);
     void on_resize();
     bool start_frame();
+    Arena &frame_arena();
     bool end_frame(gfx::ComputeWork &cmd);
 };
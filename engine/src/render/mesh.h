@@ -1,6 +1,8 @@
 #pragma once
 #include <exo/types.h>
 #include <exo/collections/vector.h>
+#include <exo/memory_tracker.h>
+#include "memory_tags.h"
 
 #include <string>
 
@@ -15,9 +17,9 @@ struct SubMesh
 struct Mesh
 {
     std::string name;
-    Vec<u32> indices;
-    Vec<float4> positions;
-    Vec<SubMesh> submeshes;
+    TaggedVec<AssetMemory, u32> indices;
+    TaggedVec<AssetMemory, float4> positions;
+    TaggedVec<AssetMemory, SubMesh> submeshes;
 
     bool operator==(const Mesh &other) const = default;
 };
@@ -1,6 +1,9 @@
 #include "render/renderer.h"
 
 #include <exo/logger.h>
+#include <exo/profiler.h>
+#include <exo/radix_sort.h>
+#include <exo/sort_key.h>
 #include "asset_manager.h"
 #include "camera.h"
 #include "ui.h"
@@ -209,7 +212,8 @@ void Renderer::display_ui(UI::Context &ui)
     auto &device = base_renderer.device;
 
     ImGuiWindowFlags fb_flags = 0;// ImGuiWindowFlags_NoDecoration;
-    if (ui.begin_window("Framebuffer", true, fb_flags))
+    static const StringId framebuffer_window = "Framebuffer";
+    if (ui.begin_window(framebuffer_window, true, fb_flags))
     {
         float2 max = ImGui::GetWindowContentRegionMax();
         float2 min = ImGui::GetWindowContentRegionMin();
@@ -227,7 +231,8 @@ void Renderer::display_ui(UI::Context &ui)
         ui.end_window();
     }
 
-    if (ui.begin_window("Textures"))
+    static const StringId textures_window = "Textures";
+    if (ui.begin_window(textures_window))
     {
         for (uint i = 5; i <= 8; i += 1)
         {
@@ -239,12 +244,14 @@ void Renderer::display_ui(UI::Context &ui)
         ui.end_window();
     }
 
-    if (ui.begin_window("Shaders"))
+    static const StringId shaders_window = "Shaders";
+    if (ui.begin_window(shaders_window))
     {
         ui.end_window();
     }
 
-    if (ui.begin_window("Settings"))
+    static const StringId settings_window = "Settings";
+    if (ui.begin_window(settings_window))
     {
         if (ImGui::CollapsingHeader("Renderer"))
         {
@@ -257,6 +264,8 @@ void Renderer::display_ui(UI::Context &ui)
 
 void Renderer::update(Scene &scene)
 {
+    PROFILE_SCOPE("Renderer::update");
+
     // -- Handle resize
     if (start_frame())
     {
@@ -306,11 +315,9 @@ void Renderer::update(Scene &scene)
     assert(main_camera != nullptr);
     main_camera->projection = camera::infinite_perspective(main_camera->fov, (float)settings.render_resolution.x / settings.render_resolution.y, main_camera->near_plane, &main_camera->projection_inverse);
 
-    // -- Get geometry from the scene and prepare the draw commands
-    render_instances.clear();
-
-    scene.world.for_each<LocalToWorldComponent, RenderMeshComponent>(
-        [&](LocalToWorldComponent &local_to_world_component, RenderMeshComponent &render_mesh_component)
+    // -- Upload the meshes used by the scene, the device is not thread-safe
+    scene.world.for_each<const RenderMeshComponent>(
+        [&](const RenderMeshComponent &render_mesh_component)
         {
             if (render_mesh_component.i_mesh >= this->render_meshes.size())
             {
@@ -318,7 +325,7 @@ void Renderer::update(Scene &scene)
                 {
                     auto &mesh_asset = asset_manager->meshes[i_mesh];
 
-                    logger::info("Uploading mesh asset #{}\n", i_mesh);
+                    logger::debug("Uploading mesh asset #{}\n", i_mesh);
 
                     RenderMesh render_mesh   = {};
                     render_mesh.positions    = device.create_buffer({
@@ -332,7 +339,7 @@ void Renderer::update(Scene &scene)
                         .usage = gfx::storage_buffer_usage,
                     });
                     render_mesh.vertex_count = static_cast<u32>(mesh_asset.indices.size());
-                    render_mesh.submeshes    = mesh_asset.submeshes;
+                    render_mesh.submeshes.assign(mesh_asset.submeshes.begin(), mesh_asset.submeshes.end());
 
                     RenderMeshGPU gpu = {};
                     gpu.positions_descriptor = device.get_buffer_storage_index(render_mesh.positions);
@@ -347,16 +354,30 @@ void Renderer::update(Scene &scene)
                     this->render_meshes.push_back(render_mesh);
                 }
             }
-            else
+        });
+
+    // -- Get geometry from the scene and prepare the draw commands
+    constexpr usize GATHER_GRAIN = 4; // chunks per job
+    render_instances.resize(scene.world.count<const LocalToWorldComponent, const RenderMeshComponent>());
+    scene.world.par_for_each_chunk<const LocalToWorldComponent, const RenderMeshComponent>(GATHER_GRAIN,
+        [&](usize first_index, usize row_count, const LocalToWorldComponent *local_to_worlds, const RenderMeshComponent *render_mesh_components)
+        {
+            for (usize i_row = 0; i_row < row_count; i_row += 1)
             {
-                render_instances.push_back({
-                    .transform     = local_to_world_component.transform,
-                    .i_render_mesh = render_mesh_component.i_mesh,
-                });
+                render_instances[first_index + i_row] = {
+                    .transform     = local_to_worlds[i_row].transform,
+                    .i_render_mesh = render_mesh_components[i_row].i_mesh,
+                    .i_material    = render_mesh_components[i_row].i_material,
+                };
             }
         });
 
-    Vec<u32> instances_to_draw;
+    // -- Sort the draws by material and mesh, then front to back
+    const float3 camera_position = main_camera_transform->position;
+    ArenaVec<u64> draw_keys(&base_renderer.frame_arena());
+    ArenaVec<u32> instances_to_draw(&base_renderer.frame_arena());
+    draw_keys.reserve(render_instances.size());
+    instances_to_draw.reserve(render_instances.size());
     for (u32 i_render_instance = 0; i_render_instance < render_instances.size(); i_render_instance += 1)
     {
         const auto &render_instance = render_instances[i_render_instance];
@@ -365,9 +386,25 @@ void Renderer::update(Scene &scene)
         {
             continue;
         }
+
+        const float4 &translation = render_instance.transform.col(3);
+        const u32 material        = render_instance.i_material == u32_invalid ? (1u << sort_key::MATERIAL_BITS) - 1 : render_instance.i_material;
+        draw_keys.push_back(sort_key::draw({
+            .material = material,
+            .mesh     = render_instance.i_render_mesh,
+            .depth    = (float3(translation.x, translation.y, translation.z) - camera_position).norm(),
+        }));
         instances_to_draw.push_back(i_render_instance);
     }
 
+    {
+        ArenaVec<u64> keys_scratch(&base_renderer.frame_arena());
+        ArenaVec<u32> instances_scratch(&base_renderer.frame_arena());
+        keys_scratch.resize(draw_keys.size());
+        instances_scratch.resize(instances_to_draw.size());
+        radix_sort(draw_keys, instances_to_draw, keys_scratch, instances_scratch);
+    }
+
     auto [p_instances, instance_offset] = instances_data.allocate(device, instances_to_draw.size() * sizeof(RenderInstance));
     auto *p_instances_data              = reinterpret_cast<RenderInstance *>(p_instances);
     for (u32 i_to_draw = 0; i_to_draw < instances_to_draw.size(); i_to_draw += 1)
@@ -438,15 +475,14 @@ void Renderer::update(Scene &scene)
 
     cmd.bind_pipeline(opaque_program, 0);
 
-    uint i_draw = 0;
-    for (auto i_render_instance : instances_to_draw)
+    // the instances were copied in the sorted order
+    for (u32 i_draw = 0; i_draw < instances_to_draw.size(); i_draw += 1)
     {
-        const auto &render_instance = render_instances[i_render_instance];
+        const auto &render_instance = render_instances[instances_to_draw[i_draw]];
         const auto &render_mesh     = render_meshes[render_instance.i_render_mesh];
 
         cmd.push_constant<PushConstants>({.draw_id = i_draw});
-        cmd.draw({.vertex_count = render_mesh.vertex_count, .instance_offset = i_render_instance});
-        i_draw += 1;
+        cmd.draw({.vertex_count = render_mesh.vertex_count, .instance_offset = i_draw});
     }
 
     cmd.end_pass();
@@ -493,7 +529,13 @@ void Renderer::update(Scene &scene)
             VkRect2D scissor;
         };
 
-        Vec<ImguiDrawCommand> draws;
+        ArenaVec<ImguiDrawCommand> draws(&base_renderer.frame_arena());
+        usize draw_count = 0;
+        for (int i = 0; i < data->CmdListsCount; i++)
+        {
+            draw_count += static_cast<usize>(data->CmdLists[i]->CmdBuffer.Size);
+        }
+        draws.reserve(draw_count);
         float2 clip_off   = data->DisplayPos;       // (0,0) unless using multi-viewports
         float2 clip_scale = data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
@@ -84,7 +84,7 @@ struct PACKED RenderInstance
 {
     float4x4 transform;
     u32 i_render_mesh;
-    u32 pad00;
+    u32 i_material;
     u32 pad01;
     u32 pad10;
 };
@@ -17,7 +17,7 @@ struct RingBufferDescription
 
 struct RingBuffer
 {
-    std::string name;
+    StringId name;
     usize size = 0;
     u32 offset = 0;
     u32 usage = 0;
@@ -1,10 +1,25 @@
 #include "render/streamer.h"
 #include "render/vulkan/device.h"
 
+#include <exo/memory_tracker.h>
+#include <exo/profiler.h>
+#include "memory_tags.h"
+
+static constexpr usize STAGING_SIZE    = 64_MiB;
+static constexpr u32 STAGING_ALIGNMENT = 16; // buffer to image copies need offsets aligned to the texel size
+
 void Streamer::init(gfx::Device *_device)
 {
     device = _device;
     transfer_done = device->create_fence();
+
+    staging_buffer = device->create_buffer({
+            .name = "Staging buffer",
+            .size = STAGING_SIZE,
+            .usage = gfx::source_buffer_usage,
+            .memory_usage = VMA_MEMORY_USAGE_CPU_ONLY,
+        });
+    staging_allocator = OffsetAllocator::create(static_cast<u32>(STAGING_SIZE));
 }
 
 void Streamer::wait() const
@@ -19,26 +34,58 @@ void Streamer::wait() const
 void Streamer::destroy()
 {
     device->destroy_fence(transfer_done);
+    device->destroy_buffer(staging_buffer);
+}
+
+// size of the staging memory used by an upload
+static usize staging_memory_size(const Streamer &streamer, const StagingArea &staging)
+{
+    return staging.range.is_valid() ? streamer.staging_allocator.allocation_size(staging.range) : staging.size;
+}
+
+// cpu_memory_usage and the StreamerMemory tag count the same bytes
+static void track_staging(Streamer &streamer, const StagingArea &staging)
+{
+    usize size = staging_memory_size(streamer, staging);
+    streamer.cpu_memory_usage += size;
+    memory_tracker::on_allocate(memory_tracker::tag_index<StreamerMemory>(), size);
+}
+
+static void release_staging(Streamer &streamer, StagingArea &staging)
+{
+    usize size = staging_memory_size(streamer, staging);
+    streamer.cpu_memory_usage -= size;
+    memory_tracker::on_free(memory_tracker::tag_index<StreamerMemory>(), size);
+
+    if (staging.range.is_valid())
+    {
+        streamer.staging_allocator.free(staging.range);
+    }
+    else
+    {
+        streamer.device->destroy_buffer(staging.buffer);
+    }
+    staging = {};
 }
 
 void Streamer::update(gfx::WorkPool &work_pool)
 {
+    PROFILE_SCOPE("Streamer::update");
+
     for (auto &[dst_buffer, upload] : buffer_uploads)
     {
         if (upload.state == UploadState::Uploading && upload.transfer_id < transfer_batch)
         {
-            auto &staging = staging_areas[upload.i_staging];
             upload.state = UploadState::Done;
-            staging.in_use = true;
+            release_staging(*this, upload.staging);
         }
     }
     for (auto &[dst_image, upload] : image_uploads)
     {
         if (upload.state == UploadState::Uploading && upload.transfer_id < transfer_batch)
         {
-            auto &staging = staging_areas[upload.i_staging];
             upload.state = UploadState::Done;
-            staging.in_use = true;
+            release_staging(*this, upload.staging);
         }
     }
 
@@ -53,8 +100,8 @@ void Streamer::update(gfx::WorkPool &work_pool)
     {
         if (upload.state == UploadState::Requested)
         {
-            auto &staging = staging_areas[upload.i_staging];
-            transfer_cmd.copy_buffer(staging.buffer, dst_buffer);
+            auto &staging = upload.staging;
+            transfer_cmd.copy_buffer(staging.buffer, staging.offset, dst_buffer, staging.size);
             upload.state = UploadState::Uploading;
         }
     }
@@ -63,9 +110,9 @@ void Streamer::update(gfx::WorkPool &work_pool)
     {
         if (upload.state == UploadState::Requested)
         {
-            auto &staging = staging_areas[upload.i_staging];
+            auto &staging = upload.staging;
             transfer_cmd.clear_barrier(dst_image, gfx::ImageUsage::TransferDst);
-            transfer_cmd.copy_buffer_to_image(staging.buffer, dst_image);
+            transfer_cmd.copy_buffer_to_image(staging.buffer, dst_image, staging.offset);
             upload.state = UploadState::Uploading;
         }
     }
@@ -76,46 +123,45 @@ void Streamer::update(gfx::WorkPool &work_pool)
     device->submit(transfer_cmd, {transfer_done}, {transfer_batch});
 }
 
-static u32 find_or_create_staging(Streamer &streamer, usize len)
+static StagingArea allocate_staging(Streamer &streamer, usize len)
 {
-    for (u32 i = 0; i < streamer.staging_areas.size(); i += 1)
+    StagingArea staging = {};
+    staging.size = len;
+
+    if (len <= STAGING_SIZE)
     {
-        auto &staging = streamer.staging_areas[i];
-        if (!staging.in_use && staging.size <= len)
-        {
-            staging.in_use = true;
-            return i;
-        }
+        staging.range = streamer.staging_allocator.allocate(static_cast<u32>(len), STAGING_ALIGNMENT);
     }
 
-    auto &device = *streamer.device;
-
-    StagingArea staging;
+    if (staging.range.is_valid())
+    {
+        staging.buffer = streamer.staging_buffer;
+        staging.offset = staging.range.offset;
+        track_staging(streamer, staging);
+        return staging;
+    }
 
-    staging.buffer = device.create_buffer({
-            .name = "Staging buffer",
+    // The staging buffer is full, the upload gets its own buffer
+    staging.buffer = streamer.device->create_buffer({
+            .name = "Dedicated staging buffer",
             .size = len,
             .usage = gfx::source_buffer_usage,
             .memory_usage = VMA_MEMORY_USAGE_CPU_ONLY,
         });
-    staging.in_use = true;
-    staging.size = len;
-
-    streamer.staging_areas.push_back(staging);
-    return static_cast<u32>(streamer.staging_areas.size()) - 1;
+    staging.offset = 0;
+    track_staging(streamer, staging);
+    return staging;
 }
 
 static ResourceUpload upload_resource(Streamer &streamer, const void *data, usize len)
 {
-    u32 i_staging = find_or_create_staging(streamer, len);
-    auto &staging = streamer.staging_areas[i_staging];
+    ResourceUpload upload = {};
+    upload.staging = allocate_staging(streamer, len);
 
     // Copy the source data into the staging
-    void *dst = streamer.device->map_buffer(staging.buffer);
-    std::memcpy(dst, data, len);
+    auto *dst = reinterpret_cast<u8*>(streamer.device->map_buffer(upload.staging.buffer));
+    std::memcpy(dst + upload.staging.offset, data, len);
 
-    ResourceUpload upload = {};
-    upload.i_staging = i_staging;
     upload.transfer_id = streamer.current_transfer;
     upload.state = UploadState::Requested;
 
@@ -1,7 +1,8 @@
 #pragma once
 #include <exo/handle.h>
 #include <exo/collections/vector.h>
-#include <unordered_map>
+#include <exo/map.h>
+#include <exo/offset_allocator.h>
 #include "render/vulkan/commands.h"
 
 namespace vulkan { struct WorkPool;}
@@ -14,22 +15,23 @@ enum struct UploadState
     Done
 };
 
+// CPU Memory staging area: a range of the shared staging buffer, or a dedicated buffer when the upload didn't fit
+struct StagingArea
+{
+    Handle<gfx::Buffer> buffer;
+    OffsetAllocation range;
+    usize offset;
+    usize size;
+};
+
 // Buffer upload request
 struct ResourceUpload
 {
-    u32 i_staging;
+    StagingArea staging;
     u64 transfer_id;
     UploadState state;
 };
 
-// CPU Memory staging area
-struct StagingArea
-{
-    Handle<gfx::Buffer> buffer;
-    usize size;
-    bool in_use;
-};
-
 class Streamer
 {
 public:
@@ -49,9 +51,11 @@ public:
     u64 current_transfer = 0;
     u64 transfer_batch = 0;
 
-    Vec<StagingArea> staging_areas;
-    usize cpu_memory_usage;
+    // uploads are sub-allocated in a single staging buffer and released once the transfer is done
+    Handle<gfx::Buffer> staging_buffer;
+    OffsetAllocator staging_allocator;
+    usize cpu_memory_usage = 0; // bytes of staging memory in use: allocated ranges (with their padding) and dedicated buffers
 
-    std::unordered_map<Handle<gfx::Buffer>, ResourceUpload> buffer_uploads;
-    std::unordered_map<Handle<gfx::Image>, ResourceUpload> image_uploads;
+    Map<Handle<gfx::Buffer>, ResourceUpload> buffer_uploads;
+    Map<Handle<gfx::Image>, ResourceUpload> image_uploads;
 };
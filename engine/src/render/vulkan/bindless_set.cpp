@@ -3,8 +3,37 @@
 #include "render/vulkan/utils.h"
 #include "render/vulkan/device.h"
 
+#include <exo/logger.h>
+
+#if defined(ENABLE_CONCURRENT_RESOURCES)
+#include <atomic>
+#endif
+
 namespace vulkan
 {
+#if defined(ENABLE_CONCURRENT_RESOURCES)
+struct PendingLock
+{
+    explicit PendingLock(BindlessSet &set)
+        : lock{set.pending_lock}
+    {
+        u32 expected = 0;
+        while (!lock.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            expected = 0;
+        }
+    }
+    ~PendingLock() { lock.store(0, std::memory_order_release); }
+
+    std::atomic_ref<u32> lock;
+};
+#else
+struct PendingLock
+{
+    explicit PendingLock(BindlessSet &) {}
+};
+#endif
+
 BindlessSet create_bindless_set(const Device &device, VkDescriptorPool pool, const char *name, DescriptorType type)
 {
     BindlessSet set = {};
@@ -48,7 +77,7 @@ BindlessSet create_bindless_set(const Device &device, VkDescriptorPool pool, con
         VK_CHECK(device.vkSetDebugUtilsObjectNameEXT(device.device, &ni));
     }
 
-    set.free_list = FreeList::create(type.count);
+    set.free_list = decltype(set.free_list)::create(type.count);
     set.descriptors.resize(type.count, {.dynamic = {}});
 
     return set;
@@ -64,34 +93,45 @@ void destroy_bindless_set(const Device &device, BindlessSet &set)
 u32 bind_descriptor(BindlessSet &set, Descriptor desc)
 {
     u32 new_index = set.free_list.allocate();
+    if (new_index == u32_invalid)
+    {
+        logger::error("Bindless set is full ({} descriptors).\n", set.descriptors.size());
+        assert(false);
+        return u32_invalid;
+    }
+
     set.descriptors[new_index] = desc;
+    PendingLock lock{set};
     set.pending_bind.push_back(new_index);
     return new_index;
 }
 
 void unbind_descriptor(BindlessSet &set, u32 index)
 {
+    assert(index != u32_invalid);
     set.descriptors[index].dynamic = {};
     set.free_list.free(index);
+    PendingLock lock{set};
     set.pending_unbind.push_back(index);
 }
 
 void update_bindless_set(Device &device, BindlessSet &set)
 {
+    PendingLock lock{set};
     if (set.pending_bind.empty() && set.pending_unbind.empty())
     {
         return;
     }
 
-    Vec<VkWriteDescriptorSet> writes;
+    ArenaVec<VkWriteDescriptorSet> writes(device.frame_arena);
     writes.reserve(set.pending_bind.size());
 
-    Vec<VkCopyDescriptorSet> copies;
+    ArenaVec<VkCopyDescriptorSet> copies(device.frame_arena);
     copies.reserve(set.pending_unbind.size());
 
     // writes' elements contain pointers to these buffers, so they have to be allocated with the right size
-    Vec<VkDescriptorImageInfo> images_info;
-    Vec<VkDescriptorBufferInfo> buffers_info;
+    ArenaVec<VkDescriptorImageInfo> images_info(device.frame_arena);
+    ArenaVec<VkDescriptorBufferInfo> buffers_info(device.frame_arena);
     if (set.descriptor_type.type == DescriptorType::SampledImage || set.descriptor_type.type == DescriptorType::StorageImage) {
         images_info.reserve(writes.capacity());
     }
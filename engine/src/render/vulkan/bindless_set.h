@@ -1,6 +1,7 @@
 #pragma once
 #include "render/vulkan/descriptor_set.h"
-#include <exo/free_list.h>
+#include <exo/bitset_allocator.h>
+#include <exo/concurrent_free_list.h>
 #include <exo/handle.h>
 
 namespace vulkan
@@ -12,8 +13,13 @@ struct BindlessSet
     VkDescriptorSetLayout layout = VK_NULL_HANDLE;
     VkDescriptorSet set = VK_NULL_HANDLE;
     DescriptorType descriptor_type = {};
-    Vec<Descriptor> descriptors = {};
-    FreeList free_list = {};
+    TaggedVec<DescriptorMemory, Descriptor> descriptors = {};
+#if defined(ENABLE_CONCURRENT_RESOURCES)
+    ConcurrentFreeList free_list = {};
+    u32 pending_lock = 0; // protects the pending lists
+#else
+    BitsetAllocator free_list = {};
+#endif
 
     Vec<u32> pending_bind = {};
     Vec<u32> pending_unbind = {};
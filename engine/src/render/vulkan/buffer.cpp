@@ -79,6 +79,7 @@ void Device::destroy_buffer(Handle<Buffer> buffer_handle)
             buffer->mapped = nullptr;
         }
 
+        if (buffer->descriptor_idx != u32_invalid) { unbind_descriptor(global_sets.storage_buffers, buffer->descriptor_idx); }
         vmaDestroyBuffer(allocator, buffer->vkhandle, buffer->allocation);
         buffers.remove(buffer_handle);
     }
@@ -126,7 +127,9 @@ void Device::flush_buffer(Handle<Buffer> buffer_handle)
 }
 u32 Device::get_buffer_storage_index(Handle<Buffer> buffer_handle)
 {
-    if (auto *buffer = buffers.get(buffer_handle))
+    auto *buffer = buffers.get(buffer_handle);
+    // u32_invalid when the bindless set was full, shaders get the same fallback as a missing buffer
+    if (buffer && buffer->descriptor_idx != u32_invalid)
     {
         return buffer->descriptor_idx;
     }
@@ -7,6 +7,8 @@
 #include "render/vulkan/utils.h"
 #include "vulkan/vulkan_core.h"
 
+#include <exo/profiler.h>
+
 namespace vulkan
 {
 
@@ -210,13 +212,28 @@ void TransferWork::copy_buffer(Handle<Buffer> src, Handle<Buffer> dst)
     vkCmdCopyBuffer(command_buffer, src_buffer.vkhandle, dst_buffer.vkhandle, 1, &copy);
 }
 
-void TransferWork::copy_buffer_to_image(Handle<Buffer> src, Handle<Image> dst)
+void TransferWork::copy_buffer(Handle<Buffer> src, usize src_offset, Handle<Buffer> dst, usize size)
+{
+    auto &src_buffer = *device->buffers.get(src);
+    auto &dst_buffer = *device->buffers.get(dst);
+
+    assert(src_offset + size <= src_buffer.desc.size && size <= dst_buffer.desc.size);
+    VkBufferCopy copy = {
+        .srcOffset = src_offset,
+        .dstOffset = 0,
+        .size      = size,
+    };
+
+    vkCmdCopyBuffer(command_buffer, src_buffer.vkhandle, dst_buffer.vkhandle, 1, &copy);
+}
+
+void TransferWork::copy_buffer_to_image(Handle<Buffer> src, Handle<Image> dst, usize src_offset)
 {
     auto &src_buffer = *device->buffers.get(src);
     auto &dst_image  = *device->images.get(dst);
 
     VkBufferImageCopy region = {};
-    region.bufferOffset = 0;
+    region.bufferOffset = src_offset;
 
     // If either of these values is zero, that aspect of the buffer memory is considered to be tightly packed according to the imageExtent.
     region.bufferRowLength = 0;
@@ -245,10 +262,7 @@ void ComputeWork::bind_pipeline(Handle<ComputeProgram> program_handle)
     auto &program = *device->compute_programs.get(program_handle);
     VkDescriptorSet set = find_or_create_descriptor_set(*device, program.descriptor_set);
 
-    Vec<u32> offsets;
-    offsets.reserve(program.descriptor_set.dynamic_offsets.size());
-    offsets.insert(offsets.end(), program.descriptor_set.dynamic_offsets.begin(), program.descriptor_set.dynamic_offsets.end());
-
+    const auto &offsets = program.descriptor_set.dynamic_offsets;
     vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, program.pipeline_layout, 4, 1, &set, static_cast<u32>(offsets.size()), offsets.data());
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, program.pipeline);
 }
@@ -338,7 +352,7 @@ void GraphicsWork::begin_pass(Handle<RenderPass> renderpass_handle, Handle<Frame
     auto &renderpass = *device->renderpasses.get(renderpass_handle);
     auto &framebuffer = *device->framebuffers.get(framebuffer_handle);
 
-    Vec<VkImageView> views(attachments.size());
+    ArenaVec<VkImageView> views(attachments.size(), VK_NULL_HANDLE, device->frame_arena);
     for (usize i_attachment = 0; i_attachment < attachments.size(); i_attachment++)
     {
         views[i_attachment] = device->images.get(attachments[i_attachment])->full_view.vkhandle;
@@ -372,10 +386,7 @@ void GraphicsWork::bind_pipeline(Handle<GraphicsProgram> program_handle, uint pi
 
     VkDescriptorSet set = find_or_create_descriptor_set(*device, program.descriptor_set);
 
-    Vec<u32> offsets;
-    offsets.reserve(program.descriptor_set.dynamic_offsets.size());
-    offsets.insert(offsets.end(), program.descriptor_set.dynamic_offsets.begin(), program.descriptor_set.dynamic_offsets.end());
-
+    const auto &offsets = program.descriptor_set.dynamic_offsets;
     vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, program.pipeline_layout, 4, 1, &set, static_cast<u32>(offsets.size()), offsets.data());
     vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 }
@@ -542,10 +553,14 @@ void Device::destroy_fence(Fence &fence)
 // Submission
 void Device::submit(Work &work, const Vec<Fence> &signal_fences, const Vec<u64> &signal_values)
 {
+    PROFILE_SCOPE("Device::submit");
+
     // Creathe list of semaphores to wait
-    Vec<VkSemaphore> signal_list;
+    ArenaVec<VkSemaphore> signal_list(frame_arena);
     signal_list.reserve(signal_fences.size() + 1);
-    Vec<u64> local_signal_values = signal_values;
+    ArenaVec<u64> local_signal_values(frame_arena);
+    local_signal_values.reserve(signal_values.size() + 1);
+    local_signal_values.insert(local_signal_values.end(), signal_values.begin(), signal_values.end());
     for (const auto &fence : signal_fences)
     {
         signal_list.push_back(fence.timeline_semaphore);
@@ -557,9 +572,9 @@ void Device::submit(Work &work, const Vec<Fence> &signal_fences, const Vec<u64>
         local_signal_values.push_back(0);
     }
 
-    Vec<VkSemaphore> semaphore_list;
-    Vec<u64> value_list;
-    Vec<VkPipelineStageFlags> stage_list;
+    ArenaVec<VkSemaphore> semaphore_list(frame_arena);
+    ArenaVec<u64> value_list(frame_arena);
+    ArenaVec<VkPipelineStageFlags> stage_list(frame_arena);
 
     semaphore_list.reserve(work.wait_fence_list.size() + 1);
     value_list.reserve(work.wait_fence_list.size() + 1);
@@ -637,7 +652,7 @@ void Device::wait_for_fences(const Vec<Fence> &fences, const Vec<u64> &wait_valu
 {
     assert(wait_values.size() == fences.size());
 
-    Vec<VkSemaphore> semaphores(fences.size());
+    ArenaVec<VkSemaphore> semaphores(fences.size(), VK_NULL_HANDLE, frame_arena);
     for (usize i_fence = 0; i_fence < fences.size(); i_fence += 1)
     {
         semaphores[i_fence] = fences[i_fence].timeline_semaphore;
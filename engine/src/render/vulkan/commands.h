@@ -2,6 +2,7 @@
 #include <exo/algorithms.h>
 #include <exo/handle.h>
 #include <exo/collections/vector.h>
+#include <exo/collections/small_vector.h>
 #include "render/vulkan/resources.h"
 #include "vulkan/vulkan_core.h"
 
@@ -48,9 +49,9 @@ struct Work
     Device *device;
 
     VkCommandBuffer command_buffer;
-    Vec<Fence> wait_fence_list;
-    Vec<u64> wait_value_list;
-    Vec<VkPipelineStageFlags> wait_stage_list;
+    SmallVec<Fence, 2> wait_fence_list;
+    SmallVec<u64, 2> wait_value_list;
+    SmallVec<VkPipelineStageFlags, 2> wait_stage_list;
     VkQueue queue;
     QueueType queue_type;
 
@@ -86,7 +87,8 @@ struct TransferWork : Work
 {
     void copy_buffer(Handle<Buffer> src, Handle<Buffer> dst, Vec<std::pair<u32, u32>> offsets_sizes);
     void copy_buffer(Handle<Buffer> src, Handle<Buffer> dst);
-    void copy_buffer_to_image(Handle<Buffer> src, Handle<Image> dst);
+    void copy_buffer(Handle<Buffer> src, usize src_offset, Handle<Buffer> dst, usize size);
+    void copy_buffer_to_image(Handle<Buffer> src, Handle<Image> dst, usize src_offset = 0);
     void fill_buffer(Handle<Buffer> buffer_handle, u32 data);
     void transfer();
 };
@@ -9,7 +9,7 @@
 
 namespace vulkan
 {
-DescriptorSet create_descriptor_set(Device &device, const Vec<DescriptorType> &descriptors)
+DescriptorSet create_descriptor_set(Device &device, const DescriptorTypes &descriptors)
 {
     DescriptorSet descriptor_set = {};
 
@@ -36,8 +36,7 @@ DescriptorSet create_descriptor_set(Device &device, const Vec<DescriptorType> &d
 
     descriptor_set.dynamic_offsets.resize(descriptor_set.dynamic_descriptors.size());
 
-    Descriptor empty = {{{}}};
-    descriptor_set.descriptors.resize(descriptors.size(), empty);
+    descriptor_set.descriptors.resize(descriptors.size(), Descriptor{});
 
     VkDescriptorSetLayoutCreateInfo desc_layout_info = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
     desc_layout_info.bindingCount = static_cast<u32>(bindings.size());
@@ -93,17 +92,13 @@ void bind_storage_buffer(DescriptorSet &set, u32 slot, Handle<Buffer> buffer_han
 
 VkDescriptorSet find_or_create_descriptor_set(Device &device, DescriptorSet &set)
 {
-    auto hash = hash_value(set.descriptors);
-
-    for (usize i = 0; i < set.hashes.size(); i++)
+    auto cached = set.vkhandle_indices.find(set.descriptors);
+    if (cached != set.vkhandle_indices.end())
     {
-        if (hash == set.hashes[i])
-        {
-            return set.vkhandles[i];
-        }
+        return set.vkhandles[cached->second];
     }
 
-    set.hashes.push_back(hash);
+    set.vkhandle_indices.insert({set.descriptors, static_cast<u32>(set.vkhandles.size())});
 
     VkDescriptorSetAllocateInfo set_info = {.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
     set_info.descriptorPool              = device.descriptor_pool;
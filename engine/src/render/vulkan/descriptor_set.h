@@ -1,7 +1,12 @@
 #pragma once
 #include <exo/hash.h>
+#include <exo/map.h>
 #include <exo/collections/vector.h>
+#include <exo/collections/small_vector.h>
 #include <exo/handle.h>
+#include <exo/memory_tracker.h>
+
+#include "memory_tags.h"
 
 #include <vulkan/vulkan.h>
 
@@ -48,6 +53,9 @@ struct DescriptorType
     };
 };
 
+// Descriptor types of a program's set, they rarely go past a handful
+using DescriptorTypes = SmallVec<DescriptorType, 8>;
+
 struct Descriptor
 {
     union
@@ -56,31 +64,54 @@ struct Descriptor
         BufferDescriptor buffer;
         DynamicDescriptor dynamic;
 
-        // for std::hash
+        // for std::hash, a default Descriptor is all zeroes so that the bytes not covered by image or buffer are equal
         struct {
             u64 one;
             u64 two;
             u64 three;
-        } raw;
+        } raw = {};
     };
 };
 
+// the offset of a dynamic buffer is not part of the descriptor set, it is given when binding the set
+inline bool operator==(const Descriptor &a, const Descriptor &b)
+{
+    return a.raw.one == b.raw.one && a.raw.two == b.raw.two;
+}
+} // namespace vulkan
+
+namespace std
+{
+    template<>
+    struct hash<vulkan::Descriptor>
+    {
+        std::size_t operator()(vulkan::Descriptor const& descriptor) const noexcept
+        {
+            // same bytes as operator==
+            u64 handle_and_size[2] = {descriptor.raw.one, descriptor.raw.two};
+            return hash_struct(handle_and_size);
+        }
+    };
+}
+
+namespace vulkan
+{
 struct DescriptorSet
 {
     VkDescriptorSetLayout layout;
-    Vec<Descriptor> descriptors;
-    Vec<DescriptorType> descriptor_desc;
+    TaggedVec<DescriptorMemory, Descriptor> descriptors;
+    DescriptorTypes descriptor_desc;
 
-    // linear map
-    Vec<VkDescriptorSet> vkhandles;
-    Vec<usize> hashes;
+    // descriptors -> index in vkhandles
+    TaggedVec<DescriptorMemory, VkDescriptorSet> vkhandles;
+    Map<TaggedVec<DescriptorMemory, Descriptor>, u32> vkhandle_indices;
 
     // dynamic offsets
     Vec<usize> dynamic_descriptors;
     Vec<u32> dynamic_offsets;
 };
 
-DescriptorSet create_descriptor_set(Device &device, const Vec<DescriptorType> &descriptors);
+DescriptorSet create_descriptor_set(Device &device, const DescriptorTypes &descriptors);
 void destroy_descriptor_set(Device &device, DescriptorSet &set);
 
 void bind_uniform_buffer(DescriptorSet &set, u32 slot, Handle<Buffer> buffer_handle, u32 offset, usize size);
@@ -89,16 +120,3 @@ void bind_image(DescriptorSet &set, u32 slot, Handle<Image> image_handle);
 
 VkDescriptorSet find_or_create_descriptor_set(Device &device, DescriptorSet &set);
 }
-
-namespace std
-{
-    template<>
-    struct hash<vulkan::Descriptor>
-    {
-        std::size_t operator()(vulkan::Descriptor const& descriptor) const noexcept
-        {
-            usize hash = descriptor.raw.one;
-            return hash;
-        }
-    };
-}
@@ -1,9 +1,11 @@
 #pragma once
 #include <exo/algorithms.h>
 #include <exo/types.h>
+#include <exo/arena.h>
 #include <exo/option.h>
 #include <exo/collections/vector.h>
-#include <exo/collections/pool.h>
+#include <exo/collections/packed_pool.h>
+#include <exo/collections/concurrent_pool.h>
 
 #include "render/vulkan/context.h"
 #include "render/vulkan/commands.h"
@@ -37,6 +39,13 @@ struct GlobalDescriptorSets
     BindlessSet storage_buffers;
 };
 
+// Define ENABLE_CONCURRENT_RESOURCES to create and destroy images and buffers from multiple threads
+#if defined(ENABLE_CONCURRENT_RESOURCES)
+template <typename T> using ResourcePool = ConcurrentPool<T>;
+#else
+template <typename T> using ResourcePool = PackedPool<T>;
+#endif
+
 struct PushConstantLayout
 {
     usize size;
@@ -63,15 +72,18 @@ struct Device
     PushConstantLayout push_constant_layout;
     GlobalDescriptorSets global_sets;
 
-    Pool<Shader> shaders;
-    Pool<GraphicsProgram> graphics_programs;
-    Pool<ComputeProgram> compute_programs;
-    Pool<RenderPass> renderpasses;
-    Pool<Framebuffer> framebuffers;
-    Pool<Image> images;
-    Pool<Buffer> buffers;
+    PackedPool<Shader> shaders;
+    PackedPool<GraphicsProgram> graphics_programs;
+    PackedPool<ComputeProgram> compute_programs;
+    PackedPool<RenderPass> renderpasses;
+    PackedPool<Framebuffer> framebuffers;
+    ResourcePool<Image> images;
+    ResourcePool<Buffer> buffers;
     Vec<VkSampler> samplers;
 
+    // Scratch memory for temporaries that live until the end of the frame, set by the renderer each frame (heap if null)
+    Arena *frame_arena = nullptr;
+
     /// ---
 
     static Device create(const Context &context, const DeviceDescription &desc);
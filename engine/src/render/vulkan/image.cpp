@@ -7,12 +7,12 @@
 namespace vulkan
 {
 
-static ImageView create_image_view(Device &device, VkImage vkhandle, std::string &&name, VkImageSubresourceRange &range, VkFormat format, VkImageViewType type)
+static ImageView create_image_view(Device &device, VkImage vkhandle, StringId name, std::string_view view_label, VkImageSubresourceRange &range, VkFormat format, VkImageViewType type)
 {
     ImageView view;
 
     view.vkhandle = VK_NULL_HANDLE;
-    view.name = std::move(name);
+    view.name = name;
     view.range = range;
 
     VkImageViewCreateInfo vci = {.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
@@ -33,12 +33,12 @@ static ImageView create_image_view(Device &device, VkImage vkhandle, std::string
         VkDebugUtilsObjectNameInfoEXT ni = {.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT};
         ni.objectHandle                  = reinterpret_cast<u64>(view.vkhandle);
         ni.objectType                    = VK_OBJECT_TYPE_IMAGE_VIEW;
-        ni.pObjectName                   = view.name.c_str();
+        // the label is only formatted for the debugger, it is not interned
+        auto object_name                 = fmt::format("{} {}", view.name.view(), view_label);
+        ni.pObjectName                   = object_name.c_str();
         VK_CHECK(device.vkSetDebugUtilsObjectNameEXT(device.device, &ni));
     }
 
-    view.sampled_idx = 0;
-
     return view;
 }
 
@@ -104,7 +104,7 @@ Handle<Image> Device::create_image(const ImageDescription &image_desc, Option<Vk
     full_range.layerCount     = image_info.arrayLayers;
     VkFormat format = image_desc.format;
 
-    ImageView full_view = create_image_view(*this, vkhandle, fmt::format("{} full view", image_desc.name), full_range, format, view_type_from_image(image_desc.type));
+    ImageView full_view = create_image_view(*this, vkhandle, image_desc.name, "full view", full_range, format, view_type_from_image(image_desc.type));
 
     auto handle = images.add({
             .desc = image_desc,
@@ -157,7 +157,9 @@ uint3 Device::get_image_size(Handle<Image> image_handle)
 
 u32 Device::get_image_sampled_index(Handle<Image> image_handle)
 {
-    if (auto *image = images.get(image_handle))
+    auto *image = images.get(image_handle);
+    // u32_invalid when the bindless set was full, shaders get the same fallback as a missing image
+    if (image && image->full_view.sampled_idx != u32_invalid)
     {
         return image->full_view.sampled_idx;
     }
@@ -166,7 +168,9 @@ u32 Device::get_image_sampled_index(Handle<Image> image_handle)
 
 u32 Device::get_image_storage_index(Handle<Image> image_handle)
 {
-    if (auto *image = images.get(image_handle))
+    auto *image = images.get(image_handle);
+    // u32_invalid when the bindless set was full, shaders get the same fallback as a missing image
+    if (image && image->full_view.storage_idx != u32_invalid)
     {
         return image->full_view.storage_idx;
     }
@@ -3,8 +3,10 @@
 
 #include <exo/types.h>
 #include <exo/collections/vector.h>
+#include <exo/collections/array_vector.h>
 #include <exo/option.h>
 #include <exo/handle.h>
+#include <exo/string_interner.h>
 
 #include "render/vulkan/operators.h"
 #include "render/vulkan/descriptor_set.h"
@@ -37,6 +39,9 @@ struct ImageAccess
     QueueType queue            = QueueType::Graphics;
 };
 
+// interned once, descriptions are default-constructed every frame
+inline const StringId default_resource_name = "No name";
+
 enum struct ImageUsage
 {
     None,
@@ -53,7 +58,7 @@ enum struct ImageUsage
 
 struct ImageDescription
 {
-    std::string name = "No name";
+    StringId name = default_resource_name;
     uint3 size                          = {1, 1, 1};
     VkImageType type                    = VK_IMAGE_TYPE_2D;
     VkFormat format                     = VK_FORMAT_R8G8B8A8_UNORM;
@@ -70,7 +75,7 @@ struct ImageView
     u32 sampled_idx = u32_invalid;
     u32 storage_idx = u32_invalid;
     VkFormat format;
-    std::string name;
+    StringId name;
 
     bool operator==(const ImageView &b) const = default;
 };
@@ -112,7 +117,7 @@ struct BufferAccess
 
 struct BufferDescription
 {
-    std::string name = "No name";
+    StringId name = default_resource_name;
     usize size                  = 1;
     VkBufferUsageFlags usage    = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
     VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -135,7 +140,7 @@ struct Buffer
 
 struct Shader
 {
-    std::string filename;
+    StringId filename;
     VkShaderModule vkhandle;
     Vec<u8> bytecode;
     bool operator==(const Shader &other) const = default;
@@ -180,12 +185,14 @@ struct RenderState
     bool operator==(const RenderState &) const = default;
 };
 
+inline constexpr usize MAX_COLOR_ATTACHMENTS = 8;
+
 struct FramebufferDescription
 {
     u32 width = 0;
     u32 height = 0;
     u32 layer_count = 1;
-    Vec<VkFormat> attachments_format;
+    ArrayVec<VkFormat, MAX_COLOR_ATTACHMENTS> attachments_format;
     Option<VkFormat> depth_format;
     bool operator==(const FramebufferDescription &) const = default;
 };
@@ -208,7 +215,7 @@ struct RenderAttachment
 
 struct RenderAttachments
 {
-    Vec<RenderAttachment> colors;
+    ArrayVec<RenderAttachment, MAX_COLOR_ATTACHMENTS> colors;
     Option<RenderAttachment> depth;
     bool operator==(const RenderAttachments &) const = default;
 };
@@ -225,12 +232,12 @@ struct GraphicsState
     Handle<Shader> vertex_shader;
     Handle<Shader> fragment_shader;
     Handle<RenderPass> renderpass;
-    Vec<DescriptorType> descriptors;
+    DescriptorTypes descriptors;
 };
 
 struct GraphicsProgram
 {
-    std::string name;
+    StringId name;
     // state to compile the pipeline
     GraphicsState graphics_state;
     Vec<RenderState> render_states;
@@ -247,12 +254,12 @@ struct GraphicsProgram
 struct ComputeState
 {
     Handle<Shader> shader;
-    Vec<DescriptorType> descriptors;
+    DescriptorTypes descriptors;
 };
 
 struct ComputeProgram
 {
-    std::string name;
+    StringId name;
     ComputeState state;
     VkPipeline pipeline;
     VkPipelineLayout pipeline_layout;
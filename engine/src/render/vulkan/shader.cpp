@@ -47,7 +47,7 @@ Handle<Shader> Device::create_shader(std::string_view path)
     VK_CHECK(vkCreateShaderModule(device, &info, nullptr, &vkhandle));
 
     return shaders.add({
-            .filename = std::string(path),
+            .filename = path,
             .vkhandle = vkhandle,
             .bytecode = std::move(bytecode),
         });
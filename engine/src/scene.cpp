@@ -122,21 +122,24 @@ void Scene::init(AssetManager *_asset_manager)
     main_camera = world.create_entity(std::string_view{"Camera"}, TransformComponent{}, CameraComponent{}, InputCameraComponent{});
     world.singleton_add_component(SkyAtmosphereComponent{});
     asset_manager = _asset_manager;
+
+    init_systems();
 }
 
 void Scene::destroy()
 {
 }
 
-void Scene::update(const Inputs &inputs)
+void Scene::init_systems()
 {
     constexpr float CAMERA_MOVE_SPEED   = 5.0f;
     constexpr float CAMERA_ROTATE_SPEED = 80.0f;
     constexpr float CAMERA_SCROLL_SPEED = 80.0f;
 
     // InputCamera inputs
-    world.for_each<TransformComponent, InputCameraComponent>([&](const auto &transform, auto &input_camera) {
+    world.add_system<const TransformComponent, InputCameraComponent>("camera inputs", [this](const auto &transform, auto &input_camera) {
         using States = InputCameraComponent::States;
+        const Inputs &inputs = *current_inputs;
 
         float delta_t      = 0.016f;
         bool camera_active = inputs.is_pressed(Action::CameraModifier);
@@ -251,7 +254,7 @@ void Scene::update(const Inputs &inputs)
     });
 
     // Apply Input camera to Transform system
-    world.for_each<TransformComponent, InputCameraComponent>([&](auto &transform, const auto &input_camera) {
+    world.add_system<TransformComponent, const InputCameraComponent>("camera transform", [](auto &transform, const auto &input_camera) {
 
         auto r         = input_camera.r;
         auto theta_rad = to_radians(input_camera.theta);
@@ -274,14 +277,19 @@ void Scene::update(const Inputs &inputs)
     });
 
     // Update view matrix system
-    world.for_each<TransformComponent, CameraComponent, InputCameraComponent>([](const auto &transform,
-                                                                               auto &camera,
-                                                                               const auto &input_camera) {
+    world.add_system<const TransformComponent, CameraComponent, const InputCameraComponent>("camera view", [](const auto &transform, auto &camera, const auto &input_camera) {
         camera.view = camera::look_at(transform.position, input_camera.target, float3_UP, &camera.view_inverse);
         // projection will be updated in the renderer
     });
 }
 
+void Scene::update(const Inputs &inputs)
+{
+    current_inputs = &inputs;
+    world.run_systems();
+    current_inputs = nullptr;
+}
+
 void Scene::display_ui(UI::Context &ui)
 {
     draw_gizmo(world, main_camera);
@@ -301,7 +309,8 @@ void Scene::display_ui(UI::Context &ui)
         }
     };
 
-    if (ui.begin_window("Scene"))
+    static const StringId scene_window = "Scene";
+    if (ui.begin_window(scene_window))
     {
 
         if (ImGui::Button("Load scene"))
@@ -331,7 +340,7 @@ void Scene::display_ui(UI::Context &ui)
             const char *tag = "";
             if (const auto *internal_id = world.get_component<ECS::InternalId>(entity))
             {
-                tag = internal_id->tag;
+                tag = internal_id->tag.c_str();
             }
 
             auto formatted_name = fmt::format("{}##{}", tag, entity.raw);
@@ -345,14 +354,15 @@ void Scene::display_ui(UI::Context &ui)
         ui.end_window();
     }
 
-    if (ui.begin_window("Inspector"))
+    static const StringId inspector_window = "Inspector";
+    if (ui.begin_window(inspector_window))
     {
         if (selected_entity)
         {
             const char *tag = "<No name>";
             if (const auto *internal_id = world.get_component<ECS::InternalId>(*selected_entity))
             {
-                tag = internal_id->tag;
+                tag = internal_id->tag.c_str();
             }
             ImGui::Text("Selected: %s", tag);
 
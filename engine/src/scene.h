@@ -19,8 +19,13 @@ public:
 
     void display_ui(UI::Context &ui);
 
+    // The systems that update the scene every frame
+    void init_systems();
+
     AssetManager *asset_manager;
     ECS::World world;
     ECS::EntityId main_camera;
     Vec<ECS::EntityId> meshes_entities;
+    // inputs of the update that is running, read by the systems
+    const Inputs *current_inputs = nullptr;
 };
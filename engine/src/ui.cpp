@@ -190,17 +190,14 @@ void Context::display_ui()
     }
 }
 
-bool Context::begin_window(std::string_view name, bool is_visible, ImGuiWindowFlags /*flags*/)
+bool Context::begin_window(StringId id, bool is_visible, ImGuiWindowFlags /*flags*/)
 {
-    if (!windows.contains(name))
-    {
-        windows[name] = {.name = std::string(name), .is_visible = is_visible};
-    }
+    auto [it, inserted] = windows.try_emplace(id, Window{.name = id, .is_visible = is_visible});
 
-    auto &window = windows.at(name);
+    auto &window = it->second;
     if (window.is_visible)
     {
-        ImGui::Begin(name.data(), &window.is_visible, 0);
+        ImGui::Begin(id.c_str(), &window.is_visible, 0);
         return true;
     }
 
@@ -1,10 +1,11 @@
 #pragma once
 #include <exo/types.h>
+#include <exo/map.h>
+#include <exo/string_interner.h>
 
 #include <imgui/imgui.h>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 
 namespace platform { struct Window; }
 
@@ -14,8 +15,8 @@ namespace UI
 
 struct Window
 {
-    std::string name                = "no-name";
-    bool is_visible                 = true;
+    StringId name   = {};
+    bool is_visible = true;
 };
 
 struct Context
@@ -27,9 +28,11 @@ struct Context
     void display_ui();
     void on_mouse_movement(platform::Window &window, double xpos, double ypos);
 
-    bool begin_window(std::string_view name, bool is_visible = true, ImGuiWindowFlags flags = 0);
+    // interning takes the global lock, the call sites keep their window id in a static
+    bool begin_window(StringId id, bool is_visible = true, ImGuiWindowFlags flags = 0);
+    bool begin_window(const char *name, bool is_visible = true, ImGuiWindowFlags flags = 0) = delete;
     void end_window();
 
-    std::unordered_map<std::string_view, Window> windows;
+    Map<StringId, Window> windows;
 };
 } // namespace UI
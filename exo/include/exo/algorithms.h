@@ -1,8 +1,8 @@
 #pragma once
 #include "exo/numerics.h"
+#include "exo/jobs.h"
 
 #include <algorithm>
-#include <execution>
 #include <iterator>
 
 
@@ -40,7 +40,8 @@ inline void map_transform(const S &src, D &dst, L lambda)
 template <typename S, typename L>
 inline void parallel_foreach(S &container, L lambda)
 {
-    std::for_each(std::execution::par_unseq, std::begin(container), std::end(container), lambda);
+    auto first = std::begin(container);
+    jobs::parallel_for(static_cast<usize>(std::size(container)), [&](usize i) { lambda(first[i]); });
 }
 
 #else
@@ -53,7 +54,8 @@ inline void map_transform(const auto &src, auto &dst, auto lambda)
 
 inline void parallel_foreach(auto &container, auto lambda)
 {
-    std::for_each(std::execution::par_unseq, std::begin(container), std::end(container), lambda);
+    auto first = std::begin(container);
+    jobs::parallel_for(static_cast<usize>(std::size(container)), [&](usize i) { lambda(first[i]); });
 }
 
 #endif
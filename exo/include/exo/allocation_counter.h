@@ -0,0 +1,11 @@
+#pragma once
+#include "exo/numerics.h"
+
+// Counts the calls to the global operator new, only in debug builds (always returns 0 when NDEBUG is defined).
+// The renderer reports the number of heap allocations per frame with it.
+// The replacement of new and delete can be turned off with the EXO_COUNT_HEAP_ALLOCATIONS CMake option, for example
+// when another allocator or a sanitizer has to own them, heap_allocations() then always returns 0.
+namespace allocation_counter
+{
+u64 heap_allocations();
+}
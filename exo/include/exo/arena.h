@@ -0,0 +1,63 @@
+#pragma once
+#include "exo/numerics.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+   An Arena is a linear allocator: allocating bumps an offset and everything is freed at once with reset().
+   When the block is full, allocations fall back to the heap and the block grows to fit them on the next reset(),
+   so a workload that is the same every frame stops allocating after the first frames.
+   Like FreeList, the struct is trivially copyable and has to be destroyed explicitly.
+ **/
+struct Arena
+{
+    static Arena create(usize capacity);
+    void destroy();
+
+    void *allocate(usize size, usize alignment = alignof(std::max_align_t));
+    void reset();
+
+    u8 *base        = nullptr;
+    usize offset    = 0;
+    usize capacity  = 0;
+
+    // heap blocks used when the arena was full, freed on reset()
+    void *overflow_blocks = nullptr;
+    usize overflow_size   = 0;
+};
+
+/// --- Allocator adapter to use an Arena with std containers, deallocate does nothing
+// An allocator without arena uses the heap.
+template <typename T> struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    ArenaAllocator(Arena *_arena) : arena{_arena} {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena{other.arena} {}
+
+    T *allocate(usize n)
+    {
+        if (arena)
+        {
+            return reinterpret_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *ptr, usize n)
+    {
+        if (!arena)
+        {
+            std::allocator<T>{}.deallocate(ptr, n);
+        }
+    }
+
+    template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+    Arena *arena = nullptr;
+};
+
+template <typename T> using ArenaVec = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,25 @@
+#pragma once
+#include "exo/vectors.h"
+
+#include <span>
+
+/**
+   Batch versions of the per-instance transform maths, they work on structure-of-arrays inputs.
+   compose_trs() computes 4 matrices at a time: the translations, quaternions and scales of 4 elements are
+   transposed into SIMD lanes, and the results are transposed back into columns.
+   multiply_many() and transform_points() keep the matrix columns in registers for the whole batch,
+   with AVX two columns (or two points) are computed per instruction.
+   The results are the same as the per-element float4x4 operators.
+ **/
+
+// out[i] = translation(translations[i]) * rotation(rotations[i]) * scale(scales[i]), rotations are quaternions (x, y, z, w)
+void compose_trs(std::span<const float3> translations, std::span<const float4> rotations, std::span<const float3> scales, std::span<float4x4> out);
+
+// matrices[i] = parent * matrices[i]
+void multiply_many(const float4x4 &parent, std::span<float4x4> matrices);
+
+// out[i] = (matrix * float4(points[i], 1.0)).xyz
+void transform_points(const float4x4 &matrix, std::span<const float3> points, std::span<float3> out);
+
+// out[i] = (matrices[i] * float4(points[i], 1.0)).xyz
+void transform_points(std::span<const float4x4> matrices, std::span<const float3> points, std::span<float3> out);
@@ -0,0 +1,41 @@
+#pragma once
+#include "exo/numerics.h"
+
+/**
+   A BitsetAllocator hands out u32 indices like a FreeList, but it can grow and allocate contiguous ranges.
+   Free indices are the set bits of a bitset, and a second level has one bit per 64-bit word that still
+   contains a free index: finding a free index is two find-first-set (std::countr_zero).
+   Performance:
+     allocate() and free() are O(1) amortized, the summary level is scanned from the lowest word that can be free.
+     allocate_range() is O(capacity / 64) in the worst case.
+   Growing keeps every allocated index, the lowest free indices are always allocated first.
+   Like FreeList, the struct is trivially copyable and has to be destroyed explicitly.
+ **/
+class BitsetAllocator
+{
+public:
+    static BitsetAllocator create(u32 capacity);
+    void destroy();
+
+    // returns u32_invalid when every index is allocated
+    u32 allocate();
+    void free(u32 index);
+
+    // returns the first index of `count` contiguous indices, or u32_invalid when there is no such range
+    u32 allocate_range(u32 count);
+    void free_range(u32 first, u32 count);
+
+    // new indices are free, allocated indices stay valid
+    void grow(u32 new_capacity);
+
+    bool is_free(u32 index) const;
+    inline u32 get_capacity() const { return capacity; }
+
+private:
+    void set_range(u32 first, u32 count, bool free);
+
+    u64 *words   = nullptr; // bit i is set when index i is free
+    u64 *summary = nullptr; // bit i is set when words[i] has a free index
+    u32 capacity = 0;
+    u32 first_summary = 0; // no free index before summary[first_summary]
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "exo/numerics.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+   An ArrayVec is a vector with a fixed capacity and inline storage, it never allocates.
+   Pushing more than N elements is an error.
+ **/
+
+/// --- Fixed capacity vector
+template <typename T, usize N> class ArrayVec
+{
+    static_assert(N > 0);
+
+  public:
+    using value_type     = T;
+    using iterator       = T *;
+    using const_iterator = const T *;
+
+    ArrayVec() = default;
+
+    ArrayVec(std::initializer_list<T> list)
+    {
+        assert(list.size() <= N);
+        for (const auto &value : list)
+        {
+            push_back(value);
+        }
+    }
+
+    explicit ArrayVec(usize count, const T &value = {})
+    {
+        resize(count, value);
+    }
+
+    ArrayVec(const ArrayVec &other)
+    {
+        for (const auto &value : other)
+        {
+            push_back(value);
+        }
+    }
+
+    ArrayVec(ArrayVec &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        for (auto &value : other)
+        {
+            push_back(std::move(value));
+        }
+        other.clear();
+    }
+
+    ArrayVec &operator=(const ArrayVec &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            for (const auto &value : other)
+            {
+                push_back(value);
+            }
+        }
+        return *this;
+    }
+
+    ArrayVec &operator=(ArrayVec &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            for (auto &value : other)
+            {
+                push_back(std::move(value));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~ArrayVec()
+    {
+        clear();
+    }
+
+    template <typename... Args> T &emplace_back(Args &&...args)
+    {
+        assert(length < N);
+        T *value = new (data() + length) T(std::forward<Args>(args)...);
+        length += 1;
+        return *value;
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        assert(length > 0);
+        length -= 1;
+        data()[length].~T();
+    }
+
+    void resize(usize new_length, const T &value = {})
+    {
+        assert(new_length <= N);
+        while (length > new_length)
+        {
+            pop_back();
+        }
+        while (length < new_length)
+        {
+            push_back(value);
+        }
+    }
+
+    void clear()
+    {
+        while (length > 0)
+        {
+            pop_back();
+        }
+    }
+
+    // ArrayVec has a fixed capacity, reserve only checks that it is big enough
+    void reserve(usize new_capacity) { assert(new_capacity <= N); (void)new_capacity; }
+
+    T &operator[](usize i) { assert(i < length); return data()[i]; }
+    const T &operator[](usize i) const { assert(i < length); return data()[i]; }
+
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[length - 1]; }
+    const T &back() const { return (*this)[length - 1]; }
+
+    T *data() { return reinterpret_cast<T *>(storage); }
+    const T *data() const { return reinterpret_cast<const T *>(storage); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + length; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + length; }
+
+    usize size() const { return length; }
+    bool empty() const { return length == 0; }
+    static constexpr usize capacity() { return N; }
+
+    bool operator==(const ArrayVec &other) const
+    {
+        if (length != other.length)
+        {
+            return false;
+        }
+        for (usize i = 0; i < length; i += 1)
+        {
+            if (!(data()[i] == other.data()[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    alignas(T) u8 storage[N * sizeof(T)];
+    u32 length = 0;
+};
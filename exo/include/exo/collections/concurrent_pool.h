@@ -0,0 +1,300 @@
+#pragma once
+
+#include "exo/types.h"
+#include "exo/handle.h"
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+/**
+   A ConcurrentPool is a Pool that can be used from multiple threads without locks.
+   Performance:
+     Adding/removing elements is O(1) and lock-free.
+     Iterating is O(capacity) and is NOT thread-safe, it must not run concurrently with add/remove.
+
+   Values are stored in fixed size chunks that are never moved, pointers are only invalidated by remove().
+   A new chunk is allocated by the first thread that needs it, racing threads free their copy.
+
+   Handle is (index, gen) packed in a single integer, the generation lives in the slot.
+   Free slots are linked in a lock-free stack, the head is (u32 tag, u32 index) to avoid the ABA problem.
+ **/
+
+/// --- Concurrent pool allocator
+template <typename T, u32 chunk_size = 1024, u32 max_chunks = 1024> class ConcurrentPool
+{
+    using handle_type = Handle<T>;
+
+    struct Slot
+    {
+        alignas(T) u8 storage[sizeof(T)];
+        u32 gen       = 0;
+        u32 next_free = u32_invalid;
+        u32 alive     = 0;
+    };
+
+    template <typename Pool, typename Value> class IteratorBase
+    {
+      public:
+        using difference_type   = int;
+        using value_type        = std::pair<handle_type, Value *>;
+        using pointer           = value_type *;
+        using reference         = value_type &;
+        using iterator_category = std::input_iterator_tag;
+
+        IteratorBase() = default;
+        IteratorBase(Pool &_pool, u32 _index)
+            : pool{&_pool}
+            , current_index{_index}
+        {
+            skip_dead();
+        }
+
+        bool operator==(const IteratorBase &rhs) const
+        {
+            return current_index == rhs.current_index;
+        }
+
+        reference operator*()
+        {
+            assert(this->pool && current_index < this->pool->slot_count());
+            auto &slot = this->pool->get_slot(current_index);
+            value      = std::make_pair(handle_type(current_index, slot.gen), reinterpret_cast<Value *>(&slot.storage));
+            return value;
+        }
+
+        IteratorBase &operator++()
+        {
+            assert(this->pool);
+            current_index++;
+            skip_dead();
+            return *this;
+        }
+
+      private:
+        void skip_dead()
+        {
+            u32 end = pool->slot_count();
+            for (; current_index < end && !pool->get_slot(current_index).alive; current_index++)
+            {
+            }
+        }
+
+        Pool *pool        = nullptr;
+        u32 current_index = 0;
+        value_type value  = {};
+    };
+
+    using Iterator      = IteratorBase<ConcurrentPool, T>;
+    using ConstIterator = IteratorBase<const ConcurrentPool, const T>;
+
+    static constexpr u32 capacity = chunk_size * max_chunks;
+
+    Slot &get_slot(u32 index) const
+    {
+        Slot *chunk = std::atomic_ref<Slot *>{const_cast<Slot *&>(chunks[index / chunk_size])}.load(std::memory_order_acquire);
+        assert(chunk);
+        return chunk[index % chunk_size];
+    }
+
+    u32 slot_count() const
+    {
+        u32 count = std::atomic_ref<u32>{const_cast<u32 &>(next_slot)}.load(std::memory_order_acquire);
+        return count < capacity ? count : capacity;
+    }
+
+    void ensure_chunk(u32 i_chunk)
+    {
+        std::atomic_ref<Slot *> chunk{chunks[i_chunk]};
+        if (chunk.load(std::memory_order_acquire) != nullptr)
+        {
+            return;
+        }
+
+        Slot *new_chunk = new Slot[chunk_size]();
+        Slot *expected  = nullptr;
+        if (!chunk.compare_exchange_strong(expected, new_chunk, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            delete[] new_chunk;
+        }
+    }
+
+    u32 allocate_slot()
+    {
+        // Pop the free list
+        std::atomic_ref<u64> head{first_free};
+        u64 old_head = head.load(std::memory_order_acquire);
+        while (static_cast<u32>(old_head) != u32_invalid)
+        {
+            u32 slot_index = static_cast<u32>(old_head);
+            u32 next_index = std::atomic_ref<u32>{get_slot(slot_index).next_free}.load(std::memory_order_relaxed);
+            u64 new_head   = ((old_head >> 32) + 1) << 32 | next_index;
+            if (head.compare_exchange_weak(old_head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return slot_index;
+            }
+        }
+
+        // Or take a new slot at the end
+        u32 slot_index = std::atomic_ref<u32>{next_slot}.fetch_add(1, std::memory_order_acq_rel);
+        assert(slot_index < capacity);
+        ensure_chunk(slot_index / chunk_size);
+        return slot_index;
+    }
+
+    template <typename Value> handle_type add_internal(Value &&value)
+    {
+        u32 slot_index = allocate_slot();
+        auto &slot     = get_slot(slot_index);
+        new (&slot.storage) T(std::forward<Value>(value));
+        std::atomic_ref<u32>{slot.alive}.store(1, std::memory_order_release);
+        std::atomic_ref<u32>{data_size}.fetch_add(1, std::memory_order_relaxed);
+        return handle_type(slot_index, std::atomic_ref<u32>{slot.gen}.load(std::memory_order_acquire));
+    }
+
+    Slot *get_alive_slot(handle_type handle) const
+    {
+        if (!handle.is_valid())
+        {
+            return nullptr;
+        }
+
+        assert(handle.value() < slot_count());
+        auto &slot = get_slot(handle.value());
+        if (std::atomic_ref<u32>{slot.gen}.load(std::memory_order_acquire) != handle.generation())
+        {
+            assert(!"use after free");
+            return nullptr;
+        }
+
+        return &slot;
+    }
+
+    void release()
+    {
+        for (u32 i_chunk = 0; i_chunk < max_chunks && chunks[i_chunk]; i_chunk += 1)
+        {
+            for (u32 i = 0; i < chunk_size; i += 1)
+            {
+                auto &slot = chunks[i_chunk][i];
+                if (slot.alive)
+                {
+                    reinterpret_cast<T *>(&slot.storage)->~T();
+                }
+            }
+            delete[] chunks[i_chunk];
+            chunks[i_chunk] = nullptr;
+        }
+    }
+
+  public:
+    ConcurrentPool() = default;
+
+    ConcurrentPool(const ConcurrentPool &) = delete;
+    ConcurrentPool &operator=(const ConcurrentPool &) = delete;
+
+    ConcurrentPool(ConcurrentPool &&other)
+    {
+        *this = std::move(other);
+    }
+
+    ConcurrentPool &operator=(ConcurrentPool &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            for (u32 i_chunk = 0; i_chunk < max_chunks; i_chunk += 1)
+            {
+                chunks[i_chunk]       = other.chunks[i_chunk];
+                other.chunks[i_chunk] = nullptr;
+            }
+            first_free = std::exchange(other.first_free, u32_invalid);
+            next_slot  = std::exchange(other.next_slot, 0);
+            data_size  = std::exchange(other.data_size, 0);
+        }
+        return *this;
+    }
+
+    ~ConcurrentPool()
+    {
+        release();
+    }
+
+    handle_type add(T &&value)
+    {
+        return add_internal(std::move(value));
+    }
+
+    handle_type add(const T &value)
+    {
+        return add_internal(value);
+    }
+
+    const T *get(handle_type handle) const
+    {
+        auto *slot = get_alive_slot(handle);
+        return slot ? reinterpret_cast<const T *>(&slot->storage) : nullptr;
+    }
+
+    T *get(handle_type handle)
+    {
+        auto *slot = get_alive_slot(handle);
+        return slot ? reinterpret_cast<T *>(&slot->storage) : nullptr;
+    }
+
+    void remove(handle_type handle)
+    {
+        auto *slot = get_alive_slot(handle);
+        if (!slot)
+        {
+            assert(false);
+            return;
+        }
+
+        reinterpret_cast<T *>(&slot->storage)->~T();
+        std::atomic_ref<u32>{slot->alive}.store(0, std::memory_order_relaxed);
+        std::atomic_ref<u32>{slot->gen}.store(handle_type::next_generation(handle.value(), slot->gen), std::memory_order_release);
+        std::atomic_ref<u32>{data_size}.fetch_sub(1, std::memory_order_relaxed);
+
+        // Push the slot on the free list
+        std::atomic_ref<u64> head{first_free};
+        u64 old_head = head.load(std::memory_order_relaxed);
+        u64 new_head = 0;
+        do
+        {
+            std::atomic_ref<u32>{slot->next_free}.store(static_cast<u32>(old_head), std::memory_order_relaxed);
+            new_head = ((old_head >> 32) + 1) << 32 | handle.value();
+        } while (!head.compare_exchange_weak(old_head, new_head, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Iterator begin()
+    {
+        return Iterator(*this, 0);
+    }
+
+    ConstIterator begin() const
+    {
+        return ConstIterator(*this, 0);
+    }
+
+    Iterator end()
+    {
+        return Iterator(*this, slot_count());
+    }
+
+    ConstIterator end() const
+    {
+        return ConstIterator(*this, slot_count());
+    }
+
+    u32 size() const
+    {
+        return std::atomic_ref<u32>{const_cast<u32 &>(data_size)}.load(std::memory_order_relaxed);
+    }
+
+  private:
+    Slot *chunks[max_chunks]  = {};
+    alignas(8) u64 first_free = u32_invalid; // free list head (tag << 32) | index
+    u32 next_slot             = 0;
+    u32 data_size             = 0;
+};
@@ -0,0 +1,392 @@
+#pragma once
+
+#include "exo/numerics.h"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <utility>
+
+/**
+   Bounded lock-free queues to hand work between threads.
+   Performance:
+     Push and pop are O(1) and lock-free, the batch versions publish all their elements with a single atomic store.
+     The elements are stored inline in a ring of `capacity` slots, there is no allocation after construction.
+
+   SPSCQueue has one producer thread and one consumer thread. The head and the tail live on their own cache
+   lines, each side also keeps a cached copy of the other side's index to avoid reading a contended line on
+   every call.
+
+   MPSCQueue has any number of producer threads and one consumer thread. Producers reserve slots with a CAS on
+   the tail and mark them ready with a per-slot sequence number (Vyukov's bounded queue), the consumer doesn't
+   need any CAS.
+
+   The try_ functions never block. push() and pop() spin a little, then sleep with std::atomic::wait (a futex on
+   Linux, WaitOnAddress on Windows). The other side only calls notify when a thread is sleeping.
+ **/
+
+namespace concurrent_queue
+{
+inline constexpr usize CACHE_LINE_SIZE = 64;
+inline constexpr u32 SPIN_COUNT        = 64;
+
+// Sleeps until `index` changes from `observed`, the waker checks `sleepers` after publishing a new index
+inline void wait_for_change(std::atomic<u32> &index, std::atomic<u32> &sleepers, u32 observed)
+{
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    if (index.load(std::memory_order_seq_cst) == observed)
+    {
+        index.wait(observed, std::memory_order_seq_cst);
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline void wake(std::atomic<u32> &index, std::atomic<u32> &sleepers)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) != 0)
+    {
+        index.notify_all();
+    }
+}
+} // namespace concurrent_queue
+
+/// --- Single producer, single consumer
+template <typename T, u32 capacity> class SPSCQueue
+{
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+    static_assert(capacity <= (1u << 31));
+
+  public:
+    SPSCQueue()                  = default;
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /// --- Producer
+
+    template <typename Value> bool try_push(Value &&value)
+    {
+        u32 t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == capacity)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == capacity)
+            {
+                return false;
+            }
+        }
+
+        values[t & (capacity - 1)] = std::forward<Value>(value);
+        tail.store(t + 1, std::memory_order_release);
+        concurrent_queue::wake(tail, consumer_sleepers);
+        return true;
+    }
+
+    // Pushes as many elements as possible and returns how many were pushed
+    u32 try_push_batch(const T *batch, u32 count)
+    {
+        u32 t = tail.load(std::memory_order_relaxed);
+        if (capacity - (t - cached_head) < count)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+        }
+
+        u32 free_count = capacity - (t - cached_head);
+        count          = count < free_count ? count : free_count;
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        for (u32 i = 0; i < count; i += 1)
+        {
+            values[(t + i) & (capacity - 1)] = batch[i];
+        }
+        tail.store(t + count, std::memory_order_release);
+        concurrent_queue::wake(tail, consumer_sleepers);
+        return count;
+    }
+
+    // Blocks while the queue is full
+    template <typename Value> void push(Value &&value)
+    {
+        for (u32 i_spin = 0; !try_push(std::forward<Value>(value)); i_spin += 1)
+        {
+            if (i_spin >= concurrent_queue::SPIN_COUNT)
+            {
+                u32 observed = head.load(std::memory_order_acquire);
+                if (tail.load(std::memory_order_relaxed) - observed == capacity)
+                {
+                    concurrent_queue::wait_for_change(head, producer_sleepers, observed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    /// --- Consumer
+
+    bool try_pop(T &value)
+    {
+        u32 h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail)
+            {
+                return false;
+            }
+        }
+
+        value = std::move(values[h & (capacity - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        concurrent_queue::wake(head, producer_sleepers);
+        return true;
+    }
+
+    // Pops up to max_count elements and returns how many were popped
+    u32 try_pop_batch(T *batch, u32 max_count)
+    {
+        u32 h = head.load(std::memory_order_relaxed);
+        if (cached_tail - h < max_count)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+        }
+
+        u32 count = cached_tail - h;
+        count     = count < max_count ? count : max_count;
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        for (u32 i = 0; i < count; i += 1)
+        {
+            batch[i] = std::move(values[(h + i) & (capacity - 1)]);
+        }
+        head.store(h + count, std::memory_order_release);
+        concurrent_queue::wake(head, producer_sleepers);
+        return count;
+    }
+
+    // Blocks while the queue is empty
+    void pop(T &value)
+    {
+        for (u32 i_spin = 0; !try_pop(value); i_spin += 1)
+        {
+            if (i_spin >= concurrent_queue::SPIN_COUNT)
+            {
+                u32 observed = tail.load(std::memory_order_acquire);
+                if (observed == head.load(std::memory_order_relaxed))
+                {
+                    concurrent_queue::wait_for_change(tail, consumer_sleepers, observed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    // Approximate when called concurrently with push or pop
+    u32 size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+  private:
+    // written by the consumer
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> head = 0;
+    u32 cached_tail                                                   = 0;
+
+    // written by the producer
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> tail = 0;
+    u32 cached_head                                                   = 0;
+
+    // read on every push and pop but only written by sleeping threads
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> consumer_sleepers = 0;
+    std::atomic<u32> producer_sleepers                                             = 0;
+
+    alignas(concurrent_queue::CACHE_LINE_SIZE) T values[capacity] = {};
+};
+
+/// --- Multiple producers, single consumer
+template <typename T, u32 capacity> class MPSCQueue
+{
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of 2");
+    static_assert(capacity <= (1u << 31));
+
+    struct Slot
+    {
+        // index + 1 when the value at index is ready to be popped
+        std::atomic<u32> sequence = 0;
+        T value                   = {};
+    };
+
+  public:
+    MPSCQueue()                  = default;
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    /// --- Producers
+
+    template <typename Value> bool try_push(Value &&value)
+    {
+        u32 t = reserve(1);
+        if (t == u32_invalid)
+        {
+            return false;
+        }
+
+        write(t, std::forward<Value>(value));
+        concurrent_queue::wake(tail, consumer_sleepers);
+        return true;
+    }
+
+    // Pushes as many elements as possible and returns how many were pushed, the pushed elements are contiguous in
+    // the queue
+    u32 try_push_batch(const T *batch, u32 count)
+    {
+        u32 t = u32_invalid;
+        count = reserve_batch(count, t);
+        for (u32 i = 0; i < count; i += 1)
+        {
+            write(t + i, batch[i]);
+        }
+        if (count != 0)
+        {
+            concurrent_queue::wake(tail, consumer_sleepers);
+        }
+        return count;
+    }
+
+    // Blocks while the queue is full
+    template <typename Value> void push(Value &&value)
+    {
+        for (u32 i_spin = 0; !try_push(std::forward<Value>(value)); i_spin += 1)
+        {
+            if (i_spin >= concurrent_queue::SPIN_COUNT)
+            {
+                u32 observed = head.load(std::memory_order_acquire);
+                if (tail.load(std::memory_order_relaxed) - observed >= capacity)
+                {
+                    concurrent_queue::wait_for_change(head, producer_sleepers, observed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    /// --- Consumer
+
+    bool try_pop(T &value) { return try_pop_batch(&value, 1) == 1; }
+
+    // Pops up to max_count elements and returns how many were popped, stops at the first slot that is reserved
+    // but not written yet
+    u32 try_pop_batch(T *batch, u32 max_count)
+    {
+        u32 h     = head.load(std::memory_order_relaxed);
+        u32 count = 0;
+        for (; count < max_count; count += 1)
+        {
+            Slot &slot = slots[(h + count) & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != h + count + 1)
+            {
+                break;
+            }
+            batch[count] = std::move(slot.value);
+        }
+
+        if (count != 0)
+        {
+            head.store(h + count, std::memory_order_release);
+            concurrent_queue::wake(head, producer_sleepers);
+        }
+        return count;
+    }
+
+    // Blocks while the queue is empty
+    void pop(T &value)
+    {
+        for (u32 i_spin = 0; !try_pop(value); i_spin += 1)
+        {
+            if (i_spin >= concurrent_queue::SPIN_COUNT)
+            {
+                // A producer can have reserved the slot without writing it yet, keep spinning in that case
+                u32 observed = tail.load(std::memory_order_acquire);
+                if (observed == head.load(std::memory_order_relaxed))
+                {
+                    concurrent_queue::wait_for_change(tail, consumer_sleepers, observed);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    // Approximate when called concurrently with push or pop, counts the slots that are reserved but not written
+    u32 size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+  private:
+    u32 reserve(u32 count)
+    {
+        u32 t = u32_invalid;
+        return reserve_batch(count, t) == count ? t : u32_invalid;
+    }
+
+    // Reserves up to count slots starting at `first`, returns the number of reserved slots
+    u32 reserve_batch(u32 count, u32 &first)
+    {
+        u32 t = tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            // the consumer publishes head after it moved the values out, the slots before head + capacity are free
+            u32 h          = head.load(std::memory_order_acquire);
+            u32 free_count = capacity - (t - h);
+            // t was read before h, the consumer may be ahead of a stale tail
+            if (free_count > capacity)
+            {
+                t = tail.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            u32 reserved = count < free_count ? count : free_count;
+            if (reserved == 0)
+            {
+                return 0;
+            }
+
+            if (tail.compare_exchange_weak(t, t + reserved, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                first = t;
+                return reserved;
+            }
+        }
+    }
+
+    template <typename Value> void write(u32 index, Value &&value)
+    {
+        Slot &slot = slots[index & (capacity - 1)];
+        assert(slot.sequence.load(std::memory_order_relaxed) != index + 1);
+        slot.value = std::forward<Value>(value);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // written by the consumer
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> head = 0;
+
+    // written by the producers
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> tail = 0;
+
+    // read on every push and pop but only written by sleeping threads
+    alignas(concurrent_queue::CACHE_LINE_SIZE) std::atomic<u32> consumer_sleepers = 0;
+    std::atomic<u32> producer_sleepers                                             = 0;
+
+    alignas(concurrent_queue::CACHE_LINE_SIZE) Slot slots[capacity] = {};
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "exo/types.h"
+#include "exo/handle.h"
+#include "exo/collections/vector.h"
+
+#include <utility>
+
+/**
+   A PackedPool is a Pool whose values are always tightly packed.
+   Performance:
+     Adding/removing elements is O(1) (remove swaps the last value into the hole).
+     Iterating is O(size) and only touches live elements.
+     Pointers returned by get() are invalidated by add() AND remove().
+
+   Handle is (index, gen) packed in a single integer, index is a slot index and NOT a position in the values array.
+
+   PackedPool is (vector<T> values, vector<u32> value_to_slot, vector<Slot> slots).
+   A slot contains the generation of its current value and the position of the value in the dense array,
+   when a slot is free its dense index is the next free slot instead.
+
+   Iteration goes from the last value to the first one so that removing the current element
+   while iterating is allowed (the swapped-in value has already been visited).
+ **/
+
+/// --- Packed pool allocator
+template <typename T> class PackedPool
+{
+    using handle_type = Handle<T>;
+
+    struct Slot
+    {
+        u32 dense_index = u32_invalid; // position in values when used, next free slot when free
+        u32 gen         = 0;
+        bool operator==(const Slot &) const = default;
+    };
+
+    template <typename Pool, typename Value> class IteratorBase
+    {
+      public:
+        using difference_type   = int;
+        using value_type        = std::pair<handle_type, Value *>;
+        using pointer           = value_type *;
+        using reference         = value_type &;
+        using iterator_category = std::input_iterator_tag;
+
+        IteratorBase() = default;
+        IteratorBase(Pool &_pool, u32 _remaining)
+            : pool{&_pool}
+            , remaining{_remaining}
+        {
+        }
+
+        bool operator==(const IteratorBase &rhs) const
+        {
+            return remaining == rhs.remaining;
+        }
+
+        reference operator*()
+        {
+            assert(this->pool && remaining > 0 && remaining <= static_cast<u32>(this->pool->values.size()));
+            u32 dense_index = remaining - 1;
+            value           = std::make_pair(this->pool->handle_from_dense(dense_index), &this->pool->values[dense_index]);
+            return value;
+        }
+
+        IteratorBase &operator++()
+        {
+            assert(this->pool && remaining > 0);
+            remaining -= 1;
+            return *this;
+        }
+
+      private:
+        Pool *pool    = nullptr;
+        u32 remaining = 0; // number of values left to visit, current value is values[remaining - 1]
+        value_type value = {};
+    };
+
+    using Iterator      = IteratorBase<PackedPool, T>;
+    using ConstIterator = IteratorBase<const PackedPool, const T>;
+
+    handle_type handle_from_dense(u32 dense_index) const
+    {
+        u32 slot_index = value_to_slot[dense_index];
+        return handle_type(slot_index, slots[slot_index].gen);
+    }
+
+    u32 allocate_slot(u32 dense_index)
+    {
+        if (first_free == u32_invalid)
+        {
+            slots.push_back({.dense_index = dense_index, .gen = 0});
+            return static_cast<u32>(slots.size() - 1);
+        }
+
+        // Pop the free list
+        u32 slot_index                = first_free;
+        first_free                    = slots[slot_index].dense_index;
+        slots[slot_index].dense_index = dense_index;
+        return slot_index;
+    }
+
+    u32 get_dense_index(handle_type handle) const
+    {
+        if (!handle.is_valid())
+        {
+            return u32_invalid;
+        }
+
+        const auto &slot = slots[handle.value()];
+        if (slot.gen != handle.generation())
+        {
+            assert(!"use after free");
+            return u32_invalid;
+        }
+
+        return slot.dense_index;
+    }
+
+  public:
+    PackedPool() = default;
+    PackedPool(u32 capacity)
+    {
+        values.reserve(capacity);
+        value_to_slot.reserve(capacity);
+        slots.reserve(capacity);
+    }
+
+    handle_type add(T &&value)
+    {
+        u32 dense_index = static_cast<u32>(values.size());
+        u32 slot_index  = allocate_slot(dense_index);
+        values.push_back(std::move(value));
+        value_to_slot.push_back(slot_index);
+        return handle_from_dense(dense_index);
+    }
+
+    handle_type add(const T &value)
+    {
+        u32 dense_index = static_cast<u32>(values.size());
+        u32 slot_index  = allocate_slot(dense_index);
+        values.push_back(value);
+        value_to_slot.push_back(slot_index);
+        return handle_from_dense(dense_index);
+    }
+
+    const T *get(handle_type handle) const
+    {
+        u32 dense_index = get_dense_index(handle);
+        return dense_index != u32_invalid ? &values[dense_index] : nullptr;
+    }
+
+    T *get(handle_type handle)
+    {
+        u32 dense_index = get_dense_index(handle);
+        return dense_index != u32_invalid ? &values[dense_index] : nullptr;
+    }
+
+    void remove(handle_type handle)
+    {
+        assert(!values.empty());
+        u32 dense_index = get_dense_index(handle);
+        if (dense_index == u32_invalid)
+        {
+            assert(false);
+            return;
+        }
+
+        // move the last value into the hole
+        u32 last_index = static_cast<u32>(values.size() - 1);
+        if (dense_index != last_index)
+        {
+            u32 last_slot                = value_to_slot[last_index];
+            values[dense_index]          = std::move(values[last_index]);
+            value_to_slot[dense_index]   = last_slot;
+            slots[last_slot].dense_index = dense_index;
+        }
+        values.pop_back();
+        value_to_slot.pop_back();
+
+        // bump the generation to catch stale handles
+        u32 slot_index   = handle.value();
+        auto &slot       = slots[slot_index];
+        slot.gen         = handle_type::next_generation(slot_index, slot.gen);
+        slot.dense_index = first_free;
+        first_free       = slot_index;
+    }
+
+    Iterator begin()
+    {
+        return Iterator(*this, static_cast<u32>(values.size()));
+    }
+
+    ConstIterator begin() const
+    {
+        return ConstIterator(*this, static_cast<u32>(values.size()));
+    }
+
+    Iterator end()
+    {
+        return Iterator(*this, 0);
+    }
+
+    ConstIterator end() const
+    {
+        return ConstIterator(*this, 0);
+    }
+
+    bool operator==(const PackedPool &rhs) const = default;
+
+    u32 size() const
+    {
+        return static_cast<u32>(values.size());
+    }
+
+    inline const void *data_ptr() const { return values.data(); }
+
+  private:
+    Vec<T> values;
+    Vec<u32> value_to_slot;
+    Vec<Slot> slots;
+    u32 first_free = u32_invalid; // free list head slot
+};
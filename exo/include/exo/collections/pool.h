@@ -12,11 +12,12 @@
      Adding/removing elements is O(1).
      Iterating is O(capacity) and elements are NOT tighly packed because of the free-list.
 
-   Handle is (u32 index, u32 gen).
+   Handle is (index, gen) packed in a single integer, see exo/handle.h.
 
-   Pool is (vector<variant<T, Handle>> elements, vector<Handle> keys).
+   Pool is (vector<Slot{variant<u32, T>, u32 gen}> elements).
    std::variant is used to make the free-list.
-   keys are separated to check use-after-free. (this is bad :()
+   The generation of a slot is bumped when its value is removed, a handle is valid if its generation matches its slot.
+   See PackedPool (exo/collections/packed_pool.h) for a tightly packed variant.
  **/
 
 /// --- Pool allocator
@@ -43,7 +44,7 @@ template <typename T> class Pool
                 // index() returns a zero-based index of the type
                 // 0: handle_type
                 // 1: T
-                if (pool->data[current_index].index() == 1)
+                if (pool->data[current_index].value.index() == 1)
                 {
                     break;
                 }
@@ -84,7 +85,7 @@ template <typename T> class Pool
         reference operator*()
         {
             assert(this->pool && current_index < static_cast<u32>(this->pool->data.size()));
-            value = std::make_pair(this->pool->keys[current_index], &this->pool->get_value_internal(current_index));
+            value = std::make_pair(this->pool->get_handle_internal(current_index), &this->pool->get_value_internal(current_index));
             return value;
         }
 
@@ -97,7 +98,7 @@ template <typename T> class Pool
                 // index() returns a zero-based index of the type
                 // 0: handle_type
                 // 1: T
-                if (pool->data[current_index].index() == 1)
+                if (pool->data[current_index].value.index() == 1)
                 {
                     break;
                 }
@@ -115,7 +116,7 @@ template <typename T> class Pool
                     // index() returns a zero-based index of the type
                     // 0: handle_type
                     // 1: T
-                    if (pool->data[current_index].index() == 1)
+                    if (pool->data[current_index].value.index() == 1)
                     {
                         break;
                     }
@@ -149,7 +150,7 @@ template <typename T> class Pool
                 // index() returns a zero-based index of the type
                 // 0: handle_type
                 // 1: T
-                if (pool->data[current_index].index() == 1)
+                if (pool->data[current_index].value.index() == 1)
                 {
                     break;
                 }
@@ -190,7 +191,7 @@ template <typename T> class Pool
         reference operator*()
         {
             assert(this->pool && current_index < static_cast<u32>(this->pool->data.size()));
-            value = std::make_pair(this->pool->keys[current_index], &this->pool->get_value_internal(current_index));
+            value = std::make_pair(this->pool->get_handle_internal(current_index), &this->pool->get_value_internal(current_index));
             return value;
         }
 
@@ -203,7 +204,7 @@ template <typename T> class Pool
                 // index() returns a zero-based index of the type
                 // 0: handle_type
                 // 1: T
-                if (pool->data[current_index].index() == 1)
+                if (pool->data[current_index].value.index() == 1)
                 {
                     break;
                 }
@@ -221,7 +222,7 @@ template <typename T> class Pool
                     // index() returns a zero-based index of the type
                     // 0: handle_type
                     // 1: T
-                    if (pool->data[current_index].index() == 1)
+                    if (pool->data[current_index].value.index() == 1)
                     {
                         break;
                     }
@@ -237,142 +238,113 @@ template <typename T> class Pool
 
     // static_assert(std::input_iterator<Iterator>);
 
-    using handle_type  = Handle<T>;
-    using element_type = std::variant<handle_type, T>; // < next_free_ptr, value >
+    using handle_type = Handle<T>;
 
-    handle_type &get_handle_internal(handle_type handle)
+    struct Slot
     {
-        return std::get<handle_type>(data[handle.value()]);
+        std::variant<u32, T> value; // < next_free_index, value >
+        u32 gen = 0;
+        bool operator==(const Slot &) const = default;
+    };
+
+    handle_type get_handle_internal(u32 index) const
+    {
+        return handle_type(index, data[index].gen);
     }
 
     T &get_value_internal(u32 index)
     {
-        return std::get<T>(data[index]);
+        return std::get<1>(data[index].value);
     }
 
     const T &get_value_internal(u32 index) const
     {
-        return std::get<T>(data[index]);
+        return std::get<1>(data[index].value);
     }
 
-    T &get_value_internal(handle_type handle)
+    bool is_alive_internal(handle_type handle) const
     {
-        return get_value_internal(handle.value());
-    }
+        if (!handle.is_valid())
+        {
+            return false;
+        }
 
-    const T &get_value_internal(handle_type handle) const
-    {
-        return get_value_internal(handle.value());
-    }
+        if (handle.generation() != data[handle.value()].gen)
+        {
+            assert(!"use after free");
+            return false;
+        }
 
-  public:
-    Pool() = default;
-    Pool(u32 capacity)
-    {
-        data.reserve(capacity);
-        keys.reserve(capacity);
+        return true;
     }
 
-    handle_type add(T &&value)
+    template <typename Value> handle_type add_internal(Value &&value)
     {
         data_size += 1;
 
-        if (!first_free.is_valid())
+        if (first_free == u32_invalid)
         {
-            data.push_back(std::move(value));
-            auto handle = handle_type(static_cast<u32>(data.size() - 1));
-            keys.push_back(handle);
-            return handle;
+            data.push_back(Slot{.value = std::variant<u32, T>(std::in_place_index<1>, std::forward<Value>(value))});
+            return handle_type(static_cast<u32>(data.size() - 1), 0);
         }
 
         // Pop the free list
-        handle_type old_first_free = first_free;
-        old_first_free.gen += 1;
-
-        first_free                 = get_handle_internal(old_first_free);
+        u32 slot_index = first_free;
+        auto &slot     = data[slot_index];
+        first_free     = std::get<0>(slot.value);
 
         // put the value in
-        data[old_first_free.value()] = std::move(value);
-        keys[old_first_free.value()] = old_first_free;
+        slot.value.template emplace<1>(std::forward<Value>(value));
 
-        return old_first_free;
+        return handle_type(slot_index, slot.gen);
     }
 
-    handle_type add(const T &value)
+  public:
+    Pool() = default;
+    Pool(u32 capacity)
     {
-        data_size += 1;
-
-        if (!first_free.is_valid())
-        {
-            data.push_back(value);
-            auto handle = handle_type(static_cast<u32>(data.size() - 1));
-            keys.push_back(handle);
-            return handle;
-        }
-
-        // Pop the free list
-        handle_type old_first_free = first_free;
-        old_first_free.gen += 1;
-
-        first_free                 = get_handle_internal(old_first_free);
+        data.reserve(capacity);
+    }
 
-        // put the value in
-        data[old_first_free.value()] = value;
-        keys[old_first_free.value()] = old_first_free;
+    handle_type add(T &&value)
+    {
+        return add_internal(std::move(value));
+    }
 
-        return old_first_free;
+    handle_type add(const T &value)
+    {
+        return add_internal(value);
     }
 
     const T *get(handle_type handle) const
     {
-        if (!handle.is_valid())
-        {
-            return nullptr;
-        }
-
-        if (handle != keys[handle.value()])
-        {
-            assert(!"use after free");
-            return nullptr;
-        }
-
-        return &get_value_internal(handle);
+        return is_alive_internal(handle) ? &get_value_internal(handle.value()) : nullptr;
     }
 
     T *get(handle_type handle)
     {
-        if (!handle.is_valid())
-        {
-            return nullptr;
-        }
-
-        if (handle != keys[handle.value()])
-        {
-            assert(!"use after free");
-            return nullptr;
-        }
-
-        return &get_value_internal(handle);
+        return is_alive_internal(handle) ? &get_value_internal(handle.value()) : nullptr;
     }
 
     void remove(handle_type handle)
     {
         assert(data_size != 0);
-        if (!handle.is_valid())
+        if (!is_alive_internal(handle))
         {
             assert(false);
+            return;
         }
 
         data_size -= 1;
 
-        // replace the value to remove with the head of the free list
-        auto &data_element = data[handle.value()];
-        auto &key_element  = keys[handle.value()];
-        data_element       = first_free;
-        key_element        = handle_type::invalid();
+        // replace the value to remove with the head of the free list, and invalidate the handles to this slot
+        u32 slot_index = handle.value();
+        auto &slot     = data[slot_index];
+        slot.value.template emplace<0>(first_free);
+        slot.gen = handle_type::next_generation(slot_index, slot.gen);
 
-        // set the new head of the free list to the handle that was just removed
-        first_free    = handle;
+        // set the new head of the free list to the slot that was just removed
+        first_free = slot_index;
     }
 
     Iterator begin()
@@ -405,9 +377,8 @@ template <typename T> class Pool
     inline const void *data_ptr() const { return data.data(); }
 
   private:
-    handle_type first_free; // free list head ptr
-    Vec<element_type> data;
-    Vec<handle_type> keys;
+    u32 first_free = u32_invalid; // free list head index
+    Vec<Slot> data;
     u32 data_size{0};
 
     friend class Iterator;
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "exo/numerics.h"
+
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+   A SmallVec is a vector that stores up to N elements inline and moves them to the heap when it grows past N.
+   Performance:
+     Small vectors don't allocate and their elements are next to the vector itself (no pointer chase).
+     Moving a small vector moves its elements one by one.
+ **/
+
+/// --- Vector with inline storage
+template <typename T, usize N> class SmallVec
+{
+    static_assert(N > 0);
+
+  public:
+    using value_type     = T;
+    using iterator       = T *;
+    using const_iterator = const T *;
+
+    SmallVec() = default;
+
+    SmallVec(std::initializer_list<T> list)
+    {
+        reserve(list.size());
+        for (const auto &value : list)
+        {
+            push_back(value);
+        }
+    }
+
+    explicit SmallVec(usize count, const T &value = {})
+    {
+        resize(count, value);
+    }
+
+    template <typename It> SmallVec(It first, It last)
+    {
+        for (; first != last; ++first)
+        {
+            push_back(*first);
+        }
+    }
+
+    SmallVec(const SmallVec &other)
+    {
+        reserve(other.length);
+        for (const auto &value : other)
+        {
+            push_back(value);
+        }
+    }
+
+    SmallVec(SmallVec &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        move_from(std::move(other));
+    }
+
+    SmallVec &operator=(const SmallVec &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            reserve(other.length);
+            for (const auto &value : other)
+            {
+                push_back(value);
+            }
+        }
+        return *this;
+    }
+
+    SmallVec &operator=(SmallVec &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            release();
+            move_from(std::move(other));
+        }
+        return *this;
+    }
+
+    ~SmallVec()
+    {
+        release();
+    }
+
+    template <typename... Args> T &emplace_back(Args &&...args)
+    {
+        if (length == cap)
+        {
+            return grow_and_emplace_back(std::forward<Args>(args)...);
+        }
+        T *value = new (elements + length) T(std::forward<Args>(args)...);
+        length += 1;
+        return *value;
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        assert(length > 0);
+        length -= 1;
+        elements[length].~T();
+    }
+
+    void resize(usize new_length, const T &value = {})
+    {
+        while (length > new_length)
+        {
+            pop_back();
+        }
+        if (new_length > cap)
+        {
+            // value can be one of the elements, copy it before they move
+            T copy = value;
+            reserve(new_length);
+            fill_back(new_length, copy);
+        }
+        else
+        {
+            fill_back(new_length, value);
+        }
+    }
+
+    void clear()
+    {
+        while (length > 0)
+        {
+            pop_back();
+        }
+    }
+
+    void reserve(usize new_capacity)
+    {
+        if (new_capacity <= cap)
+        {
+            return;
+        }
+
+        T *new_elements = std::allocator<T>{}.allocate(new_capacity);
+        relocate(new_elements, new_capacity);
+    }
+
+    T &operator[](usize i) { assert(i < length); return elements[i]; }
+    const T &operator[](usize i) const { assert(i < length); return elements[i]; }
+
+    T &front() { return (*this)[0]; }
+    const T &front() const { return (*this)[0]; }
+    T &back() { return (*this)[length - 1]; }
+    const T &back() const { return (*this)[length - 1]; }
+
+    T *data() { return elements; }
+    const T *data() const { return elements; }
+
+    iterator begin() { return elements; }
+    iterator end() { return elements + length; }
+    const_iterator begin() const { return elements; }
+    const_iterator end() const { return elements + length; }
+
+    usize size() const { return length; }
+    bool empty() const { return length == 0; }
+    usize capacity() const { return cap; }
+    bool is_inline() const { return elements == inline_elements(); }
+
+    bool operator==(const SmallVec &other) const
+    {
+        if (length != other.length)
+        {
+            return false;
+        }
+        for (u32 i = 0; i < length; i += 1)
+        {
+            if (!(elements[i] == other.elements[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    T *inline_elements() { return reinterpret_cast<T *>(storage); }
+    const T *inline_elements() const { return reinterpret_cast<const T *>(storage); }
+
+    // the capacity has to be at least new_length
+    void fill_back(usize new_length, const T &value)
+    {
+        for (; length < new_length; length += 1)
+        {
+            new (elements + length) T(value);
+        }
+    }
+
+    // the arguments can reference one of the elements, the new element is constructed before the others move
+    template <typename... Args> T &grow_and_emplace_back(Args &&...args)
+    {
+        const usize new_capacity = 2 * usize(cap);
+        T *new_elements          = std::allocator<T>{}.allocate(new_capacity);
+        T *value                 = new (new_elements + length) T(std::forward<Args>(args)...);
+        relocate(new_elements, new_capacity);
+        length += 1;
+        return *value;
+    }
+
+    // move the elements to new_elements and free the previous heap storage
+    void relocate(T *new_elements, usize new_capacity)
+    {
+        for (u32 i = 0; i < length; i += 1)
+        {
+            new (new_elements + i) T(std::move(elements[i]));
+            elements[i].~T();
+        }
+        if (!is_inline())
+        {
+            std::allocator<T>{}.deallocate(elements, cap);
+        }
+        elements = new_elements;
+        cap      = static_cast<u32>(new_capacity);
+    }
+
+    // destroy the elements and free the heap storage, the vector is empty and inline after
+    void release()
+    {
+        clear();
+        if (!is_inline())
+        {
+            std::allocator<T>{}.deallocate(elements, cap);
+        }
+        elements = inline_elements();
+        cap      = N;
+    }
+
+    // this has to be empty and inline
+    void move_from(SmallVec &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (other.is_inline())
+        {
+            for (u32 i = 0; i < other.length; i += 1)
+            {
+                push_back(std::move(other.elements[i]));
+            }
+            other.clear();
+        }
+        else
+        {
+            // steal the heap storage
+            elements       = other.elements;
+            length         = other.length;
+            cap            = other.cap;
+            other.elements = other.inline_elements();
+            other.length   = 0;
+            other.cap      = N;
+        }
+    }
+
+    T *elements = inline_elements();
+    u32 length  = 0;
+    u32 cap     = N;
+    alignas(T) u8 storage[N * sizeof(T)];
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include "exo/numerics.h"
+
+/**
+   A ConcurrentFreeList is a FreeList that can be used from multiple threads without locks.
+   The head is (u32 tag, u32 index) and is updated with a single CAS, the tag is incremented on every
+   update to avoid the ABA problem.
+   Like FreeList, the struct is trivially copyable and has to be destroyed explicitly.
+ **/
+class ConcurrentFreeList
+{
+public:
+    static ConcurrentFreeList create(u32 capacity);
+
+    // returns u32_invalid when the list is empty
+    u32 allocate();
+    void free(u32 index);
+
+    void destroy();
+private:
+    u32 *array = nullptr;
+    alignas(8) u64 head = u64_invalid; // (tag << 32) | index
+    u32 capacity = 0;
+};
@@ -2,62 +2,88 @@
 #include "exo/types.h"
 #include "exo/hash.h"
 
-template <typename T> class Pool;
+/// --- Handle layout
+// Specialize to change the size of a handle or how its bits are split between index and generation:
+// template <> struct HandleTraits<Texture> { using raw_type = u32; static constexpr u32 index_bits = 20; };
+template <typename T> struct HandleTraits
+{
+    using raw_type                  = u64;
+    static constexpr u32 index_bits = 32;
+};
 
 /// --- Handle type (Typed index that can be invalid)
+// A handle is a single integer: the low bits are the index of a slot in a pool, the high bits are the generation of the slot.
+// The generation lives in the pool slot, a handle is valid if its generation matches the generation of its slot.
 template <typename T> struct Handle
 {
+    using raw_type = typename HandleTraits<T>::raw_type;
+
+    static constexpr u32 raw_bits   = sizeof(raw_type) * 8;
+    static constexpr u32 index_bits = HandleTraits<T>::index_bits;
+    static constexpr u32 gen_bits   = raw_bits - index_bits;
+    static_assert(index_bits > 0 && index_bits < raw_bits && index_bits <= 32 && gen_bits <= 32);
+
+    static constexpr raw_type invalid_raw = ~raw_type(0);
+    static constexpr u32 index_mask       = static_cast<u32>((raw_type(1) << index_bits) - 1);
+    static constexpr u32 gen_mask         = static_cast<u32>(invalid_raw >> index_bits);
+
     static Handle invalid()
     {
         return Handle();
     }
 
     Handle()
-        : index(u32_invalid)
-        , gen(u32_invalid)
+        : raw(invalid_raw)
     {
     }
 
-    // The gen should be incremented only when creating explicitly a new handle
-    explicit Handle(u32 i)
-        : index(i)
+    explicit Handle(u32 i, u32 gen = 0)
+        : raw(raw_type(i & index_mask) | raw_type(gen & gen_mask) << index_bits)
     {
-        static u32 cur_gen = 0;
-        gen                = cur_gen++;
-
-        assert(index != u32_invalid);
+        assert(i <= index_mask);
+        assert(is_valid());
     }
 
     constexpr Handle &operator=(const Handle &other) = default;
 
-    [[nodiscard]] u32 value() const { return index; }
+    [[nodiscard]] u32 value() const { return static_cast<u32>(raw & index_mask); }
+    [[nodiscard]] u32 generation() const { return static_cast<u32>(raw >> index_bits); }
 
     [[nodiscard]] u64 hash() const
     {
-        return u64(index) << 32 | gen;
+        return u64(raw);
     }
 
     [[nodiscard]] bool is_valid() const
     {
-        return index != u32_invalid && gen != u32_invalid;
+        return raw != invalid_raw;
     }
 
     bool operator==(const Handle &b) const
     {
-        return index == b.index && gen == b.gen;
+        return raw == b.raw;
     }
 
     bool operator<(const Handle &b) const
     {
-        return index < b.index;
+        return value() < b.value();
+    }
+
+    // Generation of a slot after its value has been removed, skips the combination reserved for the invalid handle
+    static u32 next_generation(u32 index, u32 gen)
+    {
+        u32 next = (gen + 1) & gen_mask;
+        if (index == index_mask && next == gen_mask)
+        {
+            next = 0;
+        }
+        return next;
     }
 
   private:
-    u32 index;
-    u32 gen;
+    raw_type raw;
 
     friend struct ::std::hash<Handle<T>>;
-    friend Pool<T>;
 };
 
 namespace std
@@ -67,9 +93,7 @@ namespace std
     {
         std::size_t operator()(Handle<T> const& handle) const noexcept
         {
-            usize hash = hash_value(handle.index);
-            hash_combine(hash, handle.gen);
-            return hash;
+            return static_cast<std::size_t>(hash_u64(u64(handle.raw)));
         }
     };
 }
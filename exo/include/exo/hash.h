@@ -1,5 +1,24 @@
 #pragma once
+#include "exo/types.h"
+
 #include <functional>
+#include <type_traits>
+#include <vector>
+
+/// --- Byte hashing
+// 64-bit non-cryptographic hash: wyhash-style mixing for short inputs, SIMD xxh3-style stripes for long inputs.
+u64 hash_bytes(const void *data, usize len, u64 seed = 0);
+
+// Hash a single 64-bit value (much cheaper than hash_bytes on 8 bytes)
+u64 hash_u64(u64 value, u64 seed = 0);
+
+// Hash the bytes of a value, the type must not contain padding otherwise equal values could hash differently
+template <typename T> inline u64 hash_struct(const T &value, u64 seed = 0)
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>,
+                  "hash_struct needs a trivially copyable type without padding.");
+    return hash_bytes(&value, sizeof(T), seed);
+}
 
 template <typename T>
 inline std::size_t hash_value(const T& v)
@@ -10,22 +29,30 @@ inline std::size_t hash_value(const T& v)
 template <typename T>
 inline void hash_combine(std::size_t& seed, const T& v)
 {
-    seed ^= hash_value(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    seed = static_cast<std::size_t>(hash_u64(u64(hash_value(v)), u64(seed)));
 }
 
 namespace std
 {
-    template<typename T>
-    struct hash<std::vector<T>>
+    template<typename T, typename Allocator>
+    struct hash<std::vector<T, Allocator>>
     {
-        std::size_t operator()(std::vector<T> const& vec) const noexcept
+        std::size_t operator()(std::vector<T, Allocator> const& vec) const noexcept
         {
-            std::size_t hash = vec.size();
-            for (auto &i : vec)
+            // the elements' bytes can be hashed directly when they are their value
+            if constexpr (std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>)
+            {
+                return static_cast<std::size_t>(hash_bytes(vec.data(), vec.size() * sizeof(T), vec.size()));
+            }
+            else
             {
-                hash_combine(hash, i);
+                std::size_t hash = vec.size();
+                for (auto &i : vec)
+                {
+                    hash_combine(hash, i);
+                }
+                return hash;
             }
-            return hash;
         }
     };
 }
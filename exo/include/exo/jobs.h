@@ -0,0 +1,129 @@
+#pragma once
+#include "exo/numerics.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+/**
+   The job system runs small jobs on a fixed pool of worker threads.
+   Each thread owns a Chase-Lev deque: it pushes and pops its jobs at the bottom without locks, and idle
+   threads steal jobs from the top of the other deques.
+   A job decrements its Counter when it is done. wait() runs other jobs until the counter reaches 0, so the
+   waiting thread (the main thread most of the time) participates instead of blocking.
+   Job functions are copied inside the job: they must be trivially copyable and small, capture by reference
+   and wait on the counter before the captured variables go out of scope.
+   When the job system is not initialized, jobs run immediately on the calling thread.
+ **/
+namespace jobs
+{
+inline constexpr usize JOB_STORAGE_SIZE = 48;
+
+struct Counter
+{
+    std::atomic<u32> value = 0;
+
+    inline bool is_done() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job
+{
+    void (*function)(Job &job) = nullptr;
+    Counter *counter = nullptr;
+    // range of indices for parallel_for jobs
+    usize begin = 0;
+    usize end   = 0;
+    usize grain = 0;
+    alignas(16) u8 storage[JOB_STORAGE_SIZE] = {};
+
+    template <typename T> const T &get() const { return *std::launder(reinterpret_cast<const T *>(storage)); }
+};
+
+// worker_count = 0 uses one worker per hardware thread except the calling thread, which becomes the main thread
+void init(u32 worker_count = 0);
+void shutdown();
+
+bool is_initialized();
+// number of threads that run jobs, including the main thread
+u32 thread_count();
+
+// index of the calling thread in [0, thread_count()), the main thread is 0 and threads outside of the pool get u32_invalid
+u32 thread_index();
+
+void spawn_job(const Job &job);
+void wait(Counter &counter);
+// Runs one pending job if there is one, to let a thread help while it waits for something else than a Counter
+bool try_run_one();
+
+template <typename Lambda> void spawn(Counter &counter, Lambda lambda)
+{
+    static_assert(sizeof(Lambda) <= JOB_STORAGE_SIZE && alignof(Lambda) <= 16);
+    static_assert(std::is_trivially_copyable_v<Lambda>);
+
+    Job job      = {};
+    job.function = [](Job &job) { job.get<Lambda>()(); };
+    job.counter  = &counter;
+    std::memcpy(job.storage, &lambda, sizeof(Lambda));
+    spawn_job(job);
+}
+
+// Calls lambda(i) for every i in [0, count), the range is split in half until the parts are smaller than `grain`.
+// A grain of 0 splits the range in about 4 parts per thread.
+template <typename Lambda> void parallel_for(usize count, usize grain, const Lambda &lambda)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (grain == 0)
+    {
+        grain = (count + 4 * thread_count() - 1) / (4 * thread_count());
+    }
+
+    if (!is_initialized() || count <= grain)
+    {
+        for (usize i = 0; i < count; i += 1)
+        {
+            lambda(i);
+        }
+        return;
+    }
+
+    // The job only stores a pointer to the lambda, this function waits for all the jobs
+    const Lambda *p_lambda = &lambda;
+
+    Counter counter = {};
+    Job job         = {};
+    job.counter     = &counter;
+    job.begin       = 0;
+    job.end         = count;
+    job.grain       = grain;
+    std::memcpy(job.storage, &p_lambda, sizeof(p_lambda));
+    job.function = [](Job &job) {
+        // Push the second half of the range to let other threads steal it, and keep the first half
+        while (job.end - job.begin > job.grain)
+        {
+            Job half  = job;
+            half.begin = job.begin + (job.end - job.begin) / 2;
+            job.end    = half.begin;
+            spawn_job(half);
+        }
+
+        const Lambda &lambda = *job.get<const Lambda *>();
+        for (usize i = job.begin; i < job.end; i += 1)
+        {
+            lambda(i);
+        }
+    };
+
+    spawn_job(job);
+    wait(counter);
+}
+
+template <typename Lambda> void parallel_for(usize count, const Lambda &lambda)
+{
+    parallel_for(count, 0, lambda);
+}
+} // namespace jobs
@@ -1,27 +1,100 @@
 #pragma once
 
 #include "exo/intrinsics.h"
+#include "exo/numerics.h"
 
 #include <fmt/core.h>
 #include <fmt/color.h>
 #include <fmt/ostream.h>
 
+#include <atomic>
+
+/**
+   The logger writes messages on a background thread: the calling thread formats the message in a stack buffer
+   and pushes it to its own lock-free queue, the logger thread drains the queues, sorts the messages by time and
+   writes them to stdout/stderr and to the optional binary file.
+   Levels below LOGGER_MIN_LEVEL are stripped at compile time, set_console_level() filters the console at runtime.
+   Error messages are written before error() returns, call flush() to wait for the other levels.
+   The queue of a thread is freed once the thread has exited and its messages are written.
+ **/
 namespace logger
 {
-    template <typename S, typename... Args>
-    inline void info(const S& format_str, Args&&... args)
-    {
-        fmt::print(format_str, args...);
-    }
+enum struct Level : u8
+{
+    Trace,
+    Debug,
+    Info,
+    Warning,
+    Error,
+};
+
+#if !defined(LOGGER_MIN_LEVEL)
+#define LOGGER_MIN_LEVEL 0
+#endif
+inline constexpr Level MIN_LEVEL = static_cast<Level>(LOGGER_MIN_LEVEL);
+
+// bigger messages are formatted on the heap
+inline constexpr usize INLINE_MESSAGE_SIZE = 512;
+
+void push(Level level, const char *message, usize size);
+// blocks until every message pushed before the call is written
+void flush();
 
-    template <typename S, typename... Args>
-    inline void error(const S& format_str, Args&&... args)
+void set_console_level(Level level);
+// Every message is also written to the file as [u64 timestamp ns][u32 thread][u32 level][u32 size][u32 padding][message]
+bool open_binary_sink(const char *path);
+void close_binary_sink();
+
+// Lets one message through per interval, for messages logged every frame
+struct RateLimiter
+{
+    explicit RateLimiter(double interval_ms);
+    bool allow();
+
+    u64 interval_ns;
+    std::atomic<u64> next_ns = 0;
+};
+
+template <Level level, typename S, typename... Args> inline void log(const S &format_str, const Args &...args)
+{
+    if constexpr (level >= MIN_LEVEL)
     {
-        #if 0
-        auto style = fg(fmt::color::crimson) | fmt::emphasis::bold;
-        fmt::print(stderr, style, format_str, args...);
-        #endif
-        fmt::print(stderr, format_str, args...);
+        char buffer[INLINE_MESSAGE_SIZE];
+        auto result = fmt::format_to_n(buffer, sizeof(buffer), format_str, args...);
+        if (result.size <= sizeof(buffer))
+        {
+            push(level, buffer, result.size);
+        }
+        else
+        {
+            auto message = fmt::format(format_str, args...);
+            push(level, message.data(), message.size());
+        }
     }
+}
 
+template <typename S, typename... Args> inline void trace(const S &format_str, const Args &...args)
+{
+    log<Level::Trace>(format_str, args...);
+}
+
+template <typename S, typename... Args> inline void debug(const S &format_str, const Args &...args)
+{
+    log<Level::Debug>(format_str, args...);
+}
+
+template <typename S, typename... Args> inline void info(const S &format_str, const Args &...args)
+{
+    log<Level::Info>(format_str, args...);
+}
+
+template <typename S, typename... Args> inline void warning(const S &format_str, const Args &...args)
+{
+    log<Level::Warning>(format_str, args...);
+}
+
+template <typename S, typename... Args> inline void error(const S &format_str, const Args &...args)
+{
+    log<Level::Error>(format_str, args...);
 }
+} // namespace logger
@@ -1,5 +1,398 @@
 #pragma once
-#include <unordered_map>
+#include "exo/types.h"
+#include "exo/collections/vector.h"
 
-template<typename K, typename V>
-using Map = std::unordered_map<K, V>;
+#include <bit>
+#include <cassert>
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MAP_USE_SSE2
+#endif
+
+/**
+   Map and Set are open-addressing hash tables (Swiss table style).
+   Performance:
+     Lookups probe the control bytes 16 at a time with SSE2 and only compare keys whose 7-bit tag matches.
+     Iterating is O(size) and visits a dense array of entries.
+     Pointers/references to entries are invalidated by insertions AND erasures.
+
+   A table is (vector<Entry> entries, vector<u64> hashes, vector<u32> slots, vector<u8> ctrl).
+   Entries are tightly packed in insertion order, erase swaps the last entry into the hole.
+   The slots array is the actual hash table: a slot contains the index of an entry and its control byte
+   is either EMPTY or the 7 high bits of the entry's hash.
+
+   Collisions are resolved with linear probing and deletion shifts the following entries back,
+   so the table never contains tombstones and lookups of missing keys stop at the first empty slot.
+ **/
+
+namespace impl
+{
+struct Group
+{
+    static constexpr u32 width = 16;
+    static constexpr u8 EMPTY  = 0x80;
+
+#if defined(MAP_USE_SSE2)
+    explicit Group(const u8 *ctrl)
+        : bytes{_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))}
+    {
+    }
+
+    // bitmask of the bytes equal to h2
+    u32 match(u8 h2) const
+    {
+        return static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(h2)))));
+    }
+
+    // bitmask of the empty bytes, EMPTY is the only control byte with its high bit set
+    u32 match_empty() const { return static_cast<u32>(_mm_movemask_epi8(bytes)); }
+
+    __m128i bytes;
+#else
+    explicit Group(const u8 *ctrl)
+        : bytes{ctrl}
+    {
+    }
+
+    u32 match(u8 h2) const
+    {
+        u32 mask = 0;
+        for (u32 i = 0; i < width; i += 1)
+        {
+            mask |= u32(bytes[i] == h2) << i;
+        }
+        return mask;
+    }
+
+    u32 match_empty() const { return match(EMPTY); }
+
+    const u8 *bytes;
+#endif
+};
+
+template <typename Key, typename Entry, typename KeyOf, typename Hash, typename KeyEqual> class HashTable
+{
+  public:
+    using key_type       = Key;
+    using value_type     = Entry;
+    using iterator       = typename Vec<Entry>::iterator;
+    using const_iterator = typename Vec<Entry>::const_iterator;
+
+    static constexpr usize min_capacity = Group::width;
+
+    void reserve(usize count)
+    {
+        entries.reserve(count);
+        hashes.reserve(count);
+        usize new_capacity = capacity();
+        while (count * max_load_den > new_capacity * max_load_num || new_capacity < min_capacity)
+        {
+            new_capacity = new_capacity ? new_capacity * 2 : min_capacity;
+        }
+        if (new_capacity != capacity())
+        {
+            rehash(new_capacity);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        hashes.clear();
+        if (!ctrl.empty())
+        {
+            ctrl.assign(ctrl.size(), Group::EMPTY);
+        }
+    }
+
+    iterator find(const Key &key)
+    {
+        u32 i = find_index(key, hash_key(key));
+        return i != u32_invalid ? entries.begin() + i : entries.end();
+    }
+
+    const_iterator find(const Key &key) const
+    {
+        u32 i = find_index(key, hash_key(key));
+        return i != u32_invalid ? entries.begin() + i : entries.end();
+    }
+
+    bool contains(const Key &key) const { return find_index(key, hash_key(key)) != u32_invalid; }
+
+    // Returns the number of erased entries (0 or 1), the last entry is moved into the erased one
+    usize erase(const Key &key)
+    {
+        u32 i = find_index(key, hash_key(key));
+        if (i == u32_invalid)
+        {
+            return 0;
+        }
+        erase_index(i);
+        return 1;
+    }
+
+    iterator begin() { return entries.begin(); }
+    const_iterator begin() const { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator end() const { return entries.end(); }
+
+    usize size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    usize capacity() const { return slots.size(); }
+
+  protected:
+    // entries.size() / capacity() must stay below max_load, linear probing degrades quickly past 3/4
+    static constexpr usize max_load_num = 3;
+    static constexpr usize max_load_den = 4;
+
+    static u64 hash_key(const Key &key)
+    {
+        // std::hash is the identity for integers on some platforms, mix the bits so that both h1 and h2 are usable
+        u64 h = u64(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    static u8 h2(u64 hash) { return static_cast<u8>(hash >> 57); }
+
+    usize mask() const { return slots.size() - 1; }
+
+    void set_ctrl(usize slot, u8 value)
+    {
+        ctrl[slot] = value;
+        // the first bytes are cloned after the end so that a group can be loaded from any slot
+        if (slot < Group::width - 1)
+        {
+            ctrl[slots.size() + slot] = value;
+        }
+    }
+
+    u32 find_index(const Key &key, u64 hash) const
+    {
+        if (entries.empty())
+        {
+            return u32_invalid;
+        }
+
+        u8 tag    = h2(hash);
+        usize pos = hash & mask();
+        while (true)
+        {
+            Group group{&ctrl[pos]};
+            for (u32 matches = group.match(tag); matches; matches &= matches - 1)
+            {
+                u32 i = slots[(pos + std::countr_zero(matches)) & mask()];
+                if (KeyEqual{}(KeyOf{}(entries[i]), key))
+                {
+                    return i;
+                }
+            }
+
+            if (group.match_empty())
+            {
+                return u32_invalid;
+            }
+            pos = (pos + Group::width) & mask();
+        }
+    }
+
+    usize find_empty_slot(u64 hash) const
+    {
+        usize pos = hash & mask();
+        while (true)
+        {
+            u32 empties = Group{&ctrl[pos]}.match_empty();
+            if (empties)
+            {
+                return (pos + std::countr_zero(empties)) & mask();
+            }
+            pos = (pos + Group::width) & mask();
+        }
+    }
+
+    usize find_slot_of_index(u32 i) const
+    {
+        usize pos = hashes[i] & mask();
+        while (ctrl[pos] == Group::EMPTY || slots[pos] != i)
+        {
+            assert(ctrl[pos] != Group::EMPTY);
+            pos = (pos + 1) & mask();
+        }
+        return pos;
+    }
+
+    void rehash(usize new_capacity)
+    {
+        assert(std::has_single_bit(new_capacity) && new_capacity >= min_capacity);
+        ctrl.assign(new_capacity + Group::width, Group::EMPTY);
+        slots.assign(new_capacity, u32_invalid);
+        for (u32 i = 0; i < static_cast<u32>(entries.size()); i += 1)
+        {
+            usize slot = find_empty_slot(hashes[i]);
+            set_ctrl(slot, h2(hashes[i]));
+            slots[slot] = i;
+        }
+    }
+
+    // Returns the index of the entry with this key and whether it was inserted
+    template <typename... Args> std::pair<u32, bool> emplace_internal(const Key &key, Args &&...args)
+    {
+        u64 hash = hash_key(key);
+        u32 i    = find_index(key, hash);
+        if (i != u32_invalid)
+        {
+            return {i, false};
+        }
+
+        if ((entries.size() + 1) * max_load_den > capacity() * max_load_num)
+        {
+            rehash(capacity() ? capacity() * 2 : min_capacity);
+        }
+
+        i = static_cast<u32>(entries.size());
+        entries.emplace_back(std::forward<Args>(args)...);
+        hashes.push_back(hash);
+
+        usize slot = find_empty_slot(hash);
+        set_ctrl(slot, h2(hash));
+        slots[slot] = i;
+        return {i, true};
+    }
+
+    void erase_index(u32 i)
+    {
+        // Shift the following slots back until an empty slot or a slot that is already at its ideal position
+        usize hole = find_slot_of_index(i);
+        for (usize j = (hole + 1) & mask(); ctrl[j] != Group::EMPTY; j = (j + 1) & mask())
+        {
+            usize home = hashes[slots[j]] & mask();
+            if (((j - home) & mask()) >= ((j - hole) & mask()))
+            {
+                set_ctrl(hole, ctrl[j]);
+                slots[hole] = slots[j];
+                hole        = j;
+            }
+        }
+        set_ctrl(hole, Group::EMPTY);
+
+        // Move the last entry into the hole
+        u32 last = static_cast<u32>(entries.size() - 1);
+        if (i != last)
+        {
+            slots[find_slot_of_index(last)] = i;
+            entries[i]                      = std::move(entries[last]);
+            hashes[i]                       = hashes[last];
+        }
+        entries.pop_back();
+        hashes.pop_back();
+    }
+
+    Vec<Entry> entries;
+    Vec<u64> hashes; // hash of each entry, used to rehash and shift slots without hashing keys again
+    Vec<u32> slots;  // index of the entry in each slot, only meaningful when its control byte is not EMPTY
+    Vec<u8> ctrl;    // capacity + Group::width control bytes
+};
+
+struct MapKeyOf
+{
+    template <typename Entry> const auto &operator()(const Entry &entry) const { return entry.first; }
+};
+
+struct SetKeyOf
+{
+    template <typename Entry> const Entry &operator()(const Entry &entry) const { return entry; }
+};
+} // namespace impl
+
+/// --- Hash map
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class Map : public impl::HashTable<K, std::pair<K, V>, impl::MapKeyOf, Hash, KeyEqual>
+{
+    using Base = impl::HashTable<K, std::pair<K, V>, impl::MapKeyOf, Hash, KeyEqual>;
+
+  public:
+    using mapped_type = V;
+    using typename Base::const_iterator;
+    using typename Base::iterator;
+
+    Map() = default;
+    Map(std::initializer_list<std::pair<K, V>> list)
+    {
+        this->reserve(list.size());
+        for (const auto &entry : list)
+        {
+            insert(entry);
+        }
+    }
+
+    template <typename... Args> std::pair<iterator, bool> try_emplace(const K &key, Args &&...args)
+    {
+        auto [i, inserted] = this->emplace_internal(key,
+                                                    std::piecewise_construct,
+                                                    std::forward_as_tuple(key),
+                                                    std::forward_as_tuple(std::forward<Args>(args)...));
+        return {this->entries.begin() + i, inserted};
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<K, V> &entry) { return try_emplace(entry.first, entry.second); }
+
+    template <typename Value> std::pair<iterator, bool> insert_or_assign(const K &key, Value &&value)
+    {
+        auto result = try_emplace(key, std::forward<Value>(value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<Value>(value);
+        }
+        return result;
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+
+    V &at(const K &key)
+    {
+        u32 i = this->find_index(key, this->hash_key(key));
+        assert(i != u32_invalid);
+        return this->entries[i].second;
+    }
+
+    const V &at(const K &key) const
+    {
+        u32 i = this->find_index(key, this->hash_key(key));
+        assert(i != u32_invalid);
+        return this->entries[i].second;
+    }
+};
+
+/// --- Hash set
+template <typename K, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class Set : public impl::HashTable<K, K, impl::SetKeyOf, Hash, KeyEqual>
+{
+    using Base = impl::HashTable<K, K, impl::SetKeyOf, Hash, KeyEqual>;
+
+  public:
+    using iterator = typename Base::const_iterator; // keys cannot be modified in place
+
+    Set() = default;
+    Set(std::initializer_list<K> list)
+    {
+        this->reserve(list.size());
+        for (const auto &key : list)
+        {
+            insert(key);
+        }
+    }
+
+    std::pair<iterator, bool> insert(const K &key)
+    {
+        auto [i, inserted] = this->emplace_internal(key, key);
+        return {this->entries.cbegin() + i, inserted};
+    }
+
+    iterator find(const K &key) const { return Base::find(key); }
+    iterator begin() const { return Base::begin(); }
+    iterator end() const { return Base::end(); }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "exo/numerics.h"
+#include "exo/collections/vector.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+   The memory tracker counts the bytes allocated per tag: current size, peak size and number of allocations.
+   Counters are relaxed atomics, one cache line per tag, so threads can update them without locks.
+   A tag is a type with a `static constexpr const char *name`, it is registered the first time it is used:
+       struct MeshMemory { static constexpr const char *name = "Meshes"; };
+       TaggedVec<MeshMemory, float4> positions;
+   Memory that is not allocated on the heap (mapped GPU memory) can be reported with on_allocate/on_free.
+ **/
+namespace memory_tracker
+{
+inline constexpr u32 MAX_TAGS = 64;
+
+struct TagStats
+{
+    const char *name;
+    u64 current;
+    u64 peak;
+    u64 allocation_count;
+};
+
+u32 register_tag(const char *name);
+
+void on_allocate(u32 tag, usize size);
+void on_free(u32 tag, usize size);
+
+Vec<TagStats> stats();
+// one line per tag, for logs
+std::string dump();
+
+template <typename Tag> inline u32 tag_index()
+{
+    static const u32 index = register_tag(Tag::name);
+    return index;
+}
+} // namespace memory_tracker
+
+/// --- Allocator adapter to count the memory of std containers in a tag
+template <typename T, typename Tag> struct TaggedAllocator
+{
+    using value_type = T;
+    template <typename U> struct rebind
+    {
+        using other = TaggedAllocator<U, Tag>;
+    };
+
+    TaggedAllocator() = default;
+    template <typename U> TaggedAllocator(const TaggedAllocator<U, Tag> &) {}
+
+    T *allocate(usize n)
+    {
+        memory_tracker::on_allocate(memory_tracker::tag_index<Tag>(), n * sizeof(T));
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *ptr, usize n)
+    {
+        memory_tracker::on_free(memory_tracker::tag_index<Tag>(), n * sizeof(T));
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    template <typename U> bool operator==(const TaggedAllocator<U, Tag> &) const { return true; }
+};
+
+template <typename Tag, typename T> using TaggedVec = std::vector<T, TaggedAllocator<T, Tag>>;
@@ -0,0 +1,84 @@
+#pragma once
+#include "exo/numerics.h"
+#include "exo/collections/vector.h"
+
+/**
+   An OffsetAllocator sub-allocates ranges of an external resource (a GPU buffer, a staging area...).
+   It is a two-level segregated fit allocator (TLSF): free ranges are sorted in 256 bins whose sizes are
+   8-bit floats (5 bits exponent, 3 bits mantissa), a 32-bit mask tells which top bins are used and 32 8-bit
+   masks tell which bins are used, so finding a free range large enough is two find-first-set.
+   Performance:
+     allocate() and free() are O(1), freeing merges the range with its free neighbours.
+     Allocations are rounded to the bin sizes, the waste is at most 1/8 of the allocation.
+   The managed memory is never touched, all the bookkeeping lives in CPU-side nodes.
+ **/
+
+struct OffsetAllocation
+{
+    u32 offset = u32_invalid;
+    u32 node   = u32_invalid; // metadata used to free the allocation
+
+    bool is_valid() const { return node != u32_invalid; }
+};
+
+struct OffsetAllocatorStats
+{
+    u32 size                = 0;
+    u32 free_space          = 0;
+    u32 largest_free_region = 0;
+    u32 free_region_count   = 0;
+    u32 allocation_count    = 0;
+
+    // 0 when the free space is a single region, close to 1 when it is split in many small regions
+    float fragmentation() const
+    {
+        return free_space ? 1.0f - float(largest_free_region) / float(free_space) : 0.0f;
+    }
+};
+
+class OffsetAllocator
+{
+public:
+    static constexpr u32 TOP_BIN_COUNT  = 32;
+    static constexpr u32 BINS_PER_LEAF  = 8;
+    static constexpr u32 LEAF_BIN_COUNT = TOP_BIN_COUNT * BINS_PER_LEAF;
+
+    static OffsetAllocator create(u32 size);
+
+    // returns an invalid allocation when there is no free range large enough, alignment has to be a power of 2
+    OffsetAllocation allocate(u32 size, u32 alignment = 1);
+    void free(OffsetAllocation allocation);
+    void reset();
+
+    // size of the range that was allocated (including the alignment padding)
+    u32 allocation_size(OffsetAllocation allocation) const;
+    OffsetAllocatorStats get_stats() const;
+
+private:
+    struct Node
+    {
+        u32 data_offset   = 0;
+        u32 data_size     = 0;
+        u32 bin_list_prev = u32_invalid;
+        u32 bin_list_next = u32_invalid;
+        u32 neighbor_prev = u32_invalid;
+        u32 neighbor_next = u32_invalid;
+        bool used         = false;
+    };
+
+    u32 insert_node_into_bin(u32 size, u32 data_offset);
+    void remove_node_from_bin(u32 node_index);
+    u32 new_node();
+
+    u32 size = 0;
+    u32 free_space = 0;
+    u32 free_region_count = 0;
+    u32 allocation_count = 0;
+
+    u32 used_bins_top = 0;
+    u8 used_bins[TOP_BIN_COUNT] = {};
+    u32 bin_indices[LEAF_BIN_COUNT] = {}; // first node of each bin
+
+    Vec<Node> nodes;
+    Vec<u32> free_nodes;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "exo/numerics.h"
+
+#include <chrono>
+#include <string>
+
+/**
+   CPU scope profiler: PROFILE_SCOPE("name") records the start and end of the enclosing scope.
+   Each thread writes its scopes to its own ring buffer without locks, the oldest scopes are overwritten when it is full.
+   The buffer of an exited thread is exported until a new thread reuses it.
+   The name has to be a string literal (or live as long as the program), only the pointer is stored.
+   Scopes are exported to the Chrome trace JSON format, open it with chrome://tracing or https://ui.perfetto.dev.
+   Without EXO_ENABLE_PROFILER the macros expand to nothing.
+ **/
+namespace profiler
+{
+// number of scopes kept per thread, a power of 2
+inline constexpr u32 EVENTS_PER_THREAD = 64 * 1024;
+
+// nanoseconds from steady_clock, the TSC is not used because its frequency would need to be calibrated
+inline u64 now_ns()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record(const char *name, u64 start_ns, u64 end_ns);
+
+struct Scope
+{
+    Scope(const char *_name) : name{_name}, start_ns{now_ns()} {}
+    ~Scope() { record(name, start_ns, now_ns()); }
+
+    Scope(const Scope &)            = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    const char *name;
+    u64 start_ns;
+};
+
+// Chrome trace JSON with the scopes of every thread still in the ring buffers, at most EVENTS_PER_THREAD - 1 per thread
+std::string to_chrome_trace();
+bool write_chrome_trace(const char *path);
+// drops all the recorded scopes, must not be called while other threads record
+void clear();
+} // namespace profiler
+
+#define PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define PROFILE_CONCAT(a, b)          PROFILE_CONCAT_INTERNAL(a, b)
+
+#if defined(EXO_ENABLE_PROFILER)
+#define PROFILE_SCOPE(name) const profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__){name}
+#define PROFILE_FUNCTION()  PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+#include "exo/numerics.h"
+
+#include <span>
+
+/**
+   Radix sorts for integer keys with a u32 payload, the payload is usually an index into the sorted elements.
+   radix_sort() is a stable LSD sort that ping-pongs between the input and a scratch buffer of the same size, the
+   result ends in the input spans. It counts the digits of every pass in a single read and skips the passes where
+   all the keys have the same digit (the high bytes of small keys).
+   radix_sort_in_place() is an MSD "American flag" sort that swaps the elements inside their buckets, it needs no
+   scratch memory but is not stable.
+   Both split the work with the job system for large inputs when it is initialized.
+ **/
+
+void radix_sort(std::span<u32> keys, std::span<u32> values, std::span<u32> keys_scratch, std::span<u32> values_scratch);
+void radix_sort(std::span<u64> keys, std::span<u32> values, std::span<u64> keys_scratch, std::span<u32> values_scratch);
+
+void radix_sort_in_place(std::span<u32> keys, std::span<u32> values);
+void radix_sort_in_place(std::span<u64> keys, std::span<u32> values);
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+   Minimal 4-wide float abstraction used to implement the float4 / float4x4 maths in vectors.h.
+   The backend is selected at compile time:
+     SIMD_USE_SSE   SSE2 (always available on x64), SIMD_USE_AVX is also defined when compiling with AVX
+     SIMD_USE_NEON  arm64
+     SIMD_USE_SCALAR plain floats, can be forced with SIMD_FORCE_SCALAR
+   Multiplies and adds are never fused explicitly: every backend computes the same operations in the
+   same order, so the results are identical to the scalar code.
+   Loads and stores are unaligned, float4x4 is stored in packed GPU structs and cannot be over-aligned.
+ **/
+
+#if !defined(SIMD_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SIMD_USE_SSE
+#if defined(__AVX__)
+#define SIMD_USE_AVX
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#elif !defined(SIMD_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#define SIMD_USE_NEON
+#include <arm_neon.h>
+#else
+#define SIMD_USE_SCALAR
+#endif
+
+namespace simd
+{
+#if defined(SIMD_USE_SSE)
+
+using f32x4 = __m128;
+
+inline f32x4 load(const float *p) { return _mm_loadu_ps(p); }
+inline void store(float *p, f32x4 v) { _mm_storeu_ps(p, v); }
+inline f32x4 splat(float f) { return _mm_set1_ps(f); }
+inline f32x4 add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+
+// returns v[i] in all lanes
+template <int i>
+inline f32x4 broadcast(f32x4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i)); }
+
+inline void transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+
+#elif defined(SIMD_USE_NEON)
+
+using f32x4 = float32x4_t;
+
+inline f32x4 load(const float *p) { return vld1q_f32(p); }
+inline void store(float *p, f32x4 v) { vst1q_f32(p, v); }
+inline f32x4 splat(float f) { return vdupq_n_f32(f); }
+inline f32x4 add(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+inline f32x4 sub(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+inline f32x4 mul(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+
+template <int i>
+inline f32x4 broadcast(f32x4 v) { return vdupq_laneq_f32(v, i); }
+
+inline void transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d)
+{
+    float32x4x2_t ab = vtrnq_f32(a, b); // (a0 b0 a2 b2) (a1 b1 a3 b3)
+    float32x4x2_t cd = vtrnq_f32(c, d); // (c0 d0 c2 d2) (c1 d1 c3 d3)
+    a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+struct f32x4
+{
+    float v[4];
+};
+
+inline f32x4 load(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void store(float *p, f32x4 v) { for (int i = 0; i < 4; i += 1) { p[i] = v.v[i]; } }
+inline f32x4 splat(float f) { return {{f, f, f, f}}; }
+inline f32x4 add(f32x4 a, f32x4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline f32x4 sub(f32x4 a, f32x4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline f32x4 mul(f32x4 a, f32x4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+
+template <int i>
+inline f32x4 broadcast(f32x4 v) { return splat(v.v[i]); }
+
+inline void transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d)
+{
+    f32x4 ta = {{a.v[0], b.v[0], c.v[0], d.v[0]}};
+    f32x4 tb = {{a.v[1], b.v[1], c.v[1], d.v[1]}};
+    f32x4 tc = {{a.v[2], b.v[2], c.v[2], d.v[2]}};
+    f32x4 td = {{a.v[3], b.v[3], c.v[3], d.v[3]}};
+    a = ta;
+    b = tb;
+    c = tc;
+    d = td;
+}
+
+#endif
+
+// Linear combination of 4 columns: c0 * w[0] + c1 * w[1] + c2 * w[2] + c3 * w[3], summed in this order
+inline f32x4 combine(f32x4 c0, f32x4 c1, f32x4 c2, f32x4 c3, f32x4 w)
+{
+    f32x4 result = mul(c0, broadcast<0>(w));
+    result       = add(result, mul(c1, broadcast<1>(w)));
+    result       = add(result, mul(c2, broadcast<2>(w)));
+    result       = add(result, mul(c3, broadcast<3>(w)));
+    return result;
+}
+
+// Multiplies two column-major 4x4 matrices: out = a * b, the columns of `a` are already loaded
+inline void mat4_mul(f32x4 a0, f32x4 a1, f32x4 a2, f32x4 a3, const float *b, float *out)
+{
+#if defined(SIMD_USE_AVX)
+    // Two columns of the result per iteration, each 128-bit lane computes one column
+    __m256 a0x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(a0), a0, 1);
+    __m256 a1x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(a1), a1, 1);
+    __m256 a2x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(a2), a2, 1);
+    __m256 a3x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(a3), a3, 1);
+    for (int col = 0; col < 4; col += 2)
+    {
+        __m256 b_cols = _mm256_loadu_ps(b + 4 * col);
+        __m256 result = _mm256_mul_ps(a0x2, _mm256_permute_ps(b_cols, 0x00));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(a1x2, _mm256_permute_ps(b_cols, 0x55)));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(a2x2, _mm256_permute_ps(b_cols, 0xAA)));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(a3x2, _mm256_permute_ps(b_cols, 0xFF)));
+        _mm256_storeu_ps(out + 4 * col, result);
+    }
+#else
+    // load all of b first, out can be b
+    f32x4 b0 = load(b + 0);
+    f32x4 b1 = load(b + 4);
+    f32x4 b2 = load(b + 8);
+    f32x4 b3 = load(b + 12);
+    store(out + 0, combine(a0, a1, a2, a3, b0));
+    store(out + 4, combine(a0, a1, a2, a3, b1));
+    store(out + 8, combine(a0, a1, a2, a3, b2));
+    store(out + 12, combine(a0, a1, a2, a3, b3));
+#endif
+}
+
+// Multiplies two column-major 4x4 matrices: out = a * b
+inline void mat4_mul(const float *a, const float *b, float *out)
+{
+    mat4_mul(load(a + 0), load(a + 4), load(a + 8), load(a + 12), b, out);
+}
+
+// Multiplies a column-major 4x4 matrix with a vector: out = m * v
+inline void mat4_mul_vec4(const float *m, const float *v, float *out)
+{
+    store(out, combine(load(m + 0), load(m + 4), load(m + 8), load(m + 12), load(v)));
+}
+} // namespace simd
@@ -0,0 +1,57 @@
+#pragma once
+#include "exo/numerics.h"
+
+#include <bit>
+#include <cassert>
+
+/**
+   Helpers to pack the state of a draw into a 64-bit key, sorting the keys groups the draws by pipeline, then
+   material, then mesh, and orders each group by depth:
+       | pipeline (8) | material (16) | mesh (16) | depth (24) |
+   The depth is the top bits of the float, a positive float compares like its bit pattern.
+ **/
+namespace sort_key
+{
+inline constexpr u32 PIPELINE_BITS = 8;
+inline constexpr u32 MATERIAL_BITS = 16;
+inline constexpr u32 MESH_BITS     = 16;
+inline constexpr u32 DEPTH_BITS    = 24;
+
+inline constexpr u32 DEPTH_SHIFT    = 0;
+inline constexpr u32 MESH_SHIFT     = DEPTH_SHIFT + DEPTH_BITS;
+inline constexpr u32 MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+inline constexpr u32 PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+static_assert(PIPELINE_SHIFT + PIPELINE_BITS == 64);
+
+struct Draw
+{
+    u32 pipeline       = 0;
+    u32 material       = 0;
+    u32 mesh           = 0;
+    float depth        = 0.0f; // distance to the camera
+    bool back_to_front = false; // for blended draws
+};
+
+// Maps a depth to `bit_count` bits that sort like the depth, negative depths (behind the camera) map to 0
+inline u32 depth_bits(float depth, u32 bit_count)
+{
+    // !(depth > 0) also catches NaN
+    u32 bits = !(depth > 0.0f) ? 0u : std::bit_cast<u32>(depth);
+    return bits >> (32 - bit_count);
+}
+
+inline u64 draw(const Draw &draw)
+{
+    assert(draw.pipeline < (1u << PIPELINE_BITS));
+    assert(draw.material < (1u << MATERIAL_BITS));
+    assert(draw.mesh < (1u << MESH_BITS));
+
+    u64 depth = depth_bits(draw.depth, DEPTH_BITS);
+    if (draw.back_to_front)
+    {
+        depth = ~depth & ((1u << DEPTH_BITS) - 1);
+    }
+
+    return u64(draw.pipeline) << PIPELINE_SHIFT | u64(draw.material) << MATERIAL_SHIFT | u64(draw.mesh) << MESH_SHIFT | depth << DEPTH_SHIFT;
+}
+} // namespace sort_key
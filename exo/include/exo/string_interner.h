@@ -0,0 +1,95 @@
+#pragma once
+#include "exo/types.h"
+#include "exo/hash.h"
+#include "exo/map.h"
+#include "exo/collections/vector.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/**
+   A StringInterner stores each distinct string once and identifies it with a 32-bit id.
+   Strings are copied null-terminated into 64 KiB chunks that are never freed or moved, their views stay valid
+   as long as the interner. Interning is a hash lookup under a lock, id -> string is an O(1) lock-free read.
+   StringId is an id in the global interner: names are compared as integers and are never freed.
+ **/
+struct StringInterner
+{
+    static constexpr usize CHUNK_SIZE     = 64_KiB;
+    static constexpr u32 ENTRIES_PER_PAGE = 4096;
+    static constexpr u32 MAX_PAGES        = 4096;
+
+    StringInterner() = default;
+    ~StringInterner();
+    StringInterner(const StringInterner &)            = delete;
+    StringInterner &operator=(const StringInterner &) = delete;
+
+    static StringInterner &global();
+
+    u32 intern(std::string_view str);
+    // returns u32_invalid if the string was never interned
+    u32 find(std::string_view str) const;
+
+    std::string_view view(u32 id) const;
+    const char *c_str(u32 id) const;
+    u32 size() const { return count.load(std::memory_order_acquire); }
+
+  private:
+    struct Entry
+    {
+        const char *str;
+        u32 length;
+    };
+
+    struct StringHash
+    {
+        usize operator()(std::string_view str) const { return static_cast<usize>(hash_bytes(str.data(), str.size())); }
+    };
+
+    const char *store(std::string_view str);
+
+    mutable std::mutex mutex;
+    Map<std::string_view, u32, StringHash> lookup;
+    // every allocation, the chunks and the big strings
+    Vec<char *> chunks;
+    // the chunk where small strings are written
+    char *current_chunk = nullptr;
+    usize chunk_offset  = CHUNK_SIZE;
+    std::atomic<Entry *> pages[MAX_PAGES] = {};
+    std::atomic<u32> count                = 0;
+};
+
+struct StringId
+{
+    StringId() = default;
+    StringId(std::string_view str) : value{StringInterner::global().intern(str)} {}
+    StringId(const char *str) : StringId{std::string_view{str}} {}
+    StringId(const std::string &str) : StringId{std::string_view{str}} {}
+
+    // returns an invalid id if the string was never interned
+    static StringId find(std::string_view str)
+    {
+        StringId id;
+        id.value = StringInterner::global().find(str);
+        return id;
+    }
+
+    bool is_valid() const { return value != u32_invalid; }
+    // an invalid id is the empty string
+    std::string_view view() const { return is_valid() ? StringInterner::global().view(value) : std::string_view{}; }
+    const char *c_str() const { return is_valid() ? StringInterner::global().c_str(value) : ""; }
+
+    bool operator==(const StringId &other) const = default;
+
+    u32 value = u32_invalid;
+};
+
+namespace std
+{
+template <> struct hash<StringId>
+{
+    std::size_t operator()(const StringId &id) const noexcept { return static_cast<std::size_t>(hash_u64(id.value)); }
+};
+} // namespace std
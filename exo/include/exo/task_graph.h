@@ -0,0 +1,64 @@
+#pragma once
+#include "exo/numerics.h"
+#include "exo/jobs.h"
+#include "exo/time.h"
+#include "exo/collections/vector.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+
+/**
+   A TaskGraph is a set of tasks and dependencies between them, built once and executed every frame.
+   A task starts as soon as all the tasks it depends on are done, independent tasks run in parallel on the job system.
+   Tasks marked main_thread only run on the thread calling execute(), for APIs that are not thread-safe (window, ImGui, vulkan queue).
+   execute() returns when every task is done, the timings of the last execution are kept in each task.
+ **/
+using TaskId = u32;
+
+struct TaskTiming
+{
+    // relative to the start of execute()
+    double start_ms    = 0.0;
+    double duration_ms = 0.0;
+    u32 thread_index   = u32_invalid;
+};
+
+struct TaskGraph
+{
+    struct Task
+    {
+        std::string name;
+        std::function<void()> function;
+        Vec<TaskId> successors;
+        u32 dependency_count = 0;
+        bool main_thread     = false;
+
+        // number of dependencies not done yet during execute()
+        u32 remaining     = 0;
+        TaskTiming timing = {};
+    };
+
+    TaskId add_task(std::string name, std::function<void()> function, bool main_thread = false);
+    // `after` starts when `before` is done, a task can only depend on tasks added before it so the graph has no cycles
+    void add_dependency(TaskId before, TaskId after);
+
+    void execute();
+
+    // Graphviz representation of the graph with the timings of the last execution
+    std::string to_dot() const;
+
+    Vec<Task> tasks;
+
+  private:
+    void schedule(TaskId id);
+    void run_task(TaskId id);
+
+    TimePoint start_time;
+    std::atomic<u32> tasks_left = 0;
+    jobs::Counter counter       = {};
+
+    std::mutex main_thread_mutex;
+    Vec<TaskId> main_thread_ready;
+};
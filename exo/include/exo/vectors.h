@@ -1,5 +1,8 @@
 #pragma once
 #include "exo/numerics.h"
+#include "exo/simd.h"
+#include <cassert>
+#include <cmath>
 #include <iosfwd>
 
 struct float3;
@@ -170,12 +173,6 @@ static_assert(sizeof(float3) == 3 * sizeof(float));
 static_assert(sizeof(float4) == 4 * sizeof(float));
 static_assert(sizeof(float4x4) == 4 * sizeof(float4));
 
-float dot(const float2 &a, const float2 &b);
-float dot(const float3 &a, const float3 &b);
-float dot(const float4 &a, const float4 &b);
-float2 normalize(const float2 &v);
-float3 normalize(const float3 &v);
-float4 normalize(const float4 &v);
 float2 round(const float2 &v);
 float3 round(const float3 &v);
 float4 round(const float4 &v);
@@ -200,14 +197,127 @@ float4 operator-(const float4 &a, const float4 &b);
 float4 operator*(const float4 &a, const float4 &b);
 float4 operator*(const float a, const float4 &v);
 
-float4x4 transpose(const float4x4 &m);
-
 bool operator==(const float4x4 &a, const float4x4 &b);
-float4x4 operator+(const float4x4 &a, const float4x4 &b);
-float4x4 operator-(const float4x4 &a, const float4x4 &b);
-float4x4 operator*(float a, const float4x4 &m);
-float4x4 operator*(const float4x4 &a, const float4x4 &b);
-float4 operator*(const float4x4 &m, const float4 &v);
+
+/// --- Inlined hot paths, the matrix operations are implemented with exo/simd.h
+
+// clang-format off
+inline float dot(const float2 &a, const float2 &b) { return a.x*b.x + a.y*b.y; }
+inline float dot(const float3 &a, const float3 &b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+inline float dot(const float4 &a, const float4 &b) { return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w; }
+
+inline float float2::squared_norm() const { return dot(*this, *this); }
+inline float float3::squared_norm() const { return dot(*this, *this); }
+inline float float4::squared_norm() const { return dot(*this, *this); }
+inline float float2::norm() const { return std::sqrt(squared_norm()); }
+inline float float3::norm() const { return std::sqrt(squared_norm()); }
+inline float float4::norm() const { return std::sqrt(squared_norm()); }
+
+inline float2 normalize(const float2 &v) { return (1.0f / v.norm()) * v; }
+inline float3 normalize(const float3 &v) { return (1.0f / v.norm()) * v; }
+inline float4 normalize(const float4 &v) { return (1.0f / v.norm()) * v; }
+// clang-format on
+
+inline float4x4::float4x4(float value)
+{
+    for (auto &uninit : values) {
+        uninit = 0.0f;
+    }
+
+    values[0] = value;
+    values[5] = value;
+    values[10] = value;
+    values[15] = value;
+}
+
+inline float4x4 float4x4::identity()
+{
+    return float4x4(1.0f);
+}
+
+inline const float &float4x4::at(usize row, usize col) const
+{
+    assert(row < 4 && col < 4);
+    // values are stored in columns
+    return values[col * 4 + row];
+}
+
+inline float &float4x4::at(usize row, usize col)
+{
+    assert(row < 4 && col < 4);
+    // values are stored in columns
+    return values[col * 4 + row];
+}
+
+inline const float4 &float4x4::col(usize col) const
+{
+    assert(col < 4);
+    return *reinterpret_cast<const float4*>(&values[col * 4]);
+}
+
+inline float4 &float4x4::col(usize col)
+{
+    assert(col < 4);
+    return *reinterpret_cast<float4*>(&values[col * 4]);
+}
+
+inline float4x4 transpose(const float4x4 &m)
+{
+    auto c0 = simd::load(m.values + 0);
+    auto c1 = simd::load(m.values + 4);
+    auto c2 = simd::load(m.values + 8);
+    auto c3 = simd::load(m.values + 12);
+    simd::transpose(c0, c1, c2, c3);
+
+    float4x4 result;
+    simd::store(result.values + 0, c0);
+    simd::store(result.values + 4, c1);
+    simd::store(result.values + 8, c2);
+    simd::store(result.values + 12, c3);
+    return result;
+}
+
+inline float4x4 operator+(const float4x4 &a, const float4x4 &b)
+{
+    float4x4 result;
+    for (usize i = 0; i < 16; i += 4) {
+        simd::store(result.values + i, simd::add(simd::load(a.values + i), simd::load(b.values + i)));
+    }
+    return result;
+}
+
+inline float4x4 operator-(const float4x4 &a, const float4x4 &b)
+{
+    float4x4 result;
+    for (usize i = 0; i < 16; i += 4) {
+        simd::store(result.values + i, simd::sub(simd::load(a.values + i), simd::load(b.values + i)));
+    }
+    return result;
+}
+
+inline float4x4 operator*(float a, const float4x4 &m)
+{
+    float4x4 result;
+    auto factor = simd::splat(a);
+    for (usize i = 0; i < 16; i += 4) {
+        simd::store(result.values + i, simd::mul(factor, simd::load(m.values + i)));
+    }
+    return result;
+}
+
+inline float4x4 operator*(const float4x4 &a, const float4x4 &b)
+{
+    float4x4 result;
+    simd::mat4_mul(a.values, b.values, result.values);
+    return result;
+}
+
+inline float4 operator*(const float4x4 &m, const float4 &v)
+{
+    float4 result;
+    simd::mat4_mul_vec4(m.values, v.raw, result.raw);
+    return result;
+}
 
 inline constexpr auto float3_RIGHT   = float3(1, 0, 0);
 inline constexpr auto float3_UP      = float3(0, 1, 0);
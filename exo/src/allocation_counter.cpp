@@ -0,0 +1,178 @@
+#include "exo/allocation_counter.h"
+
+#if defined(EXO_COUNT_HEAP_ALLOCATIONS) && !defined(NDEBUG)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every form of the global operator new and delete is replaced, the allocations and deallocations have to go through
+// the same allocator for the sanitizers.
+
+static std::atomic<u64> heap_allocation_count = 0;
+
+static void *allocate(std::size_t size) noexcept
+{
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void *allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept
+{
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc needs a size that is a multiple of the alignment
+    return std::aligned_alloc(align, size ? (size + align - 1) & ~(align - 1) : align);
+#endif
+}
+
+static void deallocate_aligned(void *ptr) noexcept
+{
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *ptr = allocate(size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *ptr = allocate_aligned(size, alignment))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate_aligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate_aligned(size, alignment);
+}
+
+// GCC warns about free() on the pointers of operator new once both are inlined in the tests below
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::align_val_t) noexcept { deallocate_aligned(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { deallocate_aligned(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { deallocate_aligned(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { deallocate_aligned(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deallocate_aligned(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept { deallocate_aligned(ptr); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace allocation_counter
+{
+u64 heap_allocations()
+{
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+}
+
+#else
+
+namespace allocation_counter
+{
+u64 heap_allocations()
+{
+    return 0;
+}
+}
+
+#endif
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace test
+{
+    TEST_CASE("Allocation counter")
+    {
+        u64 before = allocation_counter::heap_allocations();
+        std::vector<u32> values;
+        values.push_back(1);
+        u64 after = allocation_counter::heap_allocations();
+#if defined(EXO_COUNT_HEAP_ALLOCATIONS) && !defined(NDEBUG)
+        CHECK(after > before);
+#else
+        CHECK(after == before);
+#endif
+    }
+
+    TEST_CASE("Allocation counter overloads")
+    {
+        // every form of new is matched by its delete
+        struct alignas(64) Aligned
+        {
+            u8 bytes[64];
+        };
+
+        u64 before = allocation_counter::heap_allocations();
+        delete new u32(1);
+        delete[] new u32[4];
+        delete new (std::nothrow) u32(1);
+        delete[] new (std::nothrow) u32[4];
+        auto aligned = std::make_unique<Aligned>();
+        CHECK(reinterpret_cast<usize>(aligned.get()) % alignof(Aligned) == 0);
+        aligned.reset();
+        auto *aligned_array = new (std::nothrow) Aligned[3];
+        CHECK(reinterpret_cast<usize>(aligned_array) % alignof(Aligned) == 0);
+        delete[] aligned_array;
+        u64 after = allocation_counter::heap_allocations();
+#if defined(EXO_COUNT_HEAP_ALLOCATIONS) && !defined(NDEBUG)
+        CHECK(after - before == 6);
+#else
+        CHECK(after == before);
+#endif
+    }
+}
+#endif
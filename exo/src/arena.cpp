@@ -0,0 +1,125 @@
+#include "exo/arena.h"
+
+#include "exo/algorithms.h"
+
+#include <cstdlib>
+#include <cassert>
+
+// Overflow blocks are linked through a header placed before the allocation
+struct OverflowHeader
+{
+    void *next;
+    usize size;
+};
+
+Arena Arena::create(usize capacity)
+{
+    Arena arena;
+    arena.base     = reinterpret_cast<u8 *>(std::malloc(capacity));
+    arena.capacity = capacity;
+    return arena;
+}
+
+void Arena::destroy()
+{
+    reset();
+    std::free(this->base);
+    *this = {};
+}
+
+void *Arena::allocate(usize size, usize alignment)
+{
+    assert(alignment <= alignof(std::max_align_t) && (alignment & (alignment - 1)) == 0);
+
+    usize aligned_offset = round_up_to_alignment(alignment, this->offset);
+    if (aligned_offset + size <= this->capacity)
+    {
+        this->offset = aligned_offset + size;
+        return this->base + aligned_offset;
+    }
+
+    // The arena is full, fallback to the heap until the next reset
+    usize header_size = round_up_to_alignment(alignof(std::max_align_t), sizeof(OverflowHeader));
+    auto *block       = reinterpret_cast<u8 *>(std::malloc(header_size + size));
+    auto *header      = reinterpret_cast<OverflowHeader *>(block);
+    header->next      = this->overflow_blocks;
+    header->size      = size;
+
+    this->overflow_blocks = block;
+    this->overflow_size += size + alignment;
+    return block + header_size;
+}
+
+void Arena::reset()
+{
+    for (void *block = this->overflow_blocks; block != nullptr;)
+    {
+        void *next = reinterpret_cast<OverflowHeader *>(block)->next;
+        std::free(block);
+        block = next;
+    }
+    this->overflow_blocks = nullptr;
+
+    // Grow the arena to fit everything that was allocated since the last reset
+    if (this->overflow_size != 0)
+    {
+        std::free(this->base);
+        this->capacity      = 2 * (this->capacity + this->overflow_size);
+        this->base          = reinterpret_cast<u8 *>(std::malloc(this->capacity));
+        this->overflow_size = 0;
+    }
+
+    this->offset = 0;
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+
+namespace test
+{
+    TEST_CASE("Arena")
+    {
+        auto arena = Arena::create(64);
+
+        auto *a = reinterpret_cast<u8 *>(arena.allocate(1, 1));
+        auto *b = reinterpret_cast<u32 *>(arena.allocate(sizeof(u32), alignof(u32)));
+        CHECK(a == arena.base);
+        CHECK(reinterpret_cast<usize>(b) % alignof(u32) == 0);
+        CHECK(reinterpret_cast<u8 *>(b) == arena.base + 4);
+
+        // Allocations that don't fit go to the heap
+        auto *c = arena.allocate(128);
+        CHECK(c != nullptr);
+        CHECK(arena.overflow_blocks != nullptr);
+
+        // and the arena grows on reset
+        arena.reset();
+        CHECK(arena.offset == 0);
+        CHECK(arena.overflow_blocks == nullptr);
+        CHECK(arena.capacity >= 64 + 128);
+
+        arena.destroy();
+    }
+
+    TEST_CASE("Arena allocator")
+    {
+        auto arena = Arena::create(1024);
+
+        ArenaVec<u32> values(&arena);
+        values.reserve(16);
+        for (u32 i = 0; i < 16; i += 1)
+        {
+            values.push_back(i);
+        }
+        CHECK(reinterpret_cast<u8 *>(values.data()) == arena.base);
+        CHECK(values[15] == 15);
+
+        // Without arena the allocator uses the heap
+        ArenaVec<u32> heap_values;
+        heap_values.push_back(1);
+        CHECK(heap_values.get_allocator().arena == nullptr);
+
+        arena.destroy();
+    }
+}
+#endif
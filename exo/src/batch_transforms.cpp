@@ -0,0 +1,290 @@
+#include "exo/batch_transforms.h"
+
+#include "exo/simd.h"
+#include <algorithm>
+
+// Loads up to 4 float3 as 3 lanes of x, y and z, missing elements are filled with `fill`
+static void load_soa(const float3 *v, usize count, float fill, simd::f32x4 &x, simd::f32x4 &y, simd::f32x4 &z)
+{
+    float xs[4] = {fill, fill, fill, fill};
+    float ys[4] = {fill, fill, fill, fill};
+    float zs[4] = {fill, fill, fill, fill};
+    for (usize i = 0; i < count; i += 1)
+    {
+        xs[i] = v[i].x;
+        ys[i] = v[i].y;
+        zs[i] = v[i].z;
+    }
+    x = simd::load(xs);
+    y = simd::load(ys);
+    z = simd::load(zs);
+}
+
+// Loads up to 4 float4 as 4 lanes of x, y, z and w, missing elements are identity quaternions
+static void load_soa(const float4 *v, usize count, simd::f32x4 &x, simd::f32x4 &y, simd::f32x4 &z, simd::f32x4 &w)
+{
+    float4 values[4] = {float4(0.0f, 0.0f, 0.0f, 1.0f), float4(0.0f, 0.0f, 0.0f, 1.0f), float4(0.0f, 0.0f, 0.0f, 1.0f), float4(0.0f, 0.0f, 0.0f, 1.0f)};
+    std::copy(v, v + count, values);
+    x = simd::load(values[0].raw);
+    y = simd::load(values[1].raw);
+    z = simd::load(values[2].raw);
+    w = simd::load(values[3].raw);
+    simd::transpose(x, y, z, w);
+}
+
+// Computes `count` (at most 4) matrices
+static void compose_trs_4(const float3 *translations, const float4 *rotations, const float3 *scales, usize count, float4x4 *out)
+{
+    using namespace simd;
+
+    f32x4 tx, ty, tz;
+    f32x4 qx, qy, qz, qw;
+    f32x4 sx, sy, sz;
+    load_soa(translations, count, 0.0f, tx, ty, tz);
+    load_soa(rotations, count, qx, qy, qz, qw);
+    load_soa(scales, count, 1.0f, sx, sy, sz);
+
+    const f32x4 one = splat(1.0f);
+    const f32x4 two = splat(2.0f);
+    f32x4 xx = mul(qx, qx);
+    f32x4 yy = mul(qy, qy);
+    f32x4 zz = mul(qz, qz);
+    f32x4 xy = mul(qx, qy);
+    f32x4 xz = mul(qx, qz);
+    f32x4 yz = mul(qy, qz);
+    f32x4 xw = mul(qx, qw);
+    f32x4 yw = mul(qy, qw);
+    f32x4 zw = mul(qz, qw);
+
+    // rotation matrix, rij is row i and column j
+    f32x4 r00 = sub(one, mul(two, add(yy, zz)));
+    f32x4 r10 = mul(two, add(xy, zw));
+    f32x4 r20 = mul(two, sub(xz, yw));
+    f32x4 r01 = mul(two, sub(xy, zw));
+    f32x4 r11 = sub(one, mul(two, add(xx, zz)));
+    f32x4 r21 = mul(two, add(yz, xw));
+    f32x4 r02 = mul(two, add(xz, yw));
+    f32x4 r12 = mul(two, sub(yz, xw));
+    f32x4 r22 = sub(one, mul(two, add(xx, yy)));
+
+    // each lane is one matrix, transpose to get the columns of the 4 matrices
+    f32x4 zero = splat(0.0f);
+    f32x4 c0[4] = {mul(r00, sx), mul(r10, sx), mul(r20, sx), zero};
+    f32x4 c1[4] = {mul(r01, sy), mul(r11, sy), mul(r21, sy), zero};
+    f32x4 c2[4] = {mul(r02, sz), mul(r12, sz), mul(r22, sz), zero};
+    f32x4 c3[4] = {tx, ty, tz, one};
+    transpose(c0[0], c0[1], c0[2], c0[3]);
+    transpose(c1[0], c1[1], c1[2], c1[3]);
+    transpose(c2[0], c2[1], c2[2], c2[3]);
+    transpose(c3[0], c3[1], c3[2], c3[3]);
+
+    for (usize i = 0; i < count; i += 1)
+    {
+        store(out[i].values + 0, c0[i]);
+        store(out[i].values + 4, c1[i]);
+        store(out[i].values + 8, c2[i]);
+        store(out[i].values + 12, c3[i]);
+    }
+}
+
+void compose_trs(std::span<const float3> translations, std::span<const float4> rotations, std::span<const float3> scales, std::span<float4x4> out)
+{
+    assert(translations.size() == out.size() && rotations.size() == out.size() && scales.size() == out.size());
+    for (usize i = 0; i < out.size(); i += 4)
+    {
+        usize count = std::min(out.size() - i, usize(4));
+        compose_trs_4(&translations[i], &rotations[i], &scales[i], count, &out[i]);
+    }
+}
+
+void multiply_many(const float4x4 &parent, std::span<float4x4> matrices)
+{
+    auto c0 = simd::load(parent.values + 0);
+    auto c1 = simd::load(parent.values + 4);
+    auto c2 = simd::load(parent.values + 8);
+    auto c3 = simd::load(parent.values + 12);
+    for (auto &matrix : matrices)
+    {
+        simd::mat4_mul(c0, c1, c2, c3, matrix.values, matrix.values);
+    }
+}
+
+void transform_points(const float4x4 &matrix, std::span<const float3> points, std::span<float3> out)
+{
+    assert(points.size() == out.size());
+    auto c0 = simd::load(matrix.values + 0);
+    auto c1 = simd::load(matrix.values + 4);
+    auto c2 = simd::load(matrix.values + 8);
+    auto c3 = simd::load(matrix.values + 12);
+    usize i = 0;
+#if defined(SIMD_USE_AVX)
+    // Two points per iteration, each 128-bit lane transforms one point
+    __m256 c0x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+    __m256 c1x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+    __m256 c2x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+    __m256 c3x2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+    for (; i + 2 <= points.size(); i += 2)
+    {
+        const float3 &p0 = points[i];
+        const float3 &p1 = points[i + 1];
+        __m256 p      = _mm256_setr_ps(p0.x, p0.y, p0.z, 1.0f, p1.x, p1.y, p1.z, 1.0f);
+        __m256 result = _mm256_mul_ps(c0x2, _mm256_permute_ps(p, 0x00));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(c1x2, _mm256_permute_ps(p, 0x55)));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(c2x2, _mm256_permute_ps(p, 0xAA)));
+        result        = _mm256_add_ps(result, _mm256_mul_ps(c3x2, _mm256_permute_ps(p, 0xFF)));
+
+        float values[8];
+        _mm256_storeu_ps(values, result);
+        out[i]     = float3(values[0], values[1], values[2]);
+        out[i + 1] = float3(values[4], values[5], values[6]);
+    }
+#endif
+    for (; i < points.size(); i += 1)
+    {
+        float4 point = float4(points[i], 1.0f);
+        float4 result;
+        simd::store(result.raw, simd::combine(c0, c1, c2, c3, simd::load(point.raw)));
+        out[i] = result.xyz();
+    }
+}
+
+void transform_points(std::span<const float4x4> matrices, std::span<const float3> points, std::span<float3> out)
+{
+    assert(matrices.size() == points.size() && points.size() == out.size());
+    for (usize i = 0; i < points.size(); i += 1)
+    {
+        out[i] = (matrices[i] * float4(points[i], 1.0f)).xyz();
+    }
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/collections/vector.h"
+#include <random>
+
+namespace test
+{
+    // The per-element path of the GLB loader
+    static float4x4 reference_trs(float3 t, float4 q, float3 s)
+    {
+        float4x4 translation = float4x4::identity();
+        translation.at(0, 3) = t.x;
+        translation.at(1, 3) = t.y;
+        translation.at(2, 3) = t.z;
+
+        float4x4 rotation({
+            1.0f - 2.0f*q.y*q.y - 2.0f*q.z*q.z, 2.0f*q.x*q.y - 2.0f*q.z*q.w, 2.0f*q.x*q.z + 2.0f*q.y*q.w, 0.0f,
+            2.0f*q.x*q.y + 2.0f*q.z*q.w, 1.0f - 2.0f*q.x*q.x - 2.0f*q.z*q.z, 2.0f*q.y*q.z - 2.0f*q.x*q.w, 0.0f,
+            2.0f*q.x*q.z - 2.0f*q.y*q.w, 2.0f*q.y*q.z + 2.0f*q.x*q.w, 1.0f - 2.0f*q.x*q.x - 2.0f*q.y*q.y, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        });
+
+        float4x4 scale = {};
+        scale.at(0, 0) = s.x;
+        scale.at(1, 1) = s.y;
+        scale.at(2, 2) = s.z;
+        scale.at(3, 3) = 1.0f;
+
+        return translation * rotation * scale;
+    }
+
+    static void random_trs(std::mt19937 &rng, Vec<float3> &translations, Vec<float4> &rotations, Vec<float3> &scales)
+    {
+        std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+        for (usize i = 0; i < translations.size(); i += 1)
+        {
+            translations[i] = 100.0f * float3(distribution(rng), distribution(rng), distribution(rng));
+            rotations[i]    = normalize(float4(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+            scales[i]       = float3(1.5f) + float3(distribution(rng), distribution(rng), distribution(rng));
+        }
+    }
+
+    static void check_approx(const float4x4 &a, const float4x4 &b)
+    {
+        for (usize i = 0; i < 16; i += 1)
+        {
+            REQUIRE(a.values[i] == doctest::Approx(b.values[i]).epsilon(1e-4));
+        }
+    }
+
+    TEST_SUITE("Batch transforms")
+    {
+        TEST_CASE("Compose TRS")
+        {
+            std::mt19937 rng{7};
+            // not a multiple of 4 to test the tail
+            constexpr usize count = 39;
+            Vec<float3> translations(count);
+            Vec<float4> rotations(count);
+            Vec<float3> scales(count);
+            random_trs(rng, translations, rotations, scales);
+
+            Vec<float4x4> matrices(count);
+            compose_trs(translations, rotations, scales, matrices);
+            for (usize i = 0; i < count; i += 1)
+            {
+                check_approx(matrices[i], reference_trs(translations[i], rotations[i], scales[i]));
+            }
+
+            // identity inputs give an identity matrix
+            float3 zero = float3(0.0f);
+            float4 no_rotation = float4(0.0f, 0.0f, 0.0f, 1.0f);
+            float3 one = float3(1.0f);
+            float4x4 identity;
+            compose_trs({&zero, 1}, {&no_rotation, 1}, {&one, 1}, {&identity, 1});
+            CHECK(identity == float4x4::identity());
+        }
+
+        TEST_CASE("Multiply many")
+        {
+            std::mt19937 rng{3};
+            constexpr usize count = 17;
+            Vec<float3> translations(count);
+            Vec<float4> rotations(count);
+            Vec<float3> scales(count);
+            random_trs(rng, translations, rotations, scales);
+
+            Vec<float4x4> matrices(count);
+            compose_trs(translations, rotations, scales, matrices);
+            float4x4 parent = matrices[0];
+
+            Vec<float4x4> expected(count);
+            for (usize i = 0; i < count; i += 1)
+            {
+                expected[i] = parent * matrices[i];
+            }
+
+            // parent aliases the first matrix
+            multiply_many(matrices[0], matrices);
+            CHECK(matrices[0] == expected[0]);
+            for (usize i = 1; i < count; i += 1)
+            {
+                CHECK(matrices[i] == expected[i]);
+            }
+        }
+
+        TEST_CASE("Transform points")
+        {
+            // scale by 2 then translate by (1, 2, 3)
+            float4x4 m = 2.0f * float4x4::identity();
+            m.at(0, 3) = 1.0f;
+            m.at(1, 3) = 2.0f;
+            m.at(2, 3) = 3.0f;
+            m.at(3, 3) = 1.0f;
+
+            Vec<float3> points = {float3(0.0f), float3(1.0f, 0.0f, 0.0f), float3(1.0f, 2.0f, 3.0f)};
+            Vec<float3> out(points.size());
+            transform_points(m, points, out);
+            CHECK(out[0] == float3(1.0f, 2.0f, 3.0f));
+            CHECK(out[1] == float3(3.0f, 2.0f, 3.0f));
+            CHECK(out[2] == float3(3.0f, 6.0f, 9.0f));
+
+            Vec<float4x4> matrices = {float4x4::identity(), m, m};
+            transform_points(matrices, points, out);
+            CHECK(out[0] == float3(0.0f));
+            CHECK(out[1] == float3(3.0f, 2.0f, 3.0f));
+            CHECK(out[2] == float3(3.0f, 6.0f, 9.0f));
+        }
+    }
+}
+#endif
@@ -0,0 +1,300 @@
+#include "exo/bitset_allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr u32 WORD_BITS = 64;
+
+static u32 word_count(u32 bit_count) { return (bit_count + WORD_BITS - 1) / WORD_BITS; }
+
+static u64 *grow_array(u64 *array, u32 old_count, u32 new_count)
+{
+    array = reinterpret_cast<u64 *>(std::realloc(array, new_count * sizeof(u64)));
+    std::memset(array + old_count, 0, (new_count - old_count) * sizeof(u64));
+    return array;
+}
+
+BitsetAllocator BitsetAllocator::create(u32 capacity)
+{
+    BitsetAllocator allocator;
+    allocator.grow(capacity);
+    return allocator;
+}
+
+void BitsetAllocator::destroy()
+{
+    std::free(this->words);
+    std::free(this->summary);
+    *this = {};
+}
+
+void BitsetAllocator::grow(u32 new_capacity)
+{
+    assert(new_capacity >= this->capacity);
+    u32 old_capacity = this->capacity;
+    u32 old_words    = word_count(old_capacity);
+    u32 new_words    = word_count(new_capacity);
+    if (new_words != old_words)
+    {
+        this->words   = grow_array(this->words, old_words, new_words);
+        this->summary = grow_array(this->summary, word_count(old_words), word_count(new_words));
+    }
+
+    this->capacity = new_capacity;
+    set_range(old_capacity, new_capacity - old_capacity, true);
+}
+
+void BitsetAllocator::set_range(u32 first, u32 count, bool free)
+{
+    assert(first + count <= this->capacity);
+    u32 end = first + count;
+    for (u32 i_bit = first; i_bit < end;)
+    {
+        u32 i_word     = i_bit / WORD_BITS;
+        u32 word_first = i_bit % WORD_BITS;
+        u32 bit_count  = std::min(WORD_BITS - word_first, end - i_bit);
+        u64 mask       = (bit_count == WORD_BITS ? ~u64(0) : ((u64(1) << bit_count) - 1)) << word_first;
+
+        if (free)
+        {
+            assert((this->words[i_word] & mask) == 0);
+            this->words[i_word] |= mask;
+        }
+        else
+        {
+            assert((this->words[i_word] & mask) == mask);
+            this->words[i_word] &= ~mask;
+        }
+
+        u64 summary_bit = u64(1) << (i_word % WORD_BITS);
+        if (this->words[i_word])
+        {
+            this->summary[i_word / WORD_BITS] |= summary_bit;
+        }
+        else
+        {
+            this->summary[i_word / WORD_BITS] &= ~summary_bit;
+        }
+
+        i_bit += bit_count;
+    }
+
+    if (free && count > 0)
+    {
+        this->first_summary = std::min(this->first_summary, first / WORD_BITS / WORD_BITS);
+    }
+}
+
+u32 BitsetAllocator::allocate()
+{
+    u32 summary_count = word_count(word_count(this->capacity));
+    for (u32 i_summary = this->first_summary; i_summary < summary_count; i_summary += 1)
+    {
+        if (this->summary[i_summary] == 0)
+        {
+            continue;
+        }
+
+        u32 i_word = i_summary * WORD_BITS + static_cast<u32>(std::countr_zero(this->summary[i_summary]));
+        u32 i_bit  = static_cast<u32>(std::countr_zero(this->words[i_word]));
+        this->words[i_word] &= ~(u64(1) << i_bit);
+        if (this->words[i_word] == 0)
+        {
+            this->summary[i_summary] &= ~(u64(1) << (i_word % WORD_BITS));
+        }
+
+        this->first_summary = i_summary;
+        return i_word * WORD_BITS + i_bit;
+    }
+
+    this->first_summary = summary_count;
+    return u32_invalid;
+}
+
+void BitsetAllocator::free(u32 index)
+{
+    assert(index < this->capacity && !is_free(index));
+    set_range(index, 1, true);
+}
+
+u32 BitsetAllocator::allocate_range(u32 count)
+{
+    assert(count > 0);
+    if (count == 1)
+    {
+        return allocate();
+    }
+
+    // Find the first run of `count` set bits, whole words are skipped with a single test
+    u32 run_first  = 0;
+    u32 run_length = 0;
+    for (u32 i_word = this->first_summary * WORD_BITS; i_word < word_count(this->capacity); i_word += 1)
+    {
+        u64 word = this->words[i_word];
+        for (u32 i_bit = 0; i_bit < WORD_BITS;)
+        {
+            u64 rest = word >> i_bit;
+            if (rest == 0)
+            {
+                run_length = 0;
+                break;
+            }
+
+            u32 allocated = static_cast<u32>(std::countr_zero(rest));
+            if (allocated)
+            {
+                run_length = 0;
+                i_bit += allocated;
+                rest >>= allocated;
+            }
+
+            u32 free = static_cast<u32>(std::countr_one(rest));
+            if (run_length == 0)
+            {
+                run_first = i_word * WORD_BITS + i_bit;
+            }
+            run_length += free;
+            i_bit += free;
+
+            if (run_length >= count)
+            {
+                set_range(run_first, count, false);
+                return run_first;
+            }
+        }
+    }
+
+    return u32_invalid;
+}
+
+void BitsetAllocator::free_range(u32 first, u32 count)
+{
+    set_range(first, count, true);
+}
+
+bool BitsetAllocator::is_free(u32 index) const
+{
+    assert(index < this->capacity);
+    return (this->words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/collections/vector.h"
+#include <random>
+
+namespace test
+{
+    TEST_SUITE("Bitset allocator")
+    {
+        TEST_CASE("Bitset allocator")
+        {
+            auto allocator = BitsetAllocator::create(100);
+            CHECK(allocator.get_capacity() == 100);
+
+            // The lowest free index is always allocated first
+            for (u32 i = 0; i < 100; i += 1)
+            {
+                CHECK(allocator.allocate() == i);
+            }
+            CHECK(allocator.allocate() == u32_invalid);
+
+            allocator.free(70);
+            allocator.free(3);
+            CHECK(allocator.is_free(3));
+            CHECK(allocator.allocate() == 3);
+            CHECK(allocator.allocate() == 70);
+            CHECK(allocator.allocate() == u32_invalid);
+
+            // Growing keeps the allocated indices
+            allocator.grow(5000);
+            CHECK(!allocator.is_free(42));
+            CHECK(allocator.allocate() == 100);
+            for (u32 i = 101; i < 5000; i += 1)
+            {
+                CHECK(allocator.allocate() == i);
+            }
+            CHECK(allocator.allocate() == u32_invalid);
+
+            allocator.free(4500);
+            CHECK(allocator.allocate() == 4500);
+
+            allocator.destroy();
+        }
+
+        TEST_CASE("Bitset allocator ranges")
+        {
+            auto allocator = BitsetAllocator::create(1000);
+
+            CHECK(allocator.allocate_range(10) == 0);
+            CHECK(allocator.allocate_range(100) == 10);
+            CHECK(allocator.allocate() == 110);
+
+            // A hole that is too small is skipped
+            allocator.free_range(2, 5);
+            CHECK(allocator.allocate_range(6) == 111);
+            CHECK(allocator.allocate_range(5) == 2);
+
+            // Ranges can span several words
+            allocator.free_range(10, 100);
+            CHECK(allocator.allocate_range(64) == 10);
+            CHECK(allocator.allocate_range(70) == 117);
+            CHECK(allocator.allocate_range(1000) == u32_invalid);
+
+            for (u32 i = 74; i < 110; i += 1)
+            {
+                CHECK(allocator.is_free(i));
+            }
+            CHECK(allocator.allocate_range(36) == 74);
+            CHECK(allocator.allocate() == 187);
+
+            allocator.destroy();
+        }
+
+        TEST_CASE("Bitset allocator random")
+        {
+            std::mt19937 rng{1};
+            auto allocator = BitsetAllocator::create(64);
+            Vec<bool> allocated(64, false);
+            for (u32 i = 0; i < 20000; i += 1)
+            {
+                if (rng() % 500 == 0)
+                {
+                    allocator.grow(allocator.get_capacity() + 100);
+                    allocated.resize(allocator.get_capacity(), false);
+                }
+
+                u32 index = rng() % allocator.get_capacity();
+                if (allocated[index])
+                {
+                    allocator.free(index);
+                    allocated[index] = false;
+                }
+                else
+                {
+                    u32 new_index = allocator.allocate();
+                    if (new_index != u32_invalid)
+                    {
+                        REQUIRE(!allocated[new_index]);
+                        // it must be the lowest free index
+                        for (u32 j = 0; j < new_index; j += 1)
+                        {
+                            REQUIRE(allocated[j]);
+                        }
+                        allocated[new_index] = true;
+                    }
+                }
+            }
+
+            for (u32 i = 0; i < allocator.get_capacity(); i += 1)
+            {
+                CHECK(allocator.is_free(i) == !allocated[i]);
+            }
+            allocator.destroy();
+        }
+    }
+}
+#endif
@@ -0,0 +1,131 @@
+#include "exo/concurrent_free_list.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cassert>
+
+static u32 head_index(u64 head) { return static_cast<u32>(head); }
+static u64 next_head(u64 head, u32 index) { return ((head >> 32) + 1) << 32 | index; }
+
+ConcurrentFreeList ConcurrentFreeList::create(u32 capacity)
+{
+    ConcurrentFreeList list;
+    list.array = reinterpret_cast<u32*>(std::malloc(capacity * sizeof(u32)));
+
+    for (u32 i = 0; i < capacity; i += 1)
+    {
+        list.array[i] = i + 1;
+    }
+    list.array[capacity-1] = u32_invalid;
+
+    list.head = 0;
+    list.capacity = capacity;
+    return list;
+}
+
+u32 ConcurrentFreeList::allocate()
+{
+    std::atomic_ref<u64> atomic_head{this->head};
+    u64 old_head = atomic_head.load(std::memory_order_acquire);
+    while (true)
+    {
+        u32 free_index = head_index(old_head);
+        if (free_index == u32_invalid)
+        {
+            assert(!"the free list is empty");
+            return u32_invalid;
+        }
+        assert(free_index < this->capacity);
+
+        // the next index can be stale if another thread popped free_index, the tag will make the CAS fail
+        u32 next_index = std::atomic_ref<u32>{this->array[free_index]}.load(std::memory_order_relaxed);
+        if (atomic_head.compare_exchange_weak(old_head, next_head(old_head, next_index), std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return free_index;
+        }
+    }
+}
+
+void ConcurrentFreeList::free(u32 index)
+{
+    assert(index < this->capacity);
+    std::atomic_ref<u64> atomic_head{this->head};
+    u64 old_head = atomic_head.load(std::memory_order_relaxed);
+    do
+    {
+        std::atomic_ref<u32>{this->array[index]}.store(head_index(old_head), std::memory_order_relaxed);
+    } while (!atomic_head.compare_exchange_weak(old_head, next_head(old_head, index), std::memory_order_release, std::memory_order_relaxed));
+}
+
+void ConcurrentFreeList::destroy()
+{
+    std::free(this->array);
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/collections/vector.h"
+#include <thread>
+#include <algorithm>
+
+namespace test
+{
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("Concurrent free list")
+        {
+            constexpr u32 capacity     = 1024;
+            constexpr u32 thread_count = 8;
+            constexpr u32 iterations   = 10'000;
+
+            auto list = ConcurrentFreeList::create(capacity);
+
+            // Each thread owns the indices it allocated, every index should be owned by one thread at a time
+            Vec<std::atomic<u32>> owners(capacity);
+            std::atomic<u32> errors = 0;
+
+            Vec<std::thread> threads;
+            for (u32 i_thread = 0; i_thread < thread_count; i_thread += 1)
+            {
+                threads.emplace_back([&, i_thread]() {
+                    u32 allocated[16];
+                    for (u32 i = 0; i < iterations; i += 1)
+                    {
+                        for (u32 &index : allocated)
+                        {
+                            index = list.allocate();
+                            u32 expected = 0;
+                            if (!owners[index].compare_exchange_strong(expected, i_thread + 1))
+                            {
+                                errors.fetch_add(1);
+                            }
+                        }
+                        for (u32 index : allocated)
+                        {
+                            owners[index].store(0);
+                            list.free(index);
+                        }
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+            CHECK(errors.load() == 0);
+
+            // Every index is back in the list
+            Vec<u32> indices;
+            for (u32 i = 0; i < capacity; i += 1)
+            {
+                indices.push_back(list.allocate());
+            }
+            std::sort(indices.begin(), indices.end());
+            CHECK(std::unique(indices.begin(), indices.end()) == indices.end());
+            CHECK(indices.back() == capacity - 1);
+
+            list.destroy();
+        }
+    }
+}
+#endif
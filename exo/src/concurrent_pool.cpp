@@ -0,0 +1,99 @@
+#include "exo/collections/concurrent_pool.h"
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/collections/vector.h"
+#include <thread>
+
+namespace test
+{
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("Concurrent pool")
+        {
+            ConcurrentPool<u32, 64> pool;
+            auto h1 = pool.add(1u);
+            auto h2 = pool.add(2u);
+            CHECK(pool.size() == 2);
+            CHECK(*pool.get(h1) == 1);
+
+            // Pointers are stable when the pool grows
+            u32 *p2 = pool.get(h2);
+            for (u32 i = 0; i < 256; i += 1)
+            {
+                pool.add(i);
+            }
+            CHECK(pool.get(h2) == p2);
+
+            pool.remove(h1);
+            auto h3 = pool.add(3u);
+            CHECK(h3.value() == h1.value());
+            CHECK(h3 != h1);
+
+            u32 count = 0;
+            for (auto [handle, value] : pool)
+            {
+                CHECK(pool.get(handle) == value);
+                count += 1;
+            }
+            CHECK(count == pool.size());
+        }
+
+        TEST_CASE("Concurrent pool stress")
+        {
+            constexpr u32 thread_count = 8;
+            constexpr u32 iterations   = 2'000;
+            constexpr u32 batch        = 32;
+
+            ConcurrentPool<u64, 128> pool;
+            std::atomic<u32> errors = 0;
+
+            Vec<std::thread> threads;
+            for (u32 i_thread = 0; i_thread < thread_count; i_thread += 1)
+            {
+                threads.emplace_back([&, i_thread]() {
+                    Handle<u64> handles[batch];
+                    for (u32 i = 0; i < iterations; i += 1)
+                    {
+                        for (u32 j = 0; j < batch; j += 1)
+                        {
+                            handles[j] = pool.add(u64(i_thread) << 32 | j);
+                        }
+                        // No other thread should have written to our slots
+                        for (u32 j = 0; j < batch; j += 1)
+                        {
+                            if (*pool.get(handles[j]) != (u64(i_thread) << 32 | j))
+                            {
+                                errors.fetch_add(1);
+                            }
+                        }
+                        // Keep the last batch alive
+                        if (i + 1 < iterations)
+                        {
+                            for (auto handle : handles)
+                            {
+                                pool.remove(handle);
+                            }
+                        }
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+
+            CHECK(errors.load() == 0);
+            CHECK(pool.size() == thread_count * batch);
+
+            u32 count = 0;
+            for (auto [handle, value] : pool)
+            {
+                CHECK((*value & 0xFFFF'FFFF) < batch);
+                count += 1;
+            }
+            CHECK(count == thread_count * batch);
+        }
+    }
+}
+#endif
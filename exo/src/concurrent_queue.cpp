@@ -0,0 +1,234 @@
+#include "exo/collections/concurrent_queue.h"
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/collections/vector.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace test
+{
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("SPSC queue")
+        {
+            auto queue = std::make_unique<SPSCQueue<u32, 8>>();
+            u32 value  = 0;
+            CHECK(!queue->try_pop(value));
+
+            for (u32 i = 0; i < 8; i += 1)
+            {
+                CHECK(queue->try_push(i));
+            }
+            CHECK(!queue->try_push(8u));
+            CHECK(queue->size() == 8);
+
+            CHECK(queue->try_pop(value));
+            CHECK(value == 0);
+
+            // The indices wrap around the ring
+            u32 batch[8] = {100, 101, 102};
+            CHECK(queue->try_push_batch(batch, 3) == 1);
+            CHECK(queue->try_pop_batch(batch, 8) == 8);
+            for (u32 i = 0; i < 7; i += 1)
+            {
+                CHECK(batch[i] == i + 1);
+            }
+            CHECK(batch[7] == 100);
+            CHECK(queue->size() == 0);
+        }
+
+        TEST_CASE("MPSC queue")
+        {
+            auto queue = std::make_unique<MPSCQueue<u32, 8>>();
+            u32 value  = 0;
+            CHECK(!queue->try_pop(value));
+
+            u32 batch[8] = {0, 1, 2, 3, 4, 5};
+            CHECK(queue->try_push_batch(batch, 6) == 6);
+            CHECK(queue->try_push(6u));
+            CHECK(queue->try_push(7u));
+            CHECK(!queue->try_push(8u));
+
+            CHECK(queue->try_pop_batch(batch, 5) == 5);
+            CHECK(batch[4] == 4);
+            CHECK(queue->try_push_batch(batch, 8) == 5);
+            CHECK(queue->try_pop_batch(batch, 8) == 8);
+            CHECK(batch[0] == 5);
+            CHECK(batch[3] == 0);
+            CHECK(batch[7] == 4);
+            CHECK(!queue->try_pop(value));
+        }
+
+        TEST_CASE("SPSC queue stress")
+        {
+            constexpr u32 count = 1'000'000;
+            auto queue          = std::make_unique<SPSCQueue<u32, 256>>();
+
+            std::thread producer([&]() {
+                u32 batch[16];
+                for (u32 i = 0; i < count;)
+                {
+                    // alternate between single and batched pushes
+                    if (i % 3)
+                    {
+                        queue->push(i);
+                        i += 1;
+                    }
+                    else
+                    {
+                        u32 batch_size = count - i < 16 ? count - i : 16;
+                        for (u32 j = 0; j < batch_size; j += 1)
+                        {
+                            batch[j] = i + j;
+                        }
+                        u32 pushed = queue->try_push_batch(batch, batch_size);
+                        if (pushed == 0)
+                        {
+                            // full, sleep until there is room
+                            queue->push(batch[0]);
+                            pushed = 1;
+                        }
+                        i += pushed;
+                    }
+                }
+            });
+
+            u32 errors   = 0;
+            u32 expected = 0;
+            u32 batch[32];
+            while (expected < count)
+            {
+                if (expected % 2)
+                {
+                    u32 value = 0;
+                    queue->pop(value);
+                    errors += value != expected;
+                    expected += 1;
+                }
+                else
+                {
+                    u32 popped = queue->try_pop_batch(batch, 32);
+                    if (popped == 0)
+                    {
+                        queue->pop(batch[0]);
+                        popped = 1;
+                    }
+                    for (u32 i = 0; i < popped; i += 1)
+                    {
+                        errors += batch[i] != expected;
+                        expected += 1;
+                    }
+                }
+            }
+            producer.join();
+
+            CHECK(errors == 0);
+            CHECK(queue->size() == 0);
+        }
+
+        TEST_CASE("MPSC queue stress")
+        {
+            constexpr u32 producer_count = 8;
+            constexpr u32 count          = 200'000; // per producer
+            auto queue                   = std::make_unique<MPSCQueue<u32, 1024>>();
+
+            // values are (producer << 24) | sequence
+            Vec<std::thread> producers;
+            for (u32 i_producer = 0; i_producer < producer_count; i_producer += 1)
+            {
+                producers.emplace_back([&, i_producer]() {
+                    u32 batch[8];
+                    for (u32 i = 0; i < count;)
+                    {
+                        if (i_producer % 2)
+                        {
+                            queue->push(i_producer << 24 | i);
+                            i += 1;
+                        }
+                        else
+                        {
+                            u32 batch_size = count - i < 8 ? count - i : 8;
+                            for (u32 j = 0; j < batch_size; j += 1)
+                            {
+                                batch[j] = i_producer << 24 | (i + j);
+                            }
+                            u32 pushed = queue->try_push_batch(batch, batch_size);
+                            if (pushed == 0)
+                            {
+                                queue->push(batch[0]);
+                                pushed = 1;
+                            }
+                            i += pushed;
+                        }
+                    }
+                });
+            }
+
+            // Elements from one producer are popped in the order they were pushed
+            u32 next[producer_count] = {};
+            u32 errors               = 0;
+            u32 batch[64];
+            for (u32 received = 0; received < producer_count * count;)
+            {
+                u32 popped = queue->try_pop_batch(batch, 64);
+                if (popped == 0)
+                {
+                    queue->pop(batch[0]);
+                    popped = 1;
+                }
+
+                for (u32 i = 0; i < popped; i += 1)
+                {
+                    u32 i_producer = batch[i] >> 24;
+                    errors += i_producer >= producer_count || (batch[i] & 0xFFFFFF) != next[i_producer];
+                    if (i_producer < producer_count)
+                    {
+                        next[i_producer] += 1;
+                    }
+                }
+                received += popped;
+            }
+
+            for (auto &producer : producers)
+            {
+                producer.join();
+            }
+
+            CHECK(errors == 0);
+            for (u32 i_producer = 0; i_producer < producer_count; i_producer += 1)
+            {
+                CHECK(next[i_producer] == count);
+            }
+            CHECK(queue->size() == 0);
+        }
+
+        TEST_CASE("Queue blocking wait")
+        {
+            auto queue = std::make_unique<MPSCQueue<u32, 2>>();
+
+            // The consumer sleeps in pop() until the producer pushes
+            u32 value = 0;
+            std::thread consumer([&]() { queue->pop(value); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            queue->push(42u);
+            consumer.join();
+            CHECK(value == 42);
+
+            // The producer sleeps in push() until the consumer makes room
+            queue->push(1u);
+            queue->push(2u);
+            std::thread producer([&]() { queue->push(3u); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            u32 batch[3] = {};
+            CHECK(queue->try_pop_batch(batch, 3) == 2);
+            producer.join();
+            queue->pop(batch[2]);
+            CHECK(batch[0] == 1);
+            CHECK(batch[1] == 2);
+            CHECK(batch[2] == 3);
+        }
+    }
+}
+#endif
@@ -0,0 +1,295 @@
+#include "exo/hash.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_USE_SSE2
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Inputs longer than this are hashed with 8 independent accumulators that are updated 2 by 2 with SSE2
+static constexpr usize LONG_INPUT_SIZE = 256;
+static constexpr usize STRIPE_SIZE     = 64; // 8 lanes of u64
+static constexpr usize BLOCK_STRIPES   = 16; // accumulators are scrambled after each block of stripes
+static constexpr usize SECRET_SIZE     = BLOCK_STRIPES + 8;
+
+static constexpr u64 P0 = 0xa0761d6478bd642full;
+static constexpr u64 P1 = 0xe7037ed1a0b428dbull;
+static constexpr u64 P2 = 0x8ebc6af09c88c6e3ull;
+static constexpr u64 P3 = 0x589965cc75374cc3ull;
+static constexpr u32 PRIME32 = 0x9E3779B1u;
+
+static constexpr u64 SECRET[SECRET_SIZE] = {
+    0xbe4ba423396cfeb8, 0x1cad21f72c81017c, 0xdb979083e96dd4de, 0x1f67b3b7a4a44072,
+    0x78e5c0cc4ee679cb, 0x2172ffcc7dd05a82, 0x8e2443f7744608b8, 0x4c263a81e69035e0,
+    0xcb00c391bb52283c, 0xa32e531b8b65d088, 0x4ef90da297486471, 0xd8acdea946ef1938,
+    0x3f349ce33f76faa8, 0x1d4f0bc7c7bbdcf9, 0x3159b4cd4be0518a, 0x647378d9c97e9fc8,
+    0xc3ebd33483acc5ea, 0xeb6313faffa081c5, 0x49daf0b751dd0d17, 0x9e68d429265516d3,
+    0xfca1477d58be162b, 0xce31d07ad1b8f88f, 0x280416958f3acb45, 0x7e404bbbcafbd7af,
+};
+
+// 64x64 -> 128 multiplication folded back to 64 bits
+static inline u64 mix(u64 a, u64 b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    u64 hi = 0;
+    u64 lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#else
+    __extension__ using u128 = unsigned __int128;
+    u128 r = u128(a) * u128(b);
+    return u64(r) ^ u64(r >> 64);
+#endif
+}
+
+static inline u64 read64(const u8 *p)
+{
+    u64 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u64 read32(const u8 *p)
+{
+    u32 v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Reads 1 to 3 bytes
+static inline u64 read_small(const u8 *p, usize len)
+{
+    return (u64(p[0]) << 16) | (u64(p[len >> 1]) << 8) | p[len - 1];
+}
+
+static inline void accumulate_stripe(u64 *acc, const u8 *stripe, const u64 *key)
+{
+#if defined(HASH_USE_SSE2)
+    for (usize i = 0; i < 8; i += 2)
+    {
+        __m128i data     = _mm_loadu_si128(reinterpret_cast<const __m128i *>(stripe + i * sizeof(u64)));
+        __m128i data_key = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + i)));
+        // low 32 bits * high 32 bits of each lane
+        __m128i product  = _mm_mul_epu32(data_key, _mm_shuffle_epi32(data_key, _MM_SHUFFLE(3, 3, 1, 1)));
+        // each lane also accumulates the data of its neighbour
+        __m128i swapped  = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i *lanes = reinterpret_cast<__m128i *>(acc + i);
+        _mm_storeu_si128(lanes, _mm_add_epi64(_mm_loadu_si128(lanes), _mm_add_epi64(product, swapped)));
+    }
+#else
+    for (usize i = 0; i < 8; i += 1)
+    {
+        u64 data     = read64(stripe + i * sizeof(u64));
+        u64 data_key = data ^ key[i];
+        acc[i ^ 1] += data;
+        acc[i] += (data_key & 0xffffffff) * (data_key >> 32);
+    }
+#endif
+}
+
+static inline void scramble(u64 *acc, const u64 *key)
+{
+    for (usize i = 0; i < 8; i += 1)
+    {
+        u64 a  = acc[i];
+        a      = (a ^ (a >> 47) ^ key[i]) * PRIME32;
+        acc[i] = a;
+    }
+}
+
+static u64 hash_long(const u8 *p, usize len, u64 seed)
+{
+    u64 secret[SECRET_SIZE];
+    for (usize i = 0; i < SECRET_SIZE; i += 1)
+    {
+        secret[i] = SECRET[i] + seed;
+    }
+
+    u64 acc[8] = {P0, P1, P2, P3, ~P0, ~P1, ~P2, ~P3};
+
+    // every stripe of a block uses a different part of the secret
+    usize stripe_count = (len - 1) / STRIPE_SIZE;
+    usize i_stripe     = 0;
+    for (; i_stripe < stripe_count; i_stripe += 1)
+    {
+        usize i_in_block = i_stripe % BLOCK_STRIPES;
+        accumulate_stripe(acc, p + i_stripe * STRIPE_SIZE, secret + i_in_block);
+        if (i_in_block == BLOCK_STRIPES - 1)
+        {
+            scramble(acc, secret + BLOCK_STRIPES);
+        }
+    }
+
+    // the last stripe overlaps the previous one
+    accumulate_stripe(acc, p + len - STRIPE_SIZE, secret + 7);
+
+    u64 result = len * P0;
+    for (usize i = 0; i < 8; i += 2)
+    {
+        result += mix(acc[i] ^ secret[i + 3], acc[i + 1] ^ secret[i + 4]);
+    }
+    return mix(result ^ P2, P1 ^ seed);
+}
+
+u64 hash_bytes(const void *data, usize len, u64 seed)
+{
+    const u8 *p = reinterpret_cast<const u8 *>(data);
+    if (len > LONG_INPUT_SIZE)
+    {
+        return hash_long(p, len, seed);
+    }
+
+    seed ^= mix(seed ^ P0, P1);
+
+    u64 a = 0;
+    u64 b = 0;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            usize middle = (len >> 3) << 2;
+            a            = (read32(p) << 32) | read32(p + middle);
+            b            = (read32(p + len - 4) << 32) | read32(p + len - 4 - middle);
+        }
+        else if (len > 0)
+        {
+            a = read_small(p, len);
+        }
+    }
+    else
+    {
+        usize remaining = len;
+        if (remaining > 48)
+        {
+            // 3 independent lanes to hide the latency of the multiplications
+            u64 seed1 = seed;
+            u64 seed2 = seed;
+            do
+            {
+                seed  = mix(read64(p) ^ P1, read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ P2, read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ P3, read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = mix(read64(p) ^ P1, read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        // the last 16 bytes overlap the previous ones
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= P1;
+    b ^= seed;
+    a = mix(a, b);
+    return mix(a ^ P0 ^ len, b ^ P1);
+}
+
+u64 hash_u64(u64 value, u64 seed)
+{
+    return mix(value ^ P0, seed ^ P1);
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/map.h"
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace test
+{
+    TEST_SUITE("Hash")
+    {
+        TEST_CASE("Hash bytes")
+        {
+            std::mt19937_64 rng{7};
+            Vec<u8> bytes(4096 + 1);
+            for (auto &byte : bytes) { byte = static_cast<u8>(rng()); }
+
+            // Every size goes through a different path, all of them must be deterministic and depend on every byte
+            for (usize len : {0u, 1u, 3u, 4u, 8u, 15u, 16u, 17u, 48u, 49u, 100u, 256u, 257u, 1000u, 1024u, 1025u, 4096u})
+            {
+                u64 h = hash_bytes(bytes.data(), len);
+                CHECK(h == hash_bytes(bytes.data(), len));
+                CHECK(h != hash_bytes(bytes.data(), len, 1));
+                CHECK(h != hash_bytes(bytes.data(), len + 1));
+
+                for (usize i_byte = 0; i_byte < len; i_byte += 1 + len / 16)
+                {
+                    bytes[i_byte] ^= 1;
+                    CHECK(h != hash_bytes(bytes.data(), len));
+                    bytes[i_byte] ^= 1;
+                }
+            }
+
+            // Swapping two stripes of a long input changes the hash
+            Vec<u8> swapped = bytes;
+            std::swap_ranges(swapped.begin(), swapped.begin() + 64, swapped.begin() + 64);
+            CHECK(hash_bytes(bytes.data(), bytes.size()) != hash_bytes(swapped.data(), swapped.size()));
+        }
+
+        TEST_CASE("Hash collisions")
+        {
+            // Sequential integers and strings that differ by one character should not collide, even on the low bits
+            constexpr u32 count = 1 << 16;
+            Set<u64> struct_hashes;
+            Set<u64> u64_hashes;
+            Set<u64> low_hashes;
+            for (u32 i = 0; i < count; i += 1)
+            {
+                struct_hashes.insert(hash_struct(i));
+                u64_hashes.insert(hash_u64(i));
+                low_hashes.insert(hash_u64(i) & 0xFFFFF);
+            }
+            CHECK(struct_hashes.size() == count);
+            CHECK(u64_hashes.size() == count);
+            // 2^16 values in 2^20 buckets, a good hash gives ~2000 collisions
+            CHECK(low_hashes.size() > count - 4000);
+
+            Set<u64> string_hashes;
+            std::string base(40, 'a');
+            for (usize i = 0; i < base.size(); i += 1)
+            {
+                for (char c = 'b'; c <= 'z'; c += 1)
+                {
+                    std::string s = base;
+                    s[i]          = c;
+                    string_hashes.insert(hash_bytes(s.data(), s.size()));
+                }
+            }
+            CHECK(string_hashes.size() == base.size() * 25);
+        }
+
+        TEST_CASE("Hash containers")
+        {
+            Vec<u32> a = {1, 2, 3};
+            Vec<u32> b = {1, 2, 4};
+            Vec<u32> c = {1, 2, 3};
+            CHECK(hash_value(a) == hash_value(c));
+            CHECK(hash_value(a) != hash_value(b));
+
+            std::size_t seed1 = 0;
+            hash_combine(seed1, 1);
+            hash_combine(seed1, 2);
+            std::size_t seed2 = 0;
+            hash_combine(seed2, 2);
+            hash_combine(seed2, 1);
+            CHECK(seed1 != seed2);
+        }
+    }
+}
+#endif
@@ -0,0 +1,354 @@
+#include "exo/jobs.h"
+
+#include "exo/collections/vector.h"
+
+#include <cassert>
+#include <cstring>
+#include <thread>
+
+namespace jobs
+{
+inline constexpr i64 DEQUE_CAPACITY = 4096;
+inline constexpr u32 SPIN_COUNT     = 64;
+
+// A job copied word by word with relaxed atomics: a thief can read a slot while the owner overwrites it after
+// the thief lost the race on `top`, the copy is then discarded but the accesses still have to be atomic.
+struct JobSlot
+{
+    static constexpr usize WORD_COUNT = sizeof(Job) / sizeof(u64);
+    static_assert(sizeof(Job) % sizeof(u64) == 0 && std::is_trivially_copyable_v<Job>);
+
+    std::atomic<u64> words[WORD_COUNT];
+
+    void store(const Job &job)
+    {
+        u64 job_words[WORD_COUNT];
+        std::memcpy(job_words, &job, sizeof(Job));
+        for (usize i = 0; i < WORD_COUNT; i += 1)
+        {
+            words[i].store(job_words[i], std::memory_order_relaxed);
+        }
+    }
+
+    void load(Job &job) const
+    {
+        u64 job_words[WORD_COUNT];
+        for (usize i = 0; i < WORD_COUNT; i += 1)
+        {
+            job_words[i] = words[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&job, job_words, sizeof(Job));
+    }
+};
+
+// Chase-Lev work-stealing deque with a fixed capacity (Le, Pop, Cohen, Nardelli 2013)
+// Only the owner thread calls push and pop, any thread can call steal.
+// Every store to `bottom` is a release and thieves load it with acquire, so a thief that sees a job also sees
+// everything the owner wrote before pushing it.
+struct alignas(64) Deque
+{
+    alignas(64) std::atomic<i64> top    = 0;
+    alignas(64) std::atomic<i64> bottom = 0;
+    JobSlot jobs[DEQUE_CAPACITY];
+
+    bool push(const Job &job)
+    {
+        i64 b = bottom.load(std::memory_order_relaxed);
+        i64 t = top.load(std::memory_order_acquire);
+        if (b - t >= DEQUE_CAPACITY)
+        {
+            return false;
+        }
+
+        jobs[b & (DEQUE_CAPACITY - 1)].store(job);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Job &job)
+    {
+        i64 b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // empty
+            bottom.store(b + 1, std::memory_order_release);
+            return false;
+        }
+
+        jobs[b & (DEQUE_CAPACITY - 1)].load(job);
+        if (t == b)
+        {
+            // last job, race against the thieves
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_release);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(Job &job)
+    {
+        i64 t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return false;
+        }
+
+        // The slot can only be overwritten after top moved, in that case the CAS fails and the copy is discarded
+        jobs[t & (DEQUE_CAPACITY - 1)].load(job);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+};
+
+struct JobSystem
+{
+    Vec<Deque *> deques;
+    Vec<std::thread> workers;
+    std::atomic<bool> running = false;
+    // incremented every time a job is pushed, sleeping workers wait on it
+    std::atomic<u32> epoch = 0;
+};
+
+static JobSystem g_jobs;
+// index of the deque owned by the current thread, the main thread is 0
+static thread_local u32 tls_thread_index = u32_invalid;
+static thread_local u32 tls_steal_seed   = 0;
+
+static void run_job(Job &job)
+{
+    Counter *counter = job.counter;
+    job.function(job);
+    counter->value.fetch_sub(1, std::memory_order_release);
+}
+
+static bool find_job(Job &job)
+{
+    const u32 deque_count = static_cast<u32>(g_jobs.deques.size());
+
+    if (tls_thread_index != u32_invalid && g_jobs.deques[tls_thread_index]->pop(job))
+    {
+        return true;
+    }
+
+    // xorshift to pick a random victim
+    u32 seed       = tls_steal_seed != 0 ? tls_steal_seed : (tls_thread_index + 1) * 2654435761u;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    tls_steal_seed = seed;
+
+    for (u32 i = 0; i < deque_count; i += 1)
+    {
+        u32 victim = (seed + i) % deque_count;
+        if (victim != tls_thread_index && g_jobs.deques[victim]->steal(job))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void worker_main(u32 thread_index)
+{
+    tls_thread_index = thread_index;
+
+    Job job = {};
+    while (g_jobs.running.load(std::memory_order_acquire))
+    {
+        bool found = false;
+        for (u32 i_spin = 0; i_spin < SPIN_COUNT && !found; i_spin += 1)
+        {
+            found = find_job(job);
+            if (!found)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (found)
+        {
+            run_job(job);
+            continue;
+        }
+
+        // Read the epoch before the last try, a push or a shutdown after it will wake us up
+        u32 epoch = g_jobs.epoch.load(std::memory_order_acquire);
+        if (!g_jobs.running.load(std::memory_order_acquire))
+        {
+            break;
+        }
+        if (find_job(job))
+        {
+            run_job(job);
+            continue;
+        }
+        g_jobs.epoch.wait(epoch, std::memory_order_acquire);
+    }
+}
+
+void init(u32 worker_count)
+{
+    assert(!is_initialized());
+
+    if (worker_count == 0)
+    {
+        u32 hardware_threads = std::thread::hardware_concurrency();
+        worker_count         = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+
+    g_jobs.deques.resize(worker_count + 1);
+    for (auto &deque : g_jobs.deques)
+    {
+        deque = new Deque();
+    }
+
+    tls_thread_index = 0;
+    g_jobs.running.store(true, std::memory_order_release);
+    g_jobs.workers.reserve(worker_count);
+    for (u32 i_worker = 0; i_worker < worker_count; i_worker += 1)
+    {
+        g_jobs.workers.emplace_back(worker_main, i_worker + 1);
+    }
+}
+
+void shutdown()
+{
+    if (!is_initialized())
+    {
+        return;
+    }
+
+    g_jobs.running.store(false, std::memory_order_release);
+    g_jobs.epoch.fetch_add(1, std::memory_order_release);
+    g_jobs.epoch.notify_all();
+
+    for (auto &worker : g_jobs.workers)
+    {
+        worker.join();
+    }
+    for (auto *deque : g_jobs.deques)
+    {
+        delete deque;
+    }
+
+    g_jobs.workers.clear();
+    g_jobs.deques.clear();
+    tls_thread_index = u32_invalid;
+}
+
+bool is_initialized() { return g_jobs.running.load(std::memory_order_acquire); }
+
+u32 thread_count() { return is_initialized() ? static_cast<u32>(g_jobs.deques.size()) : 1; }
+
+u32 thread_index() { return tls_thread_index; }
+
+void spawn_job(const Job &job)
+{
+    job.counter->value.fetch_add(1, std::memory_order_relaxed);
+
+    // Threads outside of the pool don't own a deque, and a full deque cannot take more jobs: run it now
+    if (!is_initialized() || tls_thread_index == u32_invalid || !g_jobs.deques[tls_thread_index]->push(job))
+    {
+        Job copy = job;
+        run_job(copy);
+        return;
+    }
+
+    g_jobs.epoch.fetch_add(1, std::memory_order_release);
+    g_jobs.epoch.notify_one();
+}
+
+bool try_run_one()
+{
+    Job job = {};
+    if (is_initialized() && find_job(job))
+    {
+        run_job(job);
+        return true;
+    }
+    return false;
+}
+
+void wait(Counter &counter)
+{
+    while (!counter.is_done())
+    {
+        if (!try_run_one())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+} // namespace jobs
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+
+namespace test
+{
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("Jobs without init run inline")
+        {
+            jobs::Counter counter = {};
+            u32 value             = 0;
+            jobs::spawn(counter, [&]() { value = 42; });
+            CHECK(counter.is_done());
+            CHECK(value == 42);
+
+            Vec<u32> values(100, 0);
+            jobs::parallel_for(values.size(), [&](usize i) { values[i] = u32(i); });
+            for (usize i = 0; i < values.size(); i += 1)
+            {
+                CHECK(values[i] == i);
+            }
+        }
+
+        TEST_CASE("Jobs")
+        {
+            jobs::init(4);
+            CHECK(jobs::thread_count() == 5);
+
+            std::atomic<u32> sum  = 0;
+            jobs::Counter counter = {};
+            for (u32 i = 0; i < 1000; i += 1)
+            {
+                jobs::spawn(counter, [&sum, i]() { sum.fetch_add(i); });
+            }
+            jobs::wait(counter);
+            CHECK(sum.load() == 999 * 1000 / 2);
+
+            // Every index is visited exactly once, whatever the grain
+            for (usize grain : {usize(0), usize(1), usize(7), usize(1000)})
+            {
+                Vec<std::atomic<u32>> visits(10'000);
+                jobs::parallel_for(visits.size(), grain, [&](usize i) { visits[i].fetch_add(1); });
+
+                u32 errors = 0;
+                for (auto &visit : visits)
+                {
+                    errors += visit.load() != 1;
+                }
+                CHECK(errors == 0);
+            }
+
+            // Nested parallel_for from a worker
+            std::atomic<u32> nested = 0;
+            jobs::parallel_for(16, 1, [&](usize) {
+                jobs::parallel_for(64, 4, [&](usize) { nested.fetch_add(1); });
+            });
+            CHECK(nested.load() == 16 * 64);
+
+            jobs::shutdown();
+            CHECK(!jobs::is_initialized());
+        }
+    }
+}
+#endif
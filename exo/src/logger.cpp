@@ -0,0 +1,518 @@
+#include "exo/logger.h"
+
+#include "exo/collections/vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace logger
+{
+inline constexpr u32 QUEUE_CAPACITY   = 256 * 1024;
+inline constexpr u32 MAX_MESSAGE_SIZE = 64 * 1024;
+inline constexpr u32 WRAP_MARKER      = u32_invalid;
+
+static u64 now_ns()
+{
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Same layout as the records of the binary sink
+struct RecordHeader
+{
+    u64 timestamp_ns;
+    u32 thread_id;
+    u32 level;
+    u32 size;
+    u32 padding;
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+// Records are aligned to 8 bytes, the end of the ring is skipped when a record doesn't fit
+inline constexpr u32 RECORD_ALIGNMENT = 8;
+
+static u32 record_size(u32 message_size)
+{
+    return static_cast<u32>(sizeof(RecordHeader)) + ((message_size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1));
+}
+
+// Single producer (the owner thread), single consumer (the logger thread) byte ring
+struct ThreadQueue
+{
+    u32 thread_id;
+    // set when the owner thread exits, the logger thread frees the queue once it is drained
+    std::atomic<bool> closed = false;
+    alignas(64) std::atomic<u64> head = 0; // written by the producer
+    alignas(64) std::atomic<u64> tail = 0; // written by the consumer
+    alignas(64) u8 data[QUEUE_CAPACITY];
+};
+
+struct Logger
+{
+    Logger();
+    ~Logger();
+
+    void run();
+    bool drain();
+
+    // protects the list of queues, only the logger thread removes queues and reads their records
+    std::mutex mutex;
+    // queues are kept after their thread exits, until their messages are written
+    Vec<std::unique_ptr<ThreadQueue>> queues;
+    u32 next_thread_id = 0;
+
+    // held while writing to the binary sink
+    std::mutex sink_mutex;
+    FILE *binary_sink = nullptr;
+
+    // flush() wakes the logger thread instead of waiting for the end of its sleep, it doesn't sleep until drain_count
+    // reaches the target
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    u64 wake_target = 0;
+
+    std::atomic<bool> running       = true;
+    std::atomic<u64> drain_count    = 0;
+    std::atomic<Level> console_level = Level::Trace;
+    std::thread thread;
+};
+
+static Logger &get_logger()
+{
+    static Logger logger;
+    return logger;
+}
+
+// Closes the queue of the thread when it exits
+struct QueueOwner
+{
+    ThreadQueue *queue = nullptr;
+
+    ~QueueOwner()
+    {
+        if (queue)
+        {
+            queue->closed.store(true, std::memory_order_release);
+            // the logger thread may free it now, a later message of this thread gets a new queue
+            queue = nullptr;
+        }
+    }
+};
+
+static thread_local QueueOwner tls_queue;
+
+static ThreadQueue &get_thread_queue()
+{
+    if (tls_queue.queue == nullptr)
+    {
+        auto &logger = get_logger();
+        std::lock_guard lock{logger.mutex};
+
+        auto queue       = std::make_unique<ThreadQueue>();
+        queue->thread_id = logger.next_thread_id;
+        tls_queue.queue  = queue.get();
+        logger.next_thread_id += 1;
+        logger.queues.push_back(std::move(queue));
+    }
+    return *tls_queue.queue;
+}
+
+void push(Level level, const char *message, usize size)
+{
+    auto &queue       = get_thread_queue();
+    u32 message_size  = static_cast<u32>(std::min<usize>(size, MAX_MESSAGE_SIZE));
+    u32 required_size = record_size(message_size);
+
+    u64 head   = queue.head.load(std::memory_order_relaxed);
+    u32 offset = static_cast<u32>(head % QUEUE_CAPACITY);
+    u32 to_end = QUEUE_CAPACITY - offset;
+
+    // The record doesn't fit before the end of the ring: mark the end as skipped and start at the beginning
+    u64 total_size = to_end < required_size ? to_end + required_size : required_size;
+
+    // The queue is full, wait for the logger thread
+    while (head + total_size - queue.tail.load(std::memory_order_acquire) > QUEUE_CAPACITY)
+    {
+        std::this_thread::yield();
+    }
+
+    if (to_end < required_size)
+    {
+        // the consumer skips the end without a marker when it is smaller than a header
+        if (to_end >= sizeof(RecordHeader))
+        {
+            RecordHeader marker = {};
+            marker.size         = WRAP_MARKER;
+            std::memcpy(queue.data + offset, &marker, sizeof(marker));
+        }
+        offset = 0;
+    }
+
+    RecordHeader header = {};
+    header.timestamp_ns = now_ns();
+    header.thread_id    = queue.thread_id;
+    header.level        = static_cast<u32>(level);
+    header.size         = message_size;
+    std::memcpy(queue.data + offset, &header, sizeof(header));
+    std::memcpy(queue.data + offset + sizeof(header), message, message_size);
+
+    queue.head.store(head + total_size, std::memory_order_release);
+
+    // Errors are often followed by an exception or a crash, write them before returning
+    if (level >= Level::Error)
+    {
+        flush();
+    }
+}
+
+Logger::Logger()
+{
+    thread = std::thread([this]() { run(); });
+}
+
+Logger::~Logger()
+{
+    {
+        std::lock_guard lock{wake_mutex};
+        running.store(false, std::memory_order_release);
+    }
+    wake_condition.notify_one();
+    thread.join();
+
+    if (binary_sink)
+    {
+        std::fclose(binary_sink);
+    }
+}
+
+void Logger::run()
+{
+    while (true)
+    {
+        // Read the flag before draining to write the messages pushed before the destruction
+        bool should_exit = !running.load(std::memory_order_acquire);
+        bool wrote       = drain();
+        drain_count.fetch_add(1, std::memory_order_release);
+        drain_count.notify_all();
+
+        if (should_exit)
+        {
+            break;
+        }
+        if (!wrote)
+        {
+            std::unique_lock lock{wake_mutex};
+            wake_condition.wait_for(lock, std::chrono::milliseconds(1), [&]() {
+                return drain_count.load(std::memory_order_relaxed) < wake_target || !running.load(std::memory_order_relaxed);
+            });
+        }
+    }
+}
+
+bool Logger::drain()
+{
+    struct Pending
+    {
+        const RecordHeader *header;
+        const u8 *message;
+    };
+
+    // Only this thread removes queues: the snapshot stays valid without the lock, new threads can register during the I/O
+    Vec<ThreadQueue *> snapshot;
+    {
+        std::lock_guard lock{mutex};
+        snapshot.reserve(queues.size());
+        for (auto &queue : queues)
+        {
+            snapshot.push_back(queue.get());
+        }
+    }
+
+    // Gather the records of every queue to write them in time order
+    Vec<Pending> records;
+    Vec<u64> heads(snapshot.size());
+    for (usize i_queue = 0; i_queue < snapshot.size(); i_queue += 1)
+    {
+        auto &queue    = *snapshot[i_queue];
+        u64 head       = queue.head.load(std::memory_order_acquire);
+        u64 tail       = queue.tail.load(std::memory_order_relaxed);
+        heads[i_queue] = head;
+
+        while (tail < head)
+        {
+            u32 offset   = static_cast<u32>(tail % QUEUE_CAPACITY);
+            auto *header = reinterpret_cast<const RecordHeader *>(queue.data + offset);
+            if (QUEUE_CAPACITY - offset < sizeof(RecordHeader) || header->size == WRAP_MARKER)
+            {
+                tail += QUEUE_CAPACITY - offset;
+                continue;
+            }
+
+            records.push_back({header, queue.data + offset + sizeof(RecordHeader)});
+            tail += record_size(header->size);
+        }
+    }
+
+    std::stable_sort(records.begin(), records.end(), [](const Pending &a, const Pending &b) {
+        return a.header->timestamp_ns < b.header->timestamp_ns;
+    });
+
+    Level min_console_level = console_level.load(std::memory_order_relaxed);
+    {
+        std::lock_guard sink_lock{sink_mutex};
+        for (const auto &record : records)
+        {
+            auto level = static_cast<Level>(record.header->level);
+            if (level >= min_console_level)
+            {
+                std::fwrite(record.message, 1, record.header->size, level >= Level::Error ? stderr : stdout);
+            }
+
+            if (binary_sink)
+            {
+                std::fwrite(record.header, 1, sizeof(RecordHeader), binary_sink);
+                std::fwrite(record.message, 1, record.header->size, binary_sink);
+            }
+        }
+
+        if (!records.empty())
+        {
+            std::fflush(stdout);
+            std::fflush(stderr);
+            if (binary_sink)
+            {
+                std::fflush(binary_sink);
+            }
+        }
+    }
+
+    // The records have been written, the producers can reuse their space
+    for (usize i_queue = 0; i_queue < snapshot.size(); i_queue += 1)
+    {
+        snapshot[i_queue]->tail.store(heads[i_queue], std::memory_order_release);
+    }
+
+    // The thread of a closed queue cannot push anymore, free it when all its records have been written.
+    // The queues registered since the snapshot are after it.
+    std::lock_guard lock{mutex};
+    usize kept = 0;
+    for (usize i_queue = 0; i_queue < queues.size(); i_queue += 1)
+    {
+        auto &queue = queues[i_queue];
+        if (i_queue < snapshot.size() && queue->closed.load(std::memory_order_acquire)
+            && queue->head.load(std::memory_order_relaxed) == heads[i_queue])
+        {
+            queue.reset();
+            continue;
+        }
+        if (kept != i_queue)
+        {
+            queues[kept] = std::move(queue);
+        }
+        kept += 1;
+    }
+    queues.resize(kept);
+
+    return !records.empty();
+}
+
+void flush()
+{
+    auto &logger = get_logger();
+
+    // The pass running now may have started before the call, wait for the next one to finish.
+    // Nothing drains the queues after the logger thread exited.
+    u64 drain_count = logger.drain_count.load(std::memory_order_acquire);
+    u64 target      = drain_count + 2;
+    {
+        std::lock_guard lock{logger.wake_mutex};
+        logger.wake_target = std::max(logger.wake_target, target);
+    }
+    logger.wake_condition.notify_one();
+
+    while (logger.running.load(std::memory_order_acquire) && drain_count < target)
+    {
+        logger.drain_count.wait(drain_count, std::memory_order_acquire);
+        drain_count = logger.drain_count.load(std::memory_order_acquire);
+    }
+}
+
+void set_console_level(Level level) { get_logger().console_level.store(level, std::memory_order_relaxed); }
+
+bool open_binary_sink(const char *path)
+{
+    FILE *file = std::fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+
+    auto &logger = get_logger();
+    std::lock_guard lock{logger.sink_mutex};
+    if (logger.binary_sink)
+    {
+        std::fclose(logger.binary_sink);
+    }
+    logger.binary_sink = file;
+    return true;
+}
+
+void close_binary_sink()
+{
+    auto &logger = get_logger();
+    std::lock_guard lock{logger.sink_mutex};
+    if (logger.binary_sink)
+    {
+        std::fclose(logger.binary_sink);
+        logger.binary_sink = nullptr;
+    }
+}
+
+RateLimiter::RateLimiter(double interval_ms) : interval_ns{static_cast<u64>(interval_ms * 1'000'000.0)} {}
+
+bool RateLimiter::allow()
+{
+    u64 now  = now_ns();
+    u64 next = next_ns.load(std::memory_order_relaxed);
+    return now >= next && next_ns.compare_exchange_strong(next, now + interval_ns, std::memory_order_relaxed);
+}
+} // namespace logger
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <string>
+
+namespace test
+{
+    TEST_CASE("Logger")
+    {
+        const char *path = "logger_test.bin";
+        logger::set_console_level(logger::Level::Error);
+        REQUIRE(logger::open_binary_sink(path));
+
+        constexpr u32 thread_count = 4;
+        constexpr u32 message_count = 5'000;
+
+        Vec<std::thread> threads;
+        for (u32 i_thread = 0; i_thread < thread_count; i_thread += 1)
+        {
+            threads.emplace_back([i_thread]() {
+                for (u32 i = 0; i < message_count; i += 1)
+                {
+                    logger::info("thread {} message {}\n", i_thread, i);
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        // Bigger than the stack buffer
+        std::string long_message(2 * logger::INLINE_MESSAGE_SIZE, 'a');
+        logger::debug("{}", long_message);
+
+        logger::flush();
+        logger::close_binary_sink();
+        logger::set_console_level(logger::Level::Trace);
+
+        FILE *file = std::fopen(path, "rb");
+        REQUIRE(file);
+
+        Vec<u32> next_message(thread_count, 0);
+        u32 errors      = 0;
+        bool found_long = false;
+
+        logger::RecordHeader header;
+        std::string message;
+        while (std::fread(&header, sizeof(header), 1, file) == 1)
+        {
+            message.resize(header.size);
+            std::fread(message.data(), 1, header.size, file);
+
+            if (static_cast<logger::Level>(header.level) == logger::Level::Debug)
+            {
+                found_long = message == long_message;
+                continue;
+            }
+
+            // the messages of a thread are in order
+            u32 i_thread = 0, i = 0;
+            if (std::sscanf(message.c_str(), "thread %u message %u", &i_thread, &i) != 2 || i_thread >= thread_count || next_message[i_thread] != i)
+            {
+                errors += 1;
+                continue;
+            }
+            next_message[i_thread] += 1;
+        }
+        std::fclose(file);
+        std::remove(path);
+
+        CHECK(errors == 0);
+        CHECK(found_long);
+        for (u32 count : next_message)
+        {
+            CHECK(count == message_count);
+        }
+    }
+
+    TEST_CASE("Logger errors are written before returning")
+    {
+        const char *path = "logger_error_test.bin";
+        REQUIRE(logger::open_binary_sink(path));
+        logger::error("logger test error, expected\n");
+        // no flush
+        logger::close_binary_sink();
+
+        FILE *file = std::fopen(path, "rb");
+        REQUIRE(file);
+        logger::RecordHeader header;
+        bool found_error = std::fread(&header, sizeof(header), 1, file) == 1 && static_cast<logger::Level>(header.level) == logger::Level::Error;
+        std::fclose(file);
+        std::remove(path);
+
+        CHECK(found_error);
+    }
+
+    TEST_CASE("Logger flush wakes the logger thread")
+    {
+        // the logger thread sleeps 1 ms when it has nothing to write, a flush does not wait for the end of the sleep
+        constexpr u32 flush_count = 100;
+        auto start = std::chrono::steady_clock::now();
+        for (u32 i = 0; i < flush_count; i += 1)
+        {
+            logger::flush();
+        }
+        CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(flush_count / 2));
+    }
+
+    TEST_CASE("Logger frees the queues of exited threads")
+    {
+        logger::set_console_level(logger::Level::Error);
+        for (u32 i_thread = 0; i_thread < 8; i_thread += 1)
+        {
+            std::thread{[]() { logger::info("short lived thread\n"); }}.join();
+        }
+        logger::flush();
+        logger::set_console_level(logger::Level::Trace);
+
+        auto &logger = logger::get_logger();
+        std::lock_guard lock{logger.mutex};
+        // only the queue of this thread is left
+        CHECK(logger.queues.size() == 1);
+    }
+
+    TEST_CASE("Logger rate limiter")
+    {
+        logger::RateLimiter limiter{1000.0};
+        CHECK(limiter.allow());
+        CHECK(!limiter.allow());
+        CHECK(!limiter.allow());
+    }
+}
+#endif
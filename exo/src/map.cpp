@@ -0,0 +1,149 @@
+#include "exo/map.h"
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace test
+{
+    // Every key lands in the same slot, exercises probing and backward shift deletion
+    struct BadHash
+    {
+        usize operator()(u32) const { return 42; }
+    };
+
+    TEST_SUITE("Map")
+    {
+        TEST_CASE("Map")
+        {
+            Map<u32, u32> map;
+            CHECK(map.empty());
+            CHECK(!map.contains(1));
+            CHECK(map.find(1) == map.end());
+
+            map[1] = 10;
+            map[2] = 20;
+            map.insert({3, 30});
+            CHECK(map.size() == 3);
+            CHECK(map.at(1) == 10);
+            CHECK(map.at(2) == 20);
+            CHECK(map.at(3) == 30);
+            CHECK(map.find(2)->second == 20);
+
+            // Inserting an existing key does not overwrite it
+            auto [it, inserted] = map.insert({1, 11});
+            CHECK(!inserted);
+            CHECK(it->second == 10);
+            map.insert_or_assign(1, 11u);
+            CHECK(map.at(1) == 11);
+
+            // Iteration follows insertion order
+            u32 expected[] = {1, 2, 3};
+            u32 i = 0;
+            for (auto &[key, value] : map)
+            {
+                CHECK(key == expected[i++]);
+                value += 1;
+            }
+            CHECK(map.at(3) == 31);
+
+            // Erase moves the last entry into the hole
+            CHECK(map.erase(1) == 1);
+            CHECK(map.erase(1) == 0);
+            CHECK(map.size() == 2);
+            CHECK(!map.contains(1));
+            CHECK(map.begin()->first == 3);
+            CHECK(map.at(2) == 21);
+
+            map.clear();
+            CHECK(map.empty());
+            CHECK(!map.contains(2));
+            map[2] = 2;
+            CHECK(map.at(2) == 2);
+        }
+
+        TEST_CASE("Map collisions")
+        {
+            Map<u32, u32, BadHash> map;
+            for (u32 i = 0; i < 100; i += 1)
+            {
+                map[i] = i;
+            }
+            CHECK(map.size() == 100);
+
+            // Remove every other key, the others must still be reachable without tombstones
+            for (u32 i = 0; i < 100; i += 2)
+            {
+                CHECK(map.erase(i) == 1);
+            }
+            for (u32 i = 0; i < 100; i += 1)
+            {
+                CHECK(map.contains(i) == (i % 2 == 1));
+            }
+        }
+
+        TEST_CASE("Map matches std::unordered_map")
+        {
+            std::mt19937 rng{42};
+            Map<u32, u32> map;
+            std::unordered_map<u32, u32> reference;
+            for (u32 i = 0; i < 100'000; i += 1)
+            {
+                u32 key = rng() % 4096;
+                if (rng() % 3 == 0)
+                {
+                    CHECK(map.erase(key) == reference.erase(key));
+                }
+                else
+                {
+                    map[key] = i;
+                    reference[key] = i;
+                }
+            }
+
+            CHECK(map.size() == reference.size());
+            for (const auto &[key, value] : reference)
+            {
+                REQUIRE(map.contains(key));
+                CHECK(map.at(key) == value);
+            }
+            for (u32 key = 0; key < 4096; key += 1)
+            {
+                CHECK(map.contains(key) == reference.contains(key));
+            }
+        }
+
+        TEST_CASE("Map string keys")
+        {
+            Map<std::string, int> map = {{"one", 1}, {"two", 2}};
+            CHECK(map.at("one") == 1);
+            CHECK(map.at("two") == 2);
+            map["three"] = 3;
+            CHECK(map.size() == 3);
+            map.erase("one");
+            CHECK(!map.contains("one"));
+            CHECK(map.at("three") == 3);
+        }
+
+        TEST_CASE("Set")
+        {
+            Set<u32> set = {1, 2, 3};
+            CHECK(set.size() == 3);
+            CHECK(set.contains(2));
+            CHECK(!set.insert(2).second);
+            CHECK(set.insert(4).second);
+            CHECK(set.erase(1) == 1);
+            CHECK(!set.contains(1));
+
+            u32 sum = 0;
+            for (u32 key : set)
+            {
+                sum += key;
+            }
+            CHECK(sum == 2 + 3 + 4);
+        }
+    }
+}
+#endif
@@ -0,0 +1,178 @@
+#include "exo/memory_tracker.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+namespace memory_tracker
+{
+struct alignas(64) TagCounters
+{
+    std::atomic<u64> current          = 0;
+    std::atomic<u64> peak             = 0;
+    std::atomic<u64> allocation_count = 0;
+};
+
+struct Tracker
+{
+    std::mutex mutex;
+    const char *names[MAX_TAGS] = {};
+    std::atomic<u32> tag_count  = 0;
+    TagCounters counters[MAX_TAGS];
+};
+
+static Tracker &get_tracker()
+{
+    static Tracker tracker;
+    return tracker;
+}
+
+u32 register_tag(const char *name)
+{
+    auto &tracker = get_tracker();
+    std::lock_guard lock{tracker.mutex};
+
+    u32 tag_count = tracker.tag_count.load(std::memory_order_relaxed);
+    for (u32 i_tag = 0; i_tag < tag_count; i_tag += 1)
+    {
+        if (std::strcmp(tracker.names[i_tag], name) == 0)
+        {
+            return i_tag;
+        }
+    }
+
+    assert(tag_count < MAX_TAGS);
+    tracker.names[tag_count] = name;
+    tracker.tag_count.store(tag_count + 1, std::memory_order_release);
+    return tag_count;
+}
+
+void on_allocate(u32 tag, usize size)
+{
+    auto &counters = get_tracker().counters[tag];
+    counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+    u64 current = counters.current.fetch_add(size, std::memory_order_relaxed) + size;
+
+    u64 peak = counters.peak.load(std::memory_order_relaxed);
+    while (current > peak && !counters.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+void on_free(u32 tag, usize size)
+{
+    get_tracker().counters[tag].current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+Vec<TagStats> stats()
+{
+    auto &tracker = get_tracker();
+
+    Vec<TagStats> result;
+    u32 tag_count = tracker.tag_count.load(std::memory_order_acquire);
+    result.reserve(tag_count);
+    for (u32 i_tag = 0; i_tag < tag_count; i_tag += 1)
+    {
+        const auto &counters = tracker.counters[i_tag];
+        result.push_back({
+            .name             = tracker.names[i_tag],
+            .current          = counters.current.load(std::memory_order_relaxed),
+            .peak             = counters.peak.load(std::memory_order_relaxed),
+            .allocation_count = counters.allocation_count.load(std::memory_order_relaxed),
+        });
+    }
+    return result;
+}
+
+std::string dump()
+{
+    std::string result = "[Memory] tag: current | peak | allocations\n";
+    char line[256];
+    for (const auto &tag : stats())
+    {
+        std::snprintf(line,
+                      sizeof(line),
+                      "[Memory] %s: %.3f MiB | %.3f MiB | %llu\n",
+                      tag.name,
+                      double(tag.current) / (1024.0 * 1024.0),
+                      double(tag.peak) / (1024.0 * 1024.0),
+                      static_cast<unsigned long long>(tag.allocation_count));
+        result += line;
+    }
+    return result;
+}
+} // namespace memory_tracker
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <thread>
+
+namespace test
+{
+    struct TestMemory
+    {
+        static constexpr const char *name = "Test";
+    };
+
+    static memory_tracker::TagStats test_stats()
+    {
+        for (const auto &tag : memory_tracker::stats())
+        {
+            if (std::strcmp(tag.name, TestMemory::name) == 0)
+            {
+                return tag;
+            }
+        }
+        return {};
+    }
+
+    TEST_CASE("Memory tracker")
+    {
+        auto before = test_stats();
+        {
+            TaggedVec<TestMemory, u32> vec;
+            vec.reserve(256);
+            auto during = test_stats();
+            CHECK(during.current == before.current + 256 * sizeof(u32));
+            CHECK(during.peak >= during.current);
+            CHECK(during.allocation_count == before.allocation_count + 1);
+        }
+        auto after = test_stats();
+        CHECK(after.current == before.current);
+        CHECK(after.peak >= before.current + 256 * sizeof(u32));
+
+        // Registering the same name twice returns the same tag
+        CHECK(memory_tracker::register_tag("Test") == memory_tracker::tag_index<TestMemory>());
+        CHECK(memory_tracker::dump().find("Test") != std::string::npos);
+    }
+
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("Memory tracker threads")
+        {
+            auto before = test_stats();
+
+            Vec<std::thread> threads;
+            for (u32 i_thread = 0; i_thread < 4; i_thread += 1)
+            {
+                threads.emplace_back([]() {
+                    for (u32 i = 0; i < 1'000; i += 1)
+                    {
+                        TaggedVec<TestMemory, u64> vec(i + 1);
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+
+            auto after = test_stats();
+            CHECK(after.current == before.current);
+            CHECK(after.allocation_count == before.allocation_count + 4 * 1'000);
+        }
+    }
+}
+#endif
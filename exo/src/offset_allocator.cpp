@@ -0,0 +1,467 @@
+#include "exo/offset_allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+/// --- Small floats
+// Sizes are stored as floats with 3 bits of mantissa, the bins of a top bin are 8 linear steps of the same exponent
+static constexpr u32 MANTISSA_BITS  = 3;
+static constexpr u32 MANTISSA_VALUE = 1 << MANTISSA_BITS;
+static constexpr u32 MANTISSA_MASK  = MANTISSA_VALUE - 1;
+
+// The returned bin is large enough for size
+static u32 size_to_bin_round_up(u32 size)
+{
+    if (size < MANTISSA_VALUE)
+    {
+        return size; // denormals
+    }
+
+    u32 highest_bit    = 31 - static_cast<u32>(std::countl_zero(size));
+    u32 mantissa_start = highest_bit - MANTISSA_BITS;
+    u32 exponent       = mantissa_start + 1;
+    u32 mantissa       = (size >> mantissa_start) & MANTISSA_MASK;
+
+    u32 low_bits_mask = (1u << mantissa_start) - 1;
+    if ((size & low_bits_mask) != 0)
+    {
+        mantissa += 1;
+    }
+
+    // the mantissa can overflow into the exponent
+    return (exponent << MANTISSA_BITS) + mantissa;
+}
+
+// The returned bin is not larger than size
+static u32 size_to_bin_round_down(u32 size)
+{
+    if (size < MANTISSA_VALUE)
+    {
+        return size;
+    }
+
+    u32 highest_bit    = 31 - static_cast<u32>(std::countl_zero(size));
+    u32 mantissa_start = highest_bit - MANTISSA_BITS;
+    u32 exponent       = mantissa_start + 1;
+    u32 mantissa       = (size >> mantissa_start) & MANTISSA_MASK;
+    return (exponent << MANTISSA_BITS) | mantissa;
+}
+
+[[maybe_unused]] static u32 bin_to_size(u32 bin)
+{
+    u32 exponent = bin >> MANTISSA_BITS;
+    u32 mantissa = bin & MANTISSA_MASK;
+    return exponent == 0 ? mantissa : (mantissa | MANTISSA_VALUE) << (exponent - 1);
+}
+
+static u32 find_lowest_set_bit_after(u32 mask, u32 start)
+{
+    if (start >= 32)
+    {
+        return u32_invalid;
+    }
+    u32 bits_after = mask & ~((1u << start) - 1);
+    return bits_after ? static_cast<u32>(std::countr_zero(bits_after)) : u32_invalid;
+}
+
+/// --- OffsetAllocator
+
+OffsetAllocator OffsetAllocator::create(u32 size)
+{
+    OffsetAllocator allocator;
+    allocator.size = size;
+    allocator.reset();
+    return allocator;
+}
+
+void OffsetAllocator::reset()
+{
+    free_space        = 0;
+    free_region_count = 0;
+    allocation_count  = 0;
+    used_bins_top     = 0;
+    for (auto &bin : used_bins)
+    {
+        bin = 0;
+    }
+    for (auto &bin_index : bin_indices)
+    {
+        bin_index = u32_invalid;
+    }
+    nodes.clear();
+    free_nodes.clear();
+
+    if (size > 0)
+    {
+        insert_node_into_bin(size, 0);
+    }
+}
+
+u32 OffsetAllocator::new_node()
+{
+    if (free_nodes.empty())
+    {
+        nodes.emplace_back();
+        return static_cast<u32>(nodes.size() - 1);
+    }
+
+    u32 node_index = free_nodes.back();
+    free_nodes.pop_back();
+    nodes[node_index] = {};
+    return node_index;
+}
+
+u32 OffsetAllocator::insert_node_into_bin(u32 node_size, u32 data_offset)
+{
+    u32 bin_index      = size_to_bin_round_down(node_size);
+    u32 top_bin_index  = bin_index >> MANTISSA_BITS;
+    u32 leaf_bin_index = bin_index & MANTISSA_MASK;
+
+    // the bin was empty, mark it as used
+    if (bin_indices[bin_index] == u32_invalid)
+    {
+        used_bins[top_bin_index] |= u8(1u << leaf_bin_index);
+        used_bins_top |= 1u << top_bin_index;
+    }
+
+    // push the node at the front of the bin's list
+    u32 top_node_index = bin_indices[bin_index];
+    u32 node_index     = new_node();
+    nodes[node_index]  = {.data_offset = data_offset, .data_size = node_size, .bin_list_next = top_node_index};
+    if (top_node_index != u32_invalid)
+    {
+        nodes[top_node_index].bin_list_prev = node_index;
+    }
+    bin_indices[bin_index] = node_index;
+
+    free_space += node_size;
+    free_region_count += 1;
+    return node_index;
+}
+
+void OffsetAllocator::remove_node_from_bin(u32 node_index)
+{
+    auto &node = nodes[node_index];
+
+    if (node.bin_list_prev != u32_invalid)
+    {
+        // easy case: the node is not the head of the list
+        nodes[node.bin_list_prev].bin_list_next = node.bin_list_next;
+        if (node.bin_list_next != u32_invalid)
+        {
+            nodes[node.bin_list_next].bin_list_prev = node.bin_list_prev;
+        }
+    }
+    else
+    {
+        u32 bin_index      = size_to_bin_round_down(node.data_size);
+        u32 top_bin_index  = bin_index >> MANTISSA_BITS;
+        u32 leaf_bin_index = bin_index & MANTISSA_MASK;
+
+        bin_indices[bin_index] = node.bin_list_next;
+        if (node.bin_list_next != u32_invalid)
+        {
+            nodes[node.bin_list_next].bin_list_prev = u32_invalid;
+        }
+
+        // the bin is now empty
+        if (bin_indices[bin_index] == u32_invalid)
+        {
+            used_bins[top_bin_index] &= u8(~(1u << leaf_bin_index));
+            if (used_bins[top_bin_index] == 0)
+            {
+                used_bins_top &= ~(1u << top_bin_index);
+            }
+        }
+    }
+
+    free_space -= node.data_size;
+    free_region_count -= 1;
+    free_nodes.push_back(node_index);
+}
+
+OffsetAllocation OffsetAllocator::allocate(u32 alloc_size, u32 alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    if (alloc_size == 0 || alloc_size > size)
+    {
+        return {};
+    }
+
+    // the simplest way to align: allocate enough padding to move the offset to the next aligned position
+    u32 padded_size = alloc_size + alignment - 1;
+
+    // round up to the bin that contains ranges that are all large enough
+    u32 min_bin_index      = size_to_bin_round_up(padded_size);
+    u32 min_top_bin_index  = min_bin_index >> MANTISSA_BITS;
+    u32 min_leaf_bin_index = min_bin_index & MANTISSA_MASK;
+
+    u32 top_bin_index  = min_top_bin_index;
+    u32 leaf_bin_index = u32_invalid;
+
+    // a larger bin in the same top bin
+    if (min_top_bin_index < TOP_BIN_COUNT && (used_bins_top & (1u << top_bin_index)))
+    {
+        leaf_bin_index = find_lowest_set_bit_after(used_bins[top_bin_index], min_leaf_bin_index);
+    }
+
+    // or the smallest bin of a larger top bin
+    if (leaf_bin_index == u32_invalid)
+    {
+        top_bin_index = find_lowest_set_bit_after(used_bins_top, min_top_bin_index + 1);
+        if (top_bin_index == u32_invalid)
+        {
+            return {};
+        }
+        leaf_bin_index = static_cast<u32>(std::countr_zero(u32(used_bins[top_bin_index])));
+    }
+
+    u32 bin_index  = (top_bin_index << MANTISSA_BITS) | leaf_bin_index;
+    u32 node_index = bin_indices[bin_index];
+    assert(node_index != u32_invalid);
+
+    // take the node out of the free list of its bin
+    u32 node_total_size = nodes[node_index].data_size;
+    remove_node_from_bin(node_index);
+    free_nodes.pop_back(); // the node is reused for the allocation
+
+    auto &node         = nodes[node_index];
+    node.data_size     = padded_size;
+    node.used          = true;
+    node.bin_list_prev = u32_invalid;
+    node.bin_list_next = u32_invalid;
+
+    // the rest of the range goes back to a bin
+    u32 remainder = node_total_size - padded_size;
+    if (remainder > 0)
+    {
+        u32 data_offset     = nodes[node_index].data_offset + padded_size;
+        u32 new_node_index  = insert_node_into_bin(remainder, data_offset);
+        auto &alloc_node    = nodes[node_index];
+        auto &new_free_node = nodes[new_node_index];
+
+        if (alloc_node.neighbor_next != u32_invalid)
+        {
+            nodes[alloc_node.neighbor_next].neighbor_prev = new_node_index;
+        }
+        new_free_node.neighbor_prev = node_index;
+        new_free_node.neighbor_next = alloc_node.neighbor_next;
+        alloc_node.neighbor_next    = new_node_index;
+    }
+
+    allocation_count += 1;
+
+    u32 data_offset = nodes[node_index].data_offset;
+    u32 aligned     = (data_offset + alignment - 1) & ~(alignment - 1);
+    return {.offset = aligned, .node = node_index};
+}
+
+void OffsetAllocator::free(OffsetAllocation allocation)
+{
+    assert(allocation.is_valid() && allocation.node < nodes.size());
+    assert(nodes[allocation.node].used);
+
+    u32 node_index  = allocation.node;
+    u32 data_offset = nodes[node_index].data_offset;
+    u32 data_size   = nodes[node_index].data_size;
+
+    // merge with the previous free range
+    u32 neighbor_prev = nodes[node_index].neighbor_prev;
+    if (neighbor_prev != u32_invalid && !nodes[neighbor_prev].used)
+    {
+        auto &prev_node = nodes[neighbor_prev];
+        assert(prev_node.neighbor_next == node_index);
+        data_offset = prev_node.data_offset;
+        data_size += prev_node.data_size;
+        u32 merged_index = neighbor_prev;
+        neighbor_prev    = prev_node.neighbor_prev;
+        remove_node_from_bin(merged_index);
+    }
+
+    // merge with the next free range
+    u32 neighbor_next = nodes[node_index].neighbor_next;
+    if (neighbor_next != u32_invalid && !nodes[neighbor_next].used)
+    {
+        auto &next_node = nodes[neighbor_next];
+        assert(next_node.neighbor_prev == node_index);
+        data_size += next_node.data_size;
+        u32 merged_index = neighbor_next;
+        neighbor_next    = next_node.neighbor_next;
+        remove_node_from_bin(merged_index);
+    }
+
+    // the allocation node is released and a new free node covers the merged range
+    nodes[node_index].used = false;
+    free_nodes.push_back(node_index);
+    allocation_count -= 1;
+
+    u32 combined_index = insert_node_into_bin(data_size, data_offset);
+    nodes[combined_index].neighbor_prev = neighbor_prev;
+    nodes[combined_index].neighbor_next = neighbor_next;
+    if (neighbor_prev != u32_invalid)
+    {
+        nodes[neighbor_prev].neighbor_next = combined_index;
+    }
+    if (neighbor_next != u32_invalid)
+    {
+        nodes[neighbor_next].neighbor_prev = combined_index;
+    }
+}
+
+u32 OffsetAllocator::allocation_size(OffsetAllocation allocation) const
+{
+    assert(allocation.is_valid() && nodes[allocation.node].used);
+    return nodes[allocation.node].data_size;
+}
+
+OffsetAllocatorStats OffsetAllocator::get_stats() const
+{
+    OffsetAllocatorStats stats = {};
+    stats.size              = size;
+    stats.free_space        = free_space;
+    stats.free_region_count = free_region_count;
+    stats.allocation_count  = allocation_count;
+
+    // the largest free region is in the highest used bin
+    if (used_bins_top)
+    {
+        u32 top_bin_index  = 31 - static_cast<u32>(std::countl_zero(used_bins_top));
+        u32 leaf_bin_index = 31 - static_cast<u32>(std::countl_zero(u32(used_bins[top_bin_index])));
+        u32 bin_index      = (top_bin_index << MANTISSA_BITS) | leaf_bin_index;
+        for (u32 node_index = bin_indices[bin_index]; node_index != u32_invalid; node_index = nodes[node_index].bin_list_next)
+        {
+            stats.largest_free_region = std::max(stats.largest_free_region, nodes[node_index].data_size);
+        }
+        assert(stats.largest_free_region >= bin_to_size(bin_index));
+    }
+
+    return stats;
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <random>
+
+namespace test
+{
+    TEST_SUITE("Offset allocator")
+    {
+        TEST_CASE("Offset allocator")
+        {
+            auto allocator = OffsetAllocator::create(1024);
+            CHECK(allocator.get_stats().free_space == 1024);
+            CHECK(allocator.get_stats().largest_free_region == 1024);
+
+            auto a = allocator.allocate(100);
+            auto b = allocator.allocate(200);
+            auto c = allocator.allocate(300);
+            REQUIRE(a.is_valid());
+            REQUIRE(b.is_valid());
+            REQUIRE(c.is_valid());
+            CHECK(a.offset == 0);
+            CHECK(b.offset == 100);
+            CHECK(c.offset == 300);
+
+            auto stats = allocator.get_stats();
+            CHECK(stats.allocation_count == 3);
+            CHECK(stats.free_space == 1024 - 600);
+            CHECK(stats.free_region_count == 1);
+
+            // Not enough space
+            CHECK(!allocator.allocate(1000).is_valid());
+            CHECK(!allocator.allocate(0).is_valid());
+
+            // A hole in the middle fragments the free space
+            allocator.free(b);
+            stats = allocator.get_stats();
+            CHECK(stats.free_region_count == 2);
+            CHECK(stats.largest_free_region == 424);
+            CHECK(stats.fragmentation() > 0.0f);
+
+            // The hole is reused
+            auto d = allocator.allocate(150);
+            CHECK(d.offset == 100);
+
+            // Freeing everything merges the neighbours back into a single range
+            allocator.free(a);
+            allocator.free(c);
+            allocator.free(d);
+            stats = allocator.get_stats();
+            CHECK(stats.allocation_count == 0);
+            CHECK(stats.free_region_count == 1);
+            CHECK(stats.largest_free_region == 1024);
+            CHECK(stats.fragmentation() == 0.0f);
+        }
+
+        TEST_CASE("Offset allocator alignment")
+        {
+            auto allocator = OffsetAllocator::create(4096);
+            auto a = allocator.allocate(3);
+            auto b = allocator.allocate(64, 256);
+            auto c = allocator.allocate(16, 16);
+            CHECK(a.offset == 0);
+            CHECK(b.offset == 256);
+            CHECK(c.offset % 16 == 0);
+            CHECK(c.offset >= b.offset + 64);
+            CHECK(allocator.allocation_size(b) >= 64);
+
+            allocator.reset();
+            CHECK(allocator.get_stats().free_space == 4096);
+            CHECK(allocator.allocate(4096).offset == 0);
+        }
+
+        TEST_CASE("Offset allocator random")
+        {
+            constexpr u32 size = 1 << 20;
+            std::mt19937 rng{3};
+            auto allocator = OffsetAllocator::create(size);
+
+            struct Live { OffsetAllocation allocation; u32 size; };
+            Vec<Live> live;
+            Vec<u8> owner(size, 0); // checks that allocations never overlap
+
+            for (u32 i = 0; i < 20000; i += 1)
+            {
+                if (!live.empty() && (rng() % 2 == 0 || live.size() > 500))
+                {
+                    usize i_live = rng() % live.size();
+                    auto entry   = live[i_live];
+                    for (u32 byte = 0; byte < entry.size; byte += 1) { owner[entry.allocation.offset + byte] = 0; }
+                    allocator.free(entry.allocation);
+                    live[i_live] = live.back();
+                    live.pop_back();
+                }
+                else
+                {
+                    u32 alloc_size = 1 + rng() % 8192;
+                    u32 alignment  = 1u << (rng() % 5);
+                    auto allocation = allocator.allocate(alloc_size, alignment);
+                    if (allocation.is_valid())
+                    {
+                        REQUIRE(allocation.offset % alignment == 0);
+                        REQUIRE(allocation.offset + alloc_size <= size);
+                        bool overlaps = false;
+                        for (u32 byte = 0; byte < alloc_size; byte += 1)
+                        {
+                            overlaps = overlaps || owner[allocation.offset + byte] != 0;
+                            owner[allocation.offset + byte] = 1;
+                        }
+                        REQUIRE(!overlaps);
+                        live.push_back({allocation, alloc_size});
+                    }
+                }
+
+                auto stats = allocator.get_stats();
+                REQUIRE(stats.allocation_count == live.size());
+                REQUIRE(stats.largest_free_region <= stats.free_space);
+            }
+
+            for (auto &entry : live) { allocator.free(entry.allocation); }
+            auto stats = allocator.get_stats();
+            CHECK(stats.free_space == size);
+            CHECK(stats.free_region_count == 1);
+        }
+    }
+}
+#endif
@@ -0,0 +1,66 @@
+#include "exo/collections/packed_pool.h"
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+
+namespace test
+{
+    TEST_CASE("Packed pool")
+    {
+        PackedPool<int> pool;
+        auto h1 = pool.add(1);
+        auto h2 = pool.add(2);
+        auto h3 = pool.add(3);
+        CHECK(pool.size() == 3);
+        CHECK(*pool.get(h1) == 1);
+        CHECK(*pool.get(h2) == 2);
+        CHECK(*pool.get(h3) == 3);
+
+        // Removing swaps the last value into the hole, other handles stay valid
+        pool.remove(h1);
+        CHECK(pool.size() == 2);
+        CHECK(*pool.get(h2) == 2);
+        CHECK(*pool.get(h3) == 3);
+
+        // The slot is reused with a new generation
+        auto h4 = pool.add(4);
+        CHECK(h4.value() == h1.value());
+        CHECK(h4 != h1);
+        CHECK(*pool.get(h4) == 4);
+
+        // Invalid handles return nullptr
+        CHECK(pool.get(Handle<int>::invalid()) == nullptr);
+
+        // Iteration only visits live values
+        int sum = 0;
+        u32 count = 0;
+        for (auto [handle, value] : pool)
+        {
+            CHECK(*pool.get(handle) == *value);
+            sum += *value;
+            count += 1;
+        }
+        CHECK(count == 3);
+        CHECK(sum == 2 + 3 + 4);
+    }
+
+    TEST_CASE("Packed pool remove while iterating")
+    {
+        PackedPool<int> pool;
+        for (int i = 0; i < 16; i += 1)
+        {
+            pool.add(i);
+        }
+
+        int sum = 0;
+        for (auto [handle, value] : pool)
+        {
+            sum += *value;
+            pool.remove(handle);
+        }
+        CHECK(sum == 15 * 16 / 2);
+        CHECK(pool.size() == 0);
+        CHECK(pool.begin() == pool.end());
+    }
+}
+#endif
@@ -3,6 +3,17 @@
 #if defined (ENABLE_DOCTEST)
 #include <doctest.h>
 
+namespace test
+{
+    struct Small;
+}
+
+template <> struct HandleTraits<test::Small>
+{
+    using raw_type                  = u32;
+    static constexpr u32 index_bits = 20;
+};
+
 namespace test
 {
     TEST_CASE("Handles")
@@ -26,7 +37,46 @@ namespace test
         h4 = h3;
         CHECK(h4.is_valid());
         CHECK(h4.hash() == h3.hash());
+
+        // A handle is a single integer
+        CHECK(sizeof(Handle<int>) == sizeof(u64));
+        CHECK(sizeof(Handle<Small>) == sizeof(u32));
+
+        auto h5 = Handle<Small>(42, 7);
+        CHECK(h5.value() == 42);
+        CHECK(h5.generation() == 7);
+
+        // The generation wraps around the bits that are not used by the index
+        CHECK(Handle<Small>::next_generation(42, Handle<Small>::gen_mask) == 0);
+        // and never produces the invalid handle
+        CHECK(Handle<Small>::next_generation(Handle<Small>::index_mask, Handle<Small>::gen_mask - 1) == 0);
     }
 
+    TEST_CASE("Pool")
+    {
+        Pool<u32> pool;
+        auto h1 = pool.add(1u);
+        auto h2 = pool.add(2u);
+        CHECK(pool.size() == 2);
+        CHECK(*pool.get(h1) == 1);
+        CHECK(*pool.get(h2) == 2);
+
+        pool.remove(h1);
+        CHECK(pool.size() == 1);
+
+        // The slot is reused with a new generation
+        auto h3 = pool.add(3u);
+        CHECK(h3.value() == h1.value());
+        CHECK(h3 != h1);
+        CHECK(*pool.get(h3) == 3);
+
+        u32 sum = 0;
+        for (auto [handle, value] : pool)
+        {
+            CHECK(*pool.get(handle) == *value);
+            sum += *value;
+        }
+        CHECK(sum == 2 + 3);
+    }
 }
 #endif
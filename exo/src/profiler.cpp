@@ -0,0 +1,290 @@
+#include "exo/profiler.h"
+
+#include "exo/collections/vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace profiler
+{
+struct Event
+{
+    const char *name;
+    u64 start_ns;
+    u64 end_ns;
+};
+
+// The exporter reads the slots while the owner thread overwrites them, the fields are relaxed atomics
+struct EventSlot
+{
+    std::atomic<const char *> name;
+    std::atomic<u64> start_ns;
+    std::atomic<u64> end_ns;
+};
+
+// Only the owner thread writes events, the exporter reads them concurrently
+struct ThreadBuffer
+{
+    u32 thread_id;
+    std::atomic<u64> head = 0;
+    EventSlot events[EVENTS_PER_THREAD];
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    // buffers are kept after their thread exits to export its scopes
+    Vec<std::unique_ptr<ThreadBuffer>> buffers;
+    // buffers of the exited threads, the next new thread takes one instead of allocating
+    Vec<ThreadBuffer *> free_buffers;
+    u32 next_thread_id = 0;
+};
+
+static Registry &get_registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+// Gives the buffer of the thread back to the registry when it exits
+struct BufferOwner
+{
+    ThreadBuffer *buffer = nullptr;
+
+    ~BufferOwner()
+    {
+        if (buffer)
+        {
+            auto &registry = get_registry();
+            std::lock_guard lock{registry.mutex};
+            registry.free_buffers.push_back(buffer);
+            buffer = nullptr;
+        }
+    }
+};
+
+static thread_local BufferOwner tls_buffer;
+
+static ThreadBuffer &get_thread_buffer()
+{
+    if (tls_buffer.buffer == nullptr)
+    {
+        auto &registry = get_registry();
+        std::lock_guard lock{registry.mutex};
+
+        ThreadBuffer *buffer = nullptr;
+        if (!registry.free_buffers.empty())
+        {
+            // the scopes of the exited thread are dropped, the exporter only reads under the lock
+            buffer = registry.free_buffers.back();
+            registry.free_buffers.pop_back();
+            buffer->head.store(0, std::memory_order_relaxed);
+        }
+        else
+        {
+            registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.buffers.back().get();
+        }
+
+        buffer->thread_id = registry.next_thread_id;
+        registry.next_thread_id += 1;
+        tls_buffer.buffer = buffer;
+    }
+    return *tls_buffer.buffer;
+}
+
+void record(const char *name, u64 start_ns, u64 end_ns)
+{
+    auto &buffer = get_thread_buffer();
+    u64 head     = buffer.head.load(std::memory_order_relaxed);
+
+    // Orders the previous head store before the slot stores: an exporter that reads one of them sees the slot as being written
+    std::atomic_thread_fence(std::memory_order_release);
+    auto &slot = buffer.events[head & (EVENTS_PER_THREAD - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+static void append_escaped(std::string &out, const char *str)
+{
+    for (; *str; str += 1)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            out += '\\';
+        }
+        out += *str;
+    }
+}
+
+std::string to_chrome_trace()
+{
+    auto &registry = get_registry();
+    std::lock_guard lock{registry.mutex};
+
+    // Timestamps are relative to the oldest scope to keep them small
+    u64 origin_ns = ~u64(0);
+    Vec<Event> events;
+    Vec<u32> thread_ids;
+
+    for (auto &buffer : registry.buffers)
+    {
+        u64 head  = buffer->head.load(std::memory_order_acquire);
+        u64 first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+
+        usize copy_start = events.size();
+        for (u64 i = first; i < head; i += 1)
+        {
+            const auto &slot = buffer->events[i & (EVENTS_PER_THREAD - 1)];
+            events.push_back({
+                .name     = slot.name.load(std::memory_order_relaxed),
+                .start_ns = slot.start_ns.load(std::memory_order_relaxed),
+                .end_ns   = slot.end_ns.load(std::memory_order_relaxed),
+            });
+            thread_ids.push_back(buffer->thread_id);
+        }
+
+        // The owner thread may have overwritten the oldest events while they were copied, drop them.
+        // The slot of `new_head` can be in the middle of a write, so it is discarded as well.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        u64 new_head = buffer->head.load(std::memory_order_relaxed);
+        u64 valid    = new_head + 1 > EVENTS_PER_THREAD ? new_head + 1 - EVENTS_PER_THREAD : 0;
+        if (valid > first)
+        {
+            usize overwritten = static_cast<usize>(std::min(valid - first, head - first));
+            events.erase(events.begin() + copy_start, events.begin() + copy_start + overwritten);
+            thread_ids.erase(thread_ids.begin() + copy_start, thread_ids.begin() + copy_start + overwritten);
+        }
+    }
+
+    for (const auto &event : events)
+    {
+        origin_ns = std::min(origin_ns, event.start_ns);
+    }
+
+    std::string json = "{\"traceEvents\":[\n";
+    char numbers[128];
+    for (usize i_event = 0; i_event < events.size(); i_event += 1)
+    {
+        const auto &event = events[i_event];
+        json += "{\"name\":\"";
+        append_escaped(json, event.name);
+        // Chrome trace timestamps are in microseconds
+        std::snprintf(numbers,
+                      sizeof(numbers),
+                      "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      thread_ids[i_event],
+                      double(event.start_ns - origin_ns) / 1000.0,
+                      double(event.end_ns - event.start_ns) / 1000.0);
+        json += numbers;
+        json += i_event + 1 < events.size() ? ",\n" : "\n";
+    }
+    json += "]}\n";
+    return json;
+}
+
+bool write_chrome_trace(const char *path)
+{
+    std::string json = to_chrome_trace();
+
+    FILE *file = std::fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    bool success = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    std::fclose(file);
+    return success;
+}
+
+void clear()
+{
+    auto &registry = get_registry();
+    std::lock_guard lock{registry.mutex};
+    for (auto &buffer : registry.buffers)
+    {
+        buffer->head.store(0, std::memory_order_release);
+    }
+}
+} // namespace profiler
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <thread>
+
+namespace test
+{
+    static usize count_occurrences(const std::string &str, const char *pattern)
+    {
+        usize count = 0;
+        for (usize pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+        {
+            count += 1;
+        }
+        return count;
+    }
+
+    TEST_CASE("Profiler")
+    {
+        profiler::clear();
+
+        {
+            profiler::Scope outer{"outer"};
+            {
+                profiler::Scope inner{"inner \"quoted\""};
+            }
+        }
+
+        std::thread thread{[]() {
+            for (u32 i = 0; i < 10; i += 1)
+            {
+                profiler::Scope scope{"thread"};
+            }
+        }};
+        thread.join();
+
+        auto json = profiler::to_chrome_trace();
+        CHECK(count_occurrences(json, "\"ph\":\"X\"") == 12);
+        CHECK(count_occurrences(json, "\"name\":\"thread\"") == 10);
+        CHECK(json.find("inner \\\"quoted\\\"") != std::string::npos);
+
+        // The ring buffer keeps the most recent scopes, except the oldest one whose slot is the next to be written
+        profiler::clear();
+        for (u32 i = 0; i < profiler::EVENTS_PER_THREAD + 10; i += 1)
+        {
+            profiler::Scope scope{i < 10 ? "old" : "new"};
+        }
+        json = profiler::to_chrome_trace();
+        CHECK(count_occurrences(json, "\"name\":\"old\"") == 0);
+        CHECK(count_occurrences(json, "\"name\":\"new\"") == profiler::EVENTS_PER_THREAD - 1);
+    }
+
+    TEST_CASE("Profiler reuses the buffers of exited threads")
+    {
+        profiler::clear();
+
+        const auto record_scopes = [](const char *name) {
+            std::thread thread{[name]() {
+                for (u32 i = 0; i < 5; i += 1)
+                {
+                    profiler::Scope scope{name};
+                }
+            }};
+            thread.join();
+        };
+
+        // the second thread takes the buffer of the first one, its scopes are dropped
+        record_scopes("first");
+        record_scopes("second");
+
+        auto json = profiler::to_chrome_trace();
+        CHECK(count_occurrences(json, "\"name\":\"first\"") == 0);
+        CHECK(count_occurrences(json, "\"name\":\"second\"") == 5);
+    }
+}
+#endif
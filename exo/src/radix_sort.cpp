@@ -0,0 +1,488 @@
+#include "exo/radix_sort.h"
+
+#include "exo/collections/vector.h"
+#include "exo/jobs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+inline constexpr u32 RADIX_BITS                 = 8;
+inline constexpr u32 RADIX_SIZE                 = 1u << RADIX_BITS;
+inline constexpr usize PARALLEL_THRESHOLD       = 64 * 1024;
+// number of elements that stay in the L2 cache during the LSD passes
+inline constexpr usize CACHE_SORT_THRESHOLD     = 16 * 1024;
+inline constexpr usize INSERTION_SORT_THRESHOLD = 32;
+inline constexpr u32 MAX_BLOCKS                 = 64;
+
+template <typename Key> static u32 get_digit(Key key, u32 shift)
+{
+    return static_cast<u32>(key >> shift) & (RADIX_SIZE - 1);
+}
+
+static bool use_jobs(usize count)
+{
+    return count >= PARALLEL_THRESHOLD && jobs::is_initialized() && jobs::thread_count() > 1;
+}
+
+/// --- LSD
+
+template <typename Key> struct Histograms
+{
+    u32 counts[sizeof(Key)][RADIX_SIZE];
+};
+
+// Counts the digits of the passes [0, pass_count) in a single read
+template <typename Key> static void count_digits(const Key *keys, usize count, u32 pass_count, Histograms<Key> &histograms)
+{
+    std::memset(&histograms, 0, sizeof(histograms));
+    for (usize i = 0; i < count; i += 1)
+    {
+        Key key = keys[i];
+        for (u32 i_pass = 0; i_pass < pass_count; i_pass += 1)
+        {
+            histograms.counts[i_pass][get_digit(key, i_pass * RADIX_BITS)] += 1;
+        }
+    }
+}
+
+// The passes above the highest digit that varies wouldn't move anything
+template <typename Key> static u32 needed_pass_count(Key any_key, usize count, const Histograms<Key> &histograms)
+{
+    u32 pass_count = sizeof(Key);
+    while (pass_count > 0 && histograms.counts[pass_count - 1][get_digit(any_key, (pass_count - 1) * RADIX_BITS)] == count)
+    {
+        pass_count -= 1;
+    }
+    return pass_count;
+}
+
+static void exclusive_prefix_sum(const u32 *histogram, u32 *offsets)
+{
+    u32 offset = 0;
+    for (u32 i_digit = 0; i_digit < RADIX_SIZE; i_digit += 1)
+    {
+        offsets[i_digit] = offset;
+        offset += histogram[i_digit];
+    }
+}
+
+// Moves the elements to the next index of their digit, `offsets` are incremented
+template <typename Key>
+static void scatter(const Key *src_keys, const u32 *src_values, Key *dst_keys, u32 *dst_values, usize count, u32 shift, u32 *offsets)
+{
+    for (usize i = 0; i < count; i += 1)
+    {
+        u32 i_dst         = offsets[get_digit(src_keys[i], shift)]++;
+        dst_keys[i_dst]   = src_keys[i];
+        dst_values[i_dst] = src_values[i];
+    }
+}
+
+// Runs the passes [0, pass_count) and skips the ones where every key has the same digit.
+// Returns true when the result ends in the `other` buffers.
+template <typename Key>
+static bool lsd_passes(Key *keys, u32 *values, Key *other_keys, u32 *other_values, usize count, u32 pass_count, const Histograms<Key> &histograms)
+{
+    bool in_other = false;
+    for (u32 i_pass = 0; i_pass < pass_count; i_pass += 1)
+    {
+        const u32 shift = i_pass * RADIX_BITS;
+        if (histograms.counts[i_pass][get_digit(keys[0], shift)] == count)
+        {
+            continue;
+        }
+
+        u32 offsets[RADIX_SIZE];
+        exclusive_prefix_sum(histograms.counts[i_pass], offsets);
+        scatter(keys, values, other_keys, other_values, count, shift, offsets);
+
+        std::swap(keys, other_keys);
+        std::swap(values, other_values);
+        in_other = !in_other;
+    }
+    return in_other;
+}
+
+// Sorts a bucket that is in the scratch buffers with its lower digits, the result goes in keys/values
+template <typename Key> static void sort_bucket(Key *keys, u32 *values, Key *keys_scratch, u32 *values_scratch, usize count, u32 pass_count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    Histograms<Key> histograms;
+    count_digits(keys_scratch, count, pass_count, histograms);
+    if (!lsd_passes(keys_scratch, values_scratch, keys, values, count, pass_count, histograms))
+    {
+        std::memcpy(keys, keys_scratch, count * sizeof(Key));
+        std::memcpy(values, values_scratch, count * sizeof(u32));
+    }
+}
+
+// Every LSD pass over a large input misses the cache on each of the 256 destinations. Large inputs are first split
+// by their highest digit (a stable MSD pass), then each bucket is small enough to run the other passes in cache.
+template <typename Key> static void lsd_sort_serial(Key *keys, u32 *values, Key *keys_scratch, u32 *values_scratch, usize count)
+{
+    Histograms<Key> histograms;
+    count_digits(keys, count, sizeof(Key), histograms);
+    const u32 pass_count = needed_pass_count(keys[0], count, histograms);
+    if (pass_count == 0)
+    {
+        return;
+    }
+
+    if (count <= CACHE_SORT_THRESHOLD || pass_count == 1)
+    {
+        if (lsd_passes(keys, values, keys_scratch, values_scratch, count, pass_count, histograms))
+        {
+            std::memcpy(keys, keys_scratch, count * sizeof(Key));
+            std::memcpy(values, values_scratch, count * sizeof(u32));
+        }
+        return;
+    }
+
+    const u32 top_pass = pass_count - 1;
+    u32 starts[RADIX_SIZE];
+    u32 offsets[RADIX_SIZE];
+    exclusive_prefix_sum(histograms.counts[top_pass], starts);
+    std::memcpy(offsets, starts, sizeof(starts));
+    scatter(keys, values, keys_scratch, values_scratch, count, top_pass * RADIX_BITS, offsets);
+
+    for (u32 i_bucket = 0; i_bucket < RADIX_SIZE; i_bucket += 1)
+    {
+        u32 start = starts[i_bucket];
+        sort_bucket(keys + start, values + start, keys_scratch + start, values_scratch + start, histograms.counts[top_pass][i_bucket], top_pass);
+    }
+}
+
+// Same as the serial version, the input is split in one block per thread to count the digits and to scatter the
+// first pass: the offsets of a digit in a block start after the same digit in the previous blocks, so the sort
+// stays stable. The buckets are then sorted in parallel.
+template <typename Key> static void lsd_sort_parallel(Key *keys, u32 *values, Key *keys_scratch, u32 *values_scratch, usize count)
+{
+    const u32 block_count  = std::min(jobs::thread_count(), MAX_BLOCKS);
+    const usize block_size = (count + block_count - 1) / block_count;
+    auto block_range       = [&](usize i_block) { return std::make_pair(i_block * block_size, std::min(count, (i_block + 1) * block_size)); };
+
+    Vec<Histograms<Key>> block_histograms(block_count);
+    jobs::parallel_for(block_count, 1, [&](usize i_block) {
+        auto [begin, end] = block_range(i_block);
+        count_digits(keys + begin, end - begin, sizeof(Key), block_histograms[i_block]);
+    });
+
+    Histograms<Key> histograms = {};
+    for (const auto &block_histogram : block_histograms)
+    {
+        for (u32 i_pass = 0; i_pass < sizeof(Key); i_pass += 1)
+        {
+            for (u32 i_digit = 0; i_digit < RADIX_SIZE; i_digit += 1)
+            {
+                histograms.counts[i_pass][i_digit] += block_histogram.counts[i_pass][i_digit];
+            }
+        }
+    }
+
+    const u32 pass_count = needed_pass_count(keys[0], count, histograms);
+    if (pass_count == 0)
+    {
+        return;
+    }
+
+    const u32 top_pass = pass_count - 1;
+    u32 starts[RADIX_SIZE];
+    exclusive_prefix_sum(histograms.counts[top_pass], starts);
+
+    Vec<u32> block_offsets(usize(block_count) * RADIX_SIZE);
+    for (u32 i_digit = 0; i_digit < RADIX_SIZE; i_digit += 1)
+    {
+        u32 offset = starts[i_digit];
+        for (u32 i_block = 0; i_block < block_count; i_block += 1)
+        {
+            block_offsets[i_block * RADIX_SIZE + i_digit] = offset;
+            offset += block_histograms[i_block].counts[top_pass][i_digit];
+        }
+    }
+
+    jobs::parallel_for(block_count, 1, [&](usize i_block) {
+        auto [begin, end] = block_range(i_block);
+        scatter(keys + begin, values + begin, keys_scratch, values_scratch, end - begin, top_pass * RADIX_BITS, &block_offsets[i_block * RADIX_SIZE]);
+    });
+
+    jobs::parallel_for(RADIX_SIZE, 1, [&](usize i_bucket) {
+        u32 start = starts[i_bucket];
+        sort_bucket(keys + start, values + start, keys_scratch + start, values_scratch + start, histograms.counts[top_pass][i_bucket], top_pass);
+    });
+}
+
+template <typename Key> static void lsd_sort(std::span<Key> keys, std::span<u32> values, std::span<Key> keys_scratch, std::span<u32> values_scratch)
+{
+    const usize count = keys.size();
+    assert(values.size() == count);
+    assert(keys_scratch.size() >= count && values_scratch.size() >= count);
+    assert(count <= u32_invalid);
+
+    if (count <= 1)
+    {
+        return;
+    }
+
+    if (use_jobs(count))
+    {
+        lsd_sort_parallel(keys.data(), values.data(), keys_scratch.data(), values_scratch.data(), count);
+    }
+    else
+    {
+        lsd_sort_serial(keys.data(), values.data(), keys_scratch.data(), values_scratch.data(), count);
+    }
+}
+
+/// --- MSD in place
+
+template <typename Key> static void insertion_sort(Key *keys, u32 *values, usize count)
+{
+    for (usize i = 1; i < count; i += 1)
+    {
+        Key key   = keys[i];
+        u32 value = values[i];
+        usize j   = i;
+        for (; j > 0 && keys[j - 1] > key; j -= 1)
+        {
+            keys[j]   = keys[j - 1];
+            values[j] = values[j - 1];
+        }
+        keys[j]   = key;
+        values[j] = value;
+    }
+}
+
+template <typename Key> static void msd_sort(Key *keys, u32 *values, usize count, u32 shift, bool parallel)
+{
+    u32 histogram[RADIX_SIZE];
+    while (true)
+    {
+        if (count <= INSERTION_SORT_THRESHOLD)
+        {
+            insertion_sort(keys, values, count);
+            return;
+        }
+
+        std::memset(histogram, 0, sizeof(histogram));
+        for (usize i = 0; i < count; i += 1)
+        {
+            histogram[get_digit(keys[i], shift)] += 1;
+        }
+
+        // every key is in the same bucket, look at the next digit without moving anything
+        if (histogram[get_digit(keys[0], shift)] != count)
+        {
+            break;
+        }
+        if (shift == 0)
+        {
+            return;
+        }
+        shift -= RADIX_BITS;
+    }
+
+    usize starts[RADIX_SIZE];
+    usize heads[RADIX_SIZE];
+    usize tails[RADIX_SIZE];
+    usize offset = 0;
+    for (u32 i_digit = 0; i_digit < RADIX_SIZE; i_digit += 1)
+    {
+        starts[i_digit] = offset;
+        heads[i_digit]  = offset;
+        offset += histogram[i_digit];
+        tails[i_digit] = offset;
+    }
+
+    // Take the first misplaced element of a bucket and swap it into its own bucket until an element of the first
+    // bucket comes back
+    for (u32 i_bucket = 0; i_bucket < RADIX_SIZE; i_bucket += 1)
+    {
+        while (heads[i_bucket] < tails[i_bucket])
+        {
+            Key key   = keys[heads[i_bucket]];
+            u32 value = values[heads[i_bucket]];
+            for (u32 digit = get_digit(key, shift); digit != i_bucket; digit = get_digit(key, shift))
+            {
+                usize i_dst = heads[digit]++;
+                std::swap(key, keys[i_dst]);
+                std::swap(value, values[i_dst]);
+            }
+            keys[heads[i_bucket]]   = key;
+            values[heads[i_bucket]] = value;
+            heads[i_bucket] += 1;
+        }
+    }
+
+    if (shift == 0)
+    {
+        return;
+    }
+
+    auto sort_bucket = [&](usize i_bucket) {
+        if (histogram[i_bucket] > 1)
+        {
+            msd_sort(keys + starts[i_bucket], values + starts[i_bucket], histogram[i_bucket], shift - RADIX_BITS, false);
+        }
+    };
+
+    // the buckets are independent
+    if (parallel)
+    {
+        jobs::parallel_for(RADIX_SIZE, 1, sort_bucket);
+    }
+    else
+    {
+        for (u32 i_bucket = 0; i_bucket < RADIX_SIZE; i_bucket += 1)
+        {
+            sort_bucket(i_bucket);
+        }
+    }
+}
+
+template <typename Key> static void msd_sort(std::span<Key> keys, std::span<u32> values)
+{
+    assert(values.size() == keys.size());
+    assert(keys.size() <= u32_invalid);
+    msd_sort(keys.data(), values.data(), keys.size(), (sizeof(Key) - 1) * RADIX_BITS, use_jobs(keys.size()));
+}
+
+/// --- Public API
+
+void radix_sort(std::span<u32> keys, std::span<u32> values, std::span<u32> keys_scratch, std::span<u32> values_scratch)
+{
+    lsd_sort(keys, values, keys_scratch, values_scratch);
+}
+
+void radix_sort(std::span<u64> keys, std::span<u32> values, std::span<u64> keys_scratch, std::span<u32> values_scratch)
+{
+    lsd_sort(keys, values, keys_scratch, values_scratch);
+}
+
+void radix_sort_in_place(std::span<u32> keys, std::span<u32> values)
+{
+    msd_sort(keys, values);
+}
+
+void radix_sort_in_place(std::span<u64> keys, std::span<u32> values)
+{
+    msd_sort(keys, values);
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include "exo/sort_key.h"
+
+namespace test
+{
+    template <typename Key> static Vec<Key> random_keys(usize count, u64 mask)
+    {
+        Vec<Key> keys(count);
+        u64 state = 0x9E3779B97F4A7C15;
+        for (auto &key : keys)
+        {
+            // splitmix64
+            state += 0x9E3779B97F4A7C15;
+            u64 z = state;
+            z     = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z     = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            key   = static_cast<Key>((z ^ (z >> 31)) & mask);
+        }
+        return keys;
+    }
+
+    template <typename Key> static void check_sort(usize count, u64 mask, bool in_place)
+    {
+        auto keys = random_keys<Key>(count, mask);
+        Vec<u32> values(count);
+        for (u32 i = 0; i < count; i += 1)
+        {
+            values[i] = i;
+        }
+
+        Vec<std::pair<Key, u32>> expected(count);
+        for (u32 i = 0; i < count; i += 1)
+        {
+            expected[i] = {keys[i], i};
+        }
+        std::stable_sort(expected.begin(), expected.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        auto original = keys;
+        if (in_place)
+        {
+            radix_sort_in_place(keys, values);
+        }
+        else
+        {
+            Vec<Key> keys_scratch(count);
+            Vec<u32> values_scratch(count);
+            radix_sort(keys, values, keys_scratch, values_scratch);
+        }
+
+        bool keys_sorted   = true;
+        bool values_match  = true;
+        bool values_stable = true;
+        for (u32 i = 0; i < count; i += 1)
+        {
+            keys_sorted   = keys_sorted && keys[i] == expected[i].first;
+            values_match  = values_match && original[values[i]] == keys[i];
+            values_stable = values_stable && values[i] == expected[i].second;
+        }
+        CHECK(keys_sorted);
+        CHECK(values_match);
+        if (!in_place)
+        {
+            CHECK(values_stable);
+        }
+    }
+
+    TEST_SUITE("Sort")
+    {
+        TEST_CASE("Radix sort")
+        {
+            for (bool in_place : {false, true})
+            {
+                check_sort<u32>(0, ~0ull, in_place);
+                check_sort<u32>(1, ~0ull, in_place);
+                check_sort<u32>(17, ~0ull, in_place);
+                check_sort<u32>(10'000, ~0ull, in_place);
+                check_sort<u64>(10'000, ~0ull, in_place);
+                // small keys skip the high passes, duplicates check the stability
+                check_sort<u32>(10'000, 0xFF, in_place);
+                check_sort<u64>(10'000, 0xFFFF'0000'0F00, in_place);
+                check_sort<u64>(200'000, ~0ull, in_place);
+            }
+        }
+
+        TEST_CASE("Radix sort with jobs")
+        {
+            jobs::init(3);
+            check_sort<u32>(200'000, ~0ull, false);
+            check_sort<u64>(200'000, 0xFFFF'FFFF'FF00'FFFF, false);
+            check_sort<u64>(200'000, ~0ull, true);
+            jobs::shutdown();
+        }
+
+        TEST_CASE("Draw sort keys")
+        {
+            // state first, then front to back
+            u64 near_a = sort_key::draw({.pipeline = 0, .material = 1, .mesh = 2, .depth = 1.0f});
+            u64 far_a  = sort_key::draw({.pipeline = 0, .material = 1, .mesh = 2, .depth = 100.0f});
+            u64 near_b = sort_key::draw({.pipeline = 0, .material = 1, .mesh = 3, .depth = 0.5f});
+            u64 other  = sort_key::draw({.pipeline = 1, .material = 0, .mesh = 0, .depth = 0.0f});
+            CHECK(near_a < far_a);
+            CHECK(far_a < near_b);
+            CHECK(near_b < other);
+
+            // back to front for blended draws, negative depths are clamped to the camera plane
+            CHECK(sort_key::draw({.depth = 100.0f, .back_to_front = true}) < sort_key::draw({.depth = 1.0f, .back_to_front = true}));
+            CHECK(sort_key::draw({.depth = -1.0f}) == sort_key::draw({.depth = 0.0f}));
+        }
+    }
+}
+#endif
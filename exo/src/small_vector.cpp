@@ -0,0 +1,107 @@
+#include "exo/collections/small_vector.h"
+#include "exo/collections/array_vector.h"
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <string>
+
+namespace test
+{
+    TEST_SUITE("Vectors")
+    {
+        TEST_CASE("SmallVec")
+        {
+            SmallVec<u32, 4> values = {1, 2, 3};
+            CHECK(values.size() == 3);
+            CHECK(values.is_inline());
+
+            values.push_back(4);
+            CHECK(values.is_inline());
+
+            // Growing past N moves the elements to the heap
+            values.push_back(5);
+            CHECK(!values.is_inline());
+            CHECK(values.capacity() >= 5);
+            for (u32 i = 0; i < 5; i += 1)
+            {
+                CHECK(values[i] == i + 1);
+            }
+
+            // Moving a heap vector steals its storage
+            const u32 *heap_data = values.data();
+            SmallVec<u32, 4> moved = std::move(values);
+            CHECK(moved.data() == heap_data);
+            CHECK(values.empty());
+            CHECK(values.is_inline());
+
+            SmallVec<u32, 4> copy = moved;
+            CHECK(copy == moved);
+            copy.pop_back();
+            CHECK(copy != moved);
+
+            copy.resize(1);
+            CHECK(copy.size() == 1);
+            CHECK(copy.back() == 1);
+
+            // std::vector only moves its elements when growing if their move constructor is noexcept
+            static_assert(std::is_nothrow_move_constructible_v<SmallVec<u32, 4>>);
+            static_assert(std::is_nothrow_move_constructible_v<ArrayVec<u32, 4>>);
+        }
+
+        TEST_CASE("SmallVec with non-trivial elements")
+        {
+            SmallVec<std::string, 2> strings;
+            strings.push_back("a fairly long string that does not fit in the small string buffer");
+            strings.push_back("b");
+            strings.emplace_back("c");
+            CHECK(strings.size() == 3);
+            CHECK(strings[0].size() > 16);
+            CHECK(strings[2] == "c");
+
+            // the new element is built from an element of the full vector
+            strings.push_back(strings[0]);
+            strings.emplace_back(strings[1]);
+            CHECK(strings.size() == 5);
+            CHECK(strings[3] == strings[0]);
+            CHECK(strings[4] == "b");
+
+            SmallVec<std::string, 2> grown = {"e", "f"};
+            grown.resize(4, grown[0]);
+            CHECK(grown[3] == "e");
+
+            SmallVec<std::string, 2> inline_strings = {"d"};
+            SmallVec<std::string, 2> moved = std::move(inline_strings);
+            CHECK(moved[0] == "d");
+            CHECK(inline_strings.empty());
+        }
+
+        TEST_CASE("ArrayVec")
+        {
+            ArrayVec<u32, 4> values = {1, 2};
+            CHECK(values.size() == 2);
+            CHECK(values.capacity() == 4);
+
+            values.push_back(3);
+            values.push_back(4);
+            CHECK(values.size() == 4);
+            CHECK(values.back() == 4);
+
+            ArrayVec<u32, 4> copy = values;
+            CHECK(copy == values);
+            copy.clear();
+            CHECK(copy.empty());
+
+            copy = std::move(values);
+            CHECK(copy.size() == 4);
+            CHECK(values.empty());
+
+            u32 sum = 0;
+            for (u32 value : copy)
+            {
+                sum += value;
+            }
+            CHECK(sum == 10);
+        }
+    }
+}
+#endif
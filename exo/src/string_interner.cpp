@@ -0,0 +1,198 @@
+#include "exo/string_interner.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+StringInterner::~StringInterner()
+{
+    for (char *chunk : chunks)
+    {
+        std::free(chunk);
+    }
+    for (auto &page : pages)
+    {
+        delete[] page.load(std::memory_order_relaxed);
+    }
+}
+
+StringInterner &StringInterner::global()
+{
+    static StringInterner interner;
+    return interner;
+}
+
+const char *StringInterner::store(std::string_view str)
+{
+    usize size = str.size() + 1;
+
+    char *dst = nullptr;
+    if (size > CHUNK_SIZE / 4)
+    {
+        // big strings get their own allocation to not waste the end of the current chunk, which stays current
+        dst = static_cast<char *>(std::malloc(size));
+        chunks.push_back(dst);
+    }
+    else
+    {
+        if (chunk_offset + size > CHUNK_SIZE)
+        {
+            current_chunk = static_cast<char *>(std::malloc(CHUNK_SIZE));
+            chunks.push_back(current_chunk);
+            chunk_offset = 0;
+        }
+        dst = current_chunk + chunk_offset;
+        chunk_offset += size;
+    }
+
+    std::memcpy(dst, str.data(), str.size());
+    dst[str.size()] = '\0';
+    return dst;
+}
+
+u32 StringInterner::intern(std::string_view str)
+{
+    std::lock_guard lock{mutex};
+
+    if (auto it = lookup.find(str); it != lookup.end())
+    {
+        return it->second;
+    }
+
+    u32 id = count.load(std::memory_order_relaxed);
+    assert(id < MAX_PAGES * ENTRIES_PER_PAGE);
+
+    u32 i_page  = id / ENTRIES_PER_PAGE;
+    Entry *page = pages[i_page].load(std::memory_order_relaxed);
+    if (page == nullptr)
+    {
+        page = new Entry[ENTRIES_PER_PAGE];
+        pages[i_page].store(page, std::memory_order_release);
+    }
+
+    const char *stored          = store(str);
+    page[id % ENTRIES_PER_PAGE] = {stored, static_cast<u32>(str.size())};
+    lookup[std::string_view{stored, str.size()}] = id;
+
+    // publish the entry for the lock-free readers
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+u32 StringInterner::find(std::string_view str) const
+{
+    std::lock_guard lock{mutex};
+    auto it = lookup.find(str);
+    return it != lookup.end() ? it->second : u32_invalid;
+}
+
+std::string_view StringInterner::view(u32 id) const
+{
+    assert(id < size());
+    const Entry &entry = pages[id / ENTRIES_PER_PAGE].load(std::memory_order_acquire)[id % ENTRIES_PER_PAGE];
+    return {entry.str, entry.length};
+}
+
+const char *StringInterner::c_str(u32 id) const
+{
+    assert(id < size());
+    return pages[id / ENTRIES_PER_PAGE].load(std::memory_order_acquire)[id % ENTRIES_PER_PAGE].str;
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+#include <algorithm>
+#include <thread>
+
+namespace test
+{
+    TEST_CASE("String interner")
+    {
+        StringInterner interner;
+        u32 a = interner.intern("a");
+        u32 b = interner.intern(std::string("b"));
+        CHECK(a != b);
+        CHECK(interner.intern("a") == a);
+        CHECK(interner.size() == 2);
+        CHECK(interner.view(a) == "a");
+        CHECK(std::strcmp(interner.c_str(b), "b") == 0);
+        CHECK(interner.find("c") == u32_invalid);
+
+        // Views stay valid while the interner grows over several chunks and pages
+        std::string_view first = interner.view(a);
+        for (u32 i = 0; i < 3 * StringInterner::ENTRIES_PER_PAGE; i += 1)
+        {
+            interner.intern("string #" + std::to_string(i));
+        }
+        CHECK(first.data() == interner.view(a).data());
+        CHECK(interner.view(interner.find("string #5000")) == "string #5000");
+
+        // Big strings
+        std::string big(StringInterner::CHUNK_SIZE, 'x');
+        u32 big_id = interner.intern(big);
+        CHECK(interner.view(big_id) == big);
+        CHECK(interner.intern(big) == big_id);
+
+        // Small strings after a big one still go to the current chunk
+        u32 hello = interner.intern("hello");
+        CHECK(interner.view(hello) == "hello");
+        CHECK(interner.view(big_id) == big);
+        CHECK(interner.view(interner.find("string #5000")) == "string #5000");
+
+        CHECK(interner.intern("") == interner.intern(""));
+        CHECK(interner.view(interner.intern("")).empty());
+    }
+
+    TEST_CASE("StringId")
+    {
+        StringId id = "test string id";
+        StringId same{std::string("test string id")};
+        CHECK(id == same);
+        CHECK(id.view() == "test string id");
+        CHECK(StringId::find("test string id") == id);
+        CHECK(!StringId::find("never interned string").is_valid());
+
+        StringId invalid;
+        CHECK(invalid.view().empty());
+        CHECK(std::strcmp(invalid.c_str(), "") == 0);
+    }
+
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("String interner threads")
+        {
+            StringInterner interner;
+            constexpr u32 thread_count = 4;
+            constexpr u32 string_count = 2'000;
+
+            Vec<Vec<u32>> ids(thread_count, Vec<u32>(string_count));
+            Vec<std::thread> threads;
+            for (u32 i_thread = 0; i_thread < thread_count; i_thread += 1)
+            {
+                threads.emplace_back([&, i_thread]() {
+                    for (u32 i = 0; i < string_count; i += 1)
+                    {
+                        ids[i_thread][i] = interner.intern(std::to_string(i));
+                        // readers don't take the lock
+                        if (interner.view(ids[i_thread][i]) != std::to_string(i))
+                        {
+                            ids[i_thread][i] = u32_invalid;
+                        }
+                    }
+                });
+            }
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+
+            CHECK(interner.size() == string_count);
+            for (u32 i_thread = 1; i_thread < thread_count; i_thread += 1)
+            {
+                CHECK(ids[i_thread] == ids[0]);
+            }
+            CHECK(std::find(ids[0].begin(), ids[0].end(), u32_invalid) == ids[0].end());
+        }
+    }
+}
+#endif
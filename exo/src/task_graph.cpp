@@ -0,0 +1,188 @@
+#include "exo/task_graph.h"
+
+#include <cassert>
+#include <cstdio>
+#include <thread>
+
+TaskId TaskGraph::add_task(std::string name, std::function<void()> function, bool main_thread)
+{
+    Task task        = {};
+    task.name        = std::move(name);
+    task.function    = std::move(function);
+    task.main_thread = main_thread;
+    tasks.push_back(std::move(task));
+    return static_cast<TaskId>(tasks.size() - 1);
+}
+
+void TaskGraph::add_dependency(TaskId before, TaskId after)
+{
+    assert(before < after && after < tasks.size());
+    tasks[before].successors.push_back(after);
+    tasks[after].dependency_count += 1;
+}
+
+void TaskGraph::schedule(TaskId id)
+{
+    if (tasks[id].main_thread)
+    {
+        std::lock_guard lock{main_thread_mutex};
+        main_thread_ready.push_back(id);
+        return;
+    }
+
+    jobs::spawn(counter, [this, id]() { run_task(id); });
+}
+
+void TaskGraph::run_task(TaskId id)
+{
+    auto &task = tasks[id];
+
+    auto task_start = Clock::now();
+    task.function();
+    auto task_end = Clock::now();
+
+    task.timing.start_ms     = elapsed_ms<double>(start_time, task_start);
+    task.timing.duration_ms  = elapsed_ms<double>(task_start, task_end);
+    task.timing.thread_index = jobs::thread_index();
+
+    for (TaskId successor : task.successors)
+    {
+        if (std::atomic_ref<u32>{tasks[successor].remaining}.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            schedule(successor);
+        }
+    }
+
+    tasks_left.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskGraph::execute()
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    start_time = Clock::now();
+    tasks_left.store(static_cast<u32>(tasks.size()), std::memory_order_relaxed);
+    for (auto &task : tasks)
+    {
+        task.remaining = task.dependency_count;
+    }
+
+    for (TaskId id = 0; id < tasks.size(); id += 1)
+    {
+        if (tasks[id].dependency_count == 0)
+        {
+            schedule(id);
+        }
+    }
+
+    // Run the main thread tasks when they are ready, and help the workers otherwise
+    while (tasks_left.load(std::memory_order_acquire) != 0)
+    {
+        TaskId id = u32_invalid;
+        {
+            std::lock_guard lock{main_thread_mutex};
+            if (!main_thread_ready.empty())
+            {
+                id = main_thread_ready.back();
+                main_thread_ready.pop_back();
+            }
+        }
+
+        if (id != u32_invalid)
+        {
+            run_task(id);
+        }
+        else if (!jobs::try_run_one())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last jobs may still be decrementing the counter
+    jobs::wait(counter);
+}
+
+std::string TaskGraph::to_dot() const
+{
+    std::string dot = "digraph TaskGraph {\n    node [shape=box];\n";
+    for (TaskId id = 0; id < tasks.size(); id += 1)
+    {
+        const auto &task = tasks[id];
+
+        char label[256];
+        std::snprintf(label,
+                      sizeof(label),
+                      "    t%u [label=\"%s\\nstart %.3f ms\\nduration %.3f ms\\nthread %d\"%s];\n",
+                      id,
+                      task.name.c_str(),
+                      task.timing.start_ms,
+                      task.timing.duration_ms,
+                      task.timing.thread_index == u32_invalid ? -1 : int(task.timing.thread_index),
+                      task.main_thread ? ", style=bold" : "");
+        dot += label;
+
+        for (TaskId successor : task.successors)
+        {
+            dot += "    t" + std::to_string(id) + " -> t" + std::to_string(successor) + ";\n";
+        }
+    }
+    dot += "}\n";
+    return dot;
+}
+
+#if defined (ENABLE_DOCTEST)
+#include <doctest.h>
+
+namespace test
+{
+    TEST_SUITE("Concurrent")
+    {
+        TEST_CASE("Task graph")
+        {
+            for (u32 worker_count : {0u, 3u})
+            {
+                if (worker_count)
+                {
+                    jobs::init(worker_count);
+                }
+
+                // a -> (b, c) -> d, with c on the main thread
+                std::atomic<u32> order = 0;
+                u32 a = 0, b = 0, c = 0, d = 0;
+                u32 c_thread = u32_invalid;
+
+                TaskGraph graph;
+                auto ta = graph.add_task("a", [&]() { a = order.fetch_add(1) + 1; });
+                auto tb = graph.add_task("b", [&]() { b = order.fetch_add(1) + 1; });
+                auto tc = graph.add_task("c", [&]() { c = order.fetch_add(1) + 1; c_thread = jobs::thread_index(); }, true);
+                auto td = graph.add_task("d", [&]() { d = order.fetch_add(1) + 1; });
+                graph.add_dependency(ta, tb);
+                graph.add_dependency(ta, tc);
+                graph.add_dependency(tb, td);
+                graph.add_dependency(tc, td);
+
+                // The graph is built once and executed several times
+                for (u32 i_frame = 0; i_frame < 100; i_frame += 1)
+                {
+                    order = 0;
+                    graph.execute();
+                    CHECK(a == 1);
+                    CHECK(b > a);
+                    CHECK(c > a);
+                    CHECK(d == 4);
+                    CHECK(c_thread == jobs::thread_index());
+                }
+
+                auto dot = graph.to_dot();
+                CHECK(dot.find("t0 -> t1") != std::string::npos);
+                CHECK(dot.find("t2 -> t3") != std::string::npos);
+
+                jobs::shutdown();
+            }
+        }
+    }
+}
+#endif
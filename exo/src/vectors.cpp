@@ -4,39 +4,11 @@
 #include <cstring>
 #if defined(ENABLE_DOCTEST)
 #include <doctest.h>
+#include "exo/collections/vector.h"
+#include <random>
 #endif
 #include <iostream>
 
-float dot(const float2 &a, const float2 &b)
-{
-    return a.x*b.x + a.y*b.y;
-}
-
-float dot(const float3 &a, const float3 &b)
-{
-    return a.x*b.x + a.y*b.y + a.z*b.z;
-}
-
-float dot(const float4 &a, const float4 &b)
-{
-    return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
-}
-
-template <typename T>
-static T normalize_impl(const T &v)
-{
-    T normalized = v;
-    float inv_sqrt = 1.0f / v.norm();
-    normalized = inv_sqrt * normalized;
-    return normalized;
-}
-
-// clang-format off
-float2 normalize(const float2 &v) { return normalize_impl(v); }
-float3 normalize(const float3 &v) { return normalize_impl(v); }
-float4 normalize(const float4 &v) { return normalize_impl(v); }
-// clang-format on
-
 float2 round(const float2 &v)
 {
     return float2(
@@ -74,13 +46,6 @@ float3 cross(const float3 &a, const float3 &b)
 }
 
 // clang-format off
-float float2::squared_norm() const { return dot(*this, *this); }
-float float3::squared_norm() const { return dot(*this, *this); }
-float float4::squared_norm() const { return dot(*this, *this); }
-float float2::norm() const { return std::sqrt(squared_norm()); }
-float float3::norm() const { return std::sqrt(squared_norm()); }
-float float4::norm() const { return std::sqrt(squared_norm()); }
-
 u32 float2::max_comp() const { return x > y ? 0 : 1; };
 u32 float3::max_comp() const { return x > y ? (x > z ? 0 : 2) : (y > z ? 1 : 2); };
 
@@ -119,18 +84,6 @@ std::ostream& operator<<(std::ostream& os, const float4 &v)
     return os;
 }
 
-float4x4::float4x4(float value)
-{
-    for (auto &uninit : values) {
-        uninit = 0.0f;
-    }
-
-    values[0] = value;
-    values[5] = value;
-    values[10] = value;
-    values[15] = value;
-}
-
 float4x4::float4x4(const float (&_values)[16])
 {
     for (uint col = 0; col < 4; col++) {
@@ -140,109 +93,11 @@ float4x4::float4x4(const float (&_values)[16])
     }
 }
 
-float4x4 float4x4::identity()
-{
-    return float4x4(1.0f);
-}
-
-const float &float4x4::at(usize row, usize col) const
-{
-    assert(row < 4 && col < 4);
-    // values are stored in columns
-    return values[col * 4 + row];
-}
-
-float &float4x4::at(usize row, usize col)
-{
-    assert(row < 4 && col < 4);
-    // values are stored in columns
-    return values[col * 4 + row];
-}
-
-
-const float4 &float4x4::col(usize col) const
-{
-    assert(col < 4);
-    return *reinterpret_cast<const float4*>(&values[col * 4]);
-}
-
-float4 &float4x4::col(usize col)
-{
-    assert(col < 4);
-    return *reinterpret_cast<float4*>(&values[col * 4]);
-}
-
-float4x4 transpose(const float4x4 &m)
-{
-    float4x4 result;
-    for (usize row = 0; row < 4; row++) {
-        for (usize col = 0; col < 4; col++) {
-            result.at(row, col) = m.at(col, row);
-        }
-    }
-    return result;
-}
-
-float4x4 operator*(float a, const float4x4 &m)
-{
-    float4x4 result;
-    for (usize i = 0; i < 16; i++) {
-        result.values[i] = a * m.values[i];
-    }
-    return result;
-}
-
-float4 operator*(const float4x4 &m, const float4 &v)
-{
-    float4 result;
-    for (usize row = 0; row < 4; row++) {
-        for (usize col = 0; col < 4; col++) {
-            result.raw[row] += m.at(row, col) * v.raw[col];
-        }
-    }
-    return result;
-}
-
 bool operator==(const float4x4 &a, const float4x4 &b)
 {
     return std::memcmp(a.values, b.values, sizeof(a.values)) == 0;
 }
 
-float4x4 operator+(const float4x4 &a, const float4x4 &b)
-{
-    float4x4 result;
-    for (usize col = 0; col < 4; col++) {
-        for (usize row = 0; row < 4; row++) {
-            result.at(row, col) = a.at(row, col) + b.at(row, col);
-        }
-    }
-    return result;
-}
-
-float4x4 operator-(const float4x4 &a, const float4x4 &b)
-{
-    float4x4 result;
-    for (usize col = 0; col < 4; col++) {
-        for (usize row = 0; row < 4; row++) {
-            result.at(row, col) = a.at(row, col) - b.at(row, col);
-        }
-    }
-    return result;
-}
-
-float4x4 operator*(const float4x4 &a, const float4x4 &b)
-{
-    float4x4 result;
-    for (usize col = 0; col < 4; col++) {
-        for (usize row = 0; row < 4; row++) {
-            for (usize i = 0; i < 4; i++) {
-                result.at(row, col) += a.at(row, i) * b.at(i, col);
-            }
-        }
-    }
-    return result;
-}
-
 /// --- Tests
 
 #if defined(ENABLE_DOCTEST)
@@ -398,6 +253,86 @@ TEST_SUITE("Matrices")
         CHECK(m.col(2) == float4(3, 7, 11, 15));
         CHECK(m.col(3) == float4(4, 8, 12, 16));
     }
+
+    // Reference implementations, the operators are implemented with exo/simd.h
+    static float4x4 scalar_mul(const float4x4 &a, const float4x4 &b)
+    {
+        float4x4 result;
+        for (usize col = 0; col < 4; col++) {
+            for (usize row = 0; row < 4; row++) {
+                for (usize i = 0; i < 4; i++) {
+                    result.at(row, col) += a.at(row, i) * b.at(i, col);
+                }
+            }
+        }
+        return result;
+    }
+
+    static float4 scalar_mul(const float4x4 &m, const float4 &v)
+    {
+        float4 result;
+        for (usize row = 0; row < 4; row++) {
+            for (usize col = 0; col < 4; col++) {
+                result.raw[row] += m.at(row, col) * v.raw[col];
+            }
+        }
+        return result;
+    }
+
+    static float4x4 random_matrix(std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<float> distribution{-10.0f, 10.0f};
+        float4x4 m;
+        for (auto &value : m.values) {
+            value = distribution(rng);
+        }
+        return m;
+    }
+
+    TEST_CASE("Transpose")
+    {
+        float4x4 m({
+                1.0f, 2.0f, 3.0f, 4.0f,
+                5.0f, 6.0f, 7.0f, 8.0f,
+                9.0f, 10.0f, 11.0f, 12.0f,
+                13.0f, 14.0f, 15.0f, 16.0f,
+            });
+
+        float4x4 expected({
+                1.0f, 5.0f, 9.0f, 13.0f,
+                2.0f, 6.0f, 10.0f, 14.0f,
+                3.0f, 7.0f, 11.0f, 15.0f,
+                4.0f, 8.0f, 12.0f, 16.0f,
+            });
+
+        CHECK(transpose(m) == expected);
+        CHECK(transpose(transpose(m)) == m);
+        CHECK(m + m == 2.0f * m);
+        CHECK(m - m == float4x4());
+    }
+
+    TEST_CASE("SIMD matches scalar")
+    {
+        std::mt19937 rng{42};
+        for (u32 i = 0; i < 1000; i += 1) {
+            float4x4 a = random_matrix(rng);
+            float4x4 b = random_matrix(rng);
+            float4 v   = b.col(0);
+
+            float4x4 product  = a * b;
+            float4x4 expected = scalar_mul(a, b);
+            float4 transformed          = a * v;
+            float4 expected_transformed = scalar_mul(a, v);
+
+            // the operations are done in the same order, only a compiler contracting mul+add to fma can change the result
+            for (usize j = 0; j < 16; j++) {
+                REQUIRE(product.values[j] == doctest::Approx(expected.values[j]).epsilon(1e-5));
+            }
+            for (usize j = 0; j < 4; j++) {
+                REQUIRE(transformed.raw[j] == doctest::Approx(expected_transformed.raw[j]).epsilon(1e-5));
+            }
+        }
+    }
 }
 }
 #endif